@@ -120,6 +120,20 @@ declare namespace Rainbow {
     Count = 15,
   }
 
+  export class InstancedSpriteBatch {
+    private readonly $type: "Rainbow.InstancedSpriteBatch";
+    constructor(count: number);
+    isInstanced(): boolean;
+    isVisible(): boolean;
+    setTexture(texture: Texture): void;
+    setVisible(visible: boolean): void;
+    clear(): void;
+    createSprite(width: number, height: number): Sprite;
+    erase(i: number): void;
+    findSpriteById(id: number): Sprite;
+    swap(a: Sprite, b: Sprite): void;
+  }
+
   export class Label {
     private readonly $type: "Rainbow.Label";
     constructor();
@@ -175,7 +189,9 @@ declare namespace Rainbow {
   export class SpriteBatch {
     private readonly $type: "Rainbow.SpriteBatch";
     constructor(count: number);
+    isCulling(): boolean;
     isVisible(): boolean;
+    setCulling(enable: boolean): void;
     setNormal(texture: Texture): void;
     setTexture(texture: Texture): void;
     setVisible(visible: boolean): void;
@@ -194,7 +210,8 @@ declare namespace Rainbow {
 
   export class Texture {
     private readonly $type: "Rainbow.Texture";
-    constructor(path: string);
+    constructor(path: string, onload?: (texture: Texture, loaded: boolean) => void);
+    isLoaded(): boolean;
   }
 
   export enum VirtualKey {
@@ -342,6 +359,10 @@ declare namespace Rainbow {
     };
   }
 
+  export namespace FontCache {
+    function prewarm(font: string, fontSize: number, text: string): void;
+  }
+
   export namespace Input {
     const acceleration: Float64Array;
     const controllers: ReadonlyArray<Readonly<ControllerState>>;
@@ -352,11 +373,14 @@ declare namespace Rainbow {
   }
 
   export namespace RenderQueue {
-    function add(obj: Animation | Label | SpriteBatch): void;
-    function disable(obj: Animation | Label | SpriteBatch | number | string): void;
-    function enable(obj: Animation | Label | SpriteBatch | number | string): void;
-    function insert(position: number, obj: Animation | Label | SpriteBatch): void;
-    function erase(obj: Animation | Label | SpriteBatch | number | string): void;
-    function setTag(obj: Animation | Label | SpriteBatch, tag: string): void;
+    function add(obj: Animation | InstancedSpriteBatch | Label | SpriteBatch): void;
+    function disable(obj: Animation | InstancedSpriteBatch | Label | SpriteBatch | number | string): void;
+    function enable(obj: Animation | InstancedSpriteBatch | Label | SpriteBatch | number | string): void;
+    function insert(position: number, obj: Animation | InstancedSpriteBatch | Label | SpriteBatch): void;
+    function erase(obj: Animation | InstancedSpriteBatch | Label | SpriteBatch | number | string): void;
+    function setDepth(obj: Animation | InstancedSpriteBatch | Label | SpriteBatch, depth: number): void;
+    function setLayer(obj: Animation | InstancedSpriteBatch | Label | SpriteBatch, layer: number): void;
+    function setSorted(sorted: boolean): void;
+    function setTag(obj: Animation | InstancedSpriteBatch | Label | SpriteBatch, tag: string): void;
   }
 }
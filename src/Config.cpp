@@ -24,6 +24,8 @@ namespace
 {
     constexpr char kConfigINI[] = "config.ini";
     constexpr int kMaxMSAA = 16;
+    constexpr int kMaxSkipMipLevels = 15;
+    constexpr size_t kDefaultTextureUploadBudget = 4096;
 
     struct Keys
     {
@@ -33,6 +35,12 @@ namespace
         uint64_t allow_hidpi;
         uint64_t suspend_on_focus_lost;
         uint64_t accelerometer;
+        uint64_t worker_threads;
+        uint64_t texture_atlas;
+        uint64_t texture_upload_budget;
+        uint64_t mipmaps;
+        uint64_t skip_mip_levels;
+        uint64_t texture_memory_budget;
     };
 
     template <typename F>
@@ -46,8 +54,12 @@ namespace
 }  // namespace
 
 rainbow::Config::Config()
-    : width_(0), height_(0), msaa_(0), hidpi_(false), suspend_(true),
-      accelerometer_(false)
+    : width_(0), height_(0), worker_threads_(-1), msaa_(0),
+      skip_mip_levels_(0),
+      texture_upload_budget_(kDefaultTextureUploadBudget * 1024),
+      texture_memory_budget_(0),
+      hidpi_(false), suspend_(true), accelerometer_(false),
+      texture_atlas_(false), mipmaps_(false)
 {
     if (!filesystem::exists(kConfigINI))
     {
@@ -67,6 +79,12 @@ rainbow::Config::Config()
         hash("AllowHiDPI"sv),
         hash("SuspendOnFocusLost"sv),
         hash("Accelerometer"sv),
+        hash("WorkerThreads"sv),
+        hash("TextureAtlas"sv),
+        hash("TextureUploadBudget"sv),
+        hash("Mipmaps"sv),
+        hash("SkipMipLevels"sv),
+        hash("TextureMemoryBudget"sv),
     };
 
     panini::parse(  //
@@ -101,5 +119,28 @@ rainbow::Config::Config()
                 with_bool(value, [this](bool v) { suspend_ = v; });
             else if (hashed_key == keys.accelerometer)
                 with_bool(value, [this](bool v) { accelerometer_ = v; });
+            else if (hashed_key == keys.worker_threads && !value.empty())
+                worker_threads_ = atoi(value.data());
+            else if (hashed_key == keys.texture_atlas)
+                with_bool(value, [this](bool v) { texture_atlas_ = v; });
+            else if (hashed_key == keys.texture_upload_budget &&
+                     !value.empty())
+            {
+                const auto kib = std::max(atoi(value.data()), 0);
+                texture_upload_budget_ = static_cast<size_t>(kib) * 1024;
+            }
+            else if (hashed_key == keys.mipmaps)
+                with_bool(value, [this](bool v) { mipmaps_ = v; });
+            else if (hashed_key == keys.skip_mip_levels && !value.empty())
+            {
+                skip_mip_levels_ = static_cast<unsigned int>(
+                    std::clamp(atoi(value.data()), 0, kMaxSkipMipLevels));
+            }
+            else if (hashed_key == keys.texture_memory_budget &&
+                     !value.empty())
+            {
+                const auto mib = std::max(atoi(value.data()), 0);
+                texture_memory_budget_ = static_cast<size_t>(mib) * 1024 * 1024;
+            }
         });
 }
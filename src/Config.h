@@ -5,6 +5,8 @@
 #ifndef CONFIG_H_
 #define CONFIG_H_
 
+#include <cstddef>
+
 namespace rainbow
 {
     /// <summary>Load game configuration.</summary>
@@ -23,7 +25,19 @@ namespace rainbow
     ///   AllowHiDPI = false
     ///   SuspendOnFocusLost = true
     ///   Accelerometer = false
+    ///   WorkerThreads = -1
+    ///   TextureAtlas = false
+    ///   TextureUploadBudget = 4096
+    ///   Mipmaps = false
+    ///   SkipMipLevels = 0
+    ///   TextureMemoryBudget = 0
     ///   </code>
+    ///
+    ///   A negative number of worker threads means one less than the number
+    ///   of hardware threads available. The texture upload budget is in KiB
+    ///   per frame; zero means no limit. Skipped mip levels are dropped from
+    ///   the top of the chain, halving texture size for each level. The
+    ///   texture memory budget is in MiB; zero means no limit.
     /// </remarks>
     class Config
     {
@@ -55,16 +69,64 @@ namespace rainbow
             return accelerometer_;
         }
 
+        /// <summary>
+        ///   Returns whether textures loaded from file should have mip chains.
+        /// </summary>
+        [[nodiscard]] auto mipmaps() const { return mipmaps_; }
+
+        /// <summary>
+        ///   Returns the number of top mip levels to drop from textures
+        ///   loaded from file.
+        /// </summary>
+        [[nodiscard]] auto skip_mip_levels() const { return skip_mip_levels_; }
+
         /// <summary>Returns whether to suspend when focus is lost.</summary>
         [[nodiscard]] auto suspend() const { return suspend_; }
 
+        /// <summary>
+        ///   Returns whether small images should be packed into texture atlas
+        ///   pages.
+        /// </summary>
+        [[nodiscard]] auto texture_atlas() const { return texture_atlas_; }
+
+        /// <summary>
+        ///   Returns the number of bytes of texture memory to keep resident
+        ///   before unused textures are evicted. Zero means no limit.
+        /// </summary>
+        [[nodiscard]] auto texture_memory_budget() const
+        {
+            return texture_memory_budget_;
+        }
+
+        /// <summary>
+        ///   Returns the maximum number of bytes of asynchronously loaded
+        ///   textures to upload per frame. Zero means no limit.
+        /// </summary>
+        [[nodiscard]] auto texture_upload_budget() const
+        {
+            return texture_upload_budget_;
+        }
+
+        /// <summary>
+        ///   Returns the number of worker threads used to update the render
+        ///   queue. A negative number means it should be determined at run
+        ///   time.
+        /// </summary>
+        [[nodiscard]] auto worker_threads() const { return worker_threads_; }
+
     private:
         int width_;
         int height_;
+        int worker_threads_;
         unsigned int msaa_;
+        unsigned int skip_mip_levels_;
+        size_t texture_upload_budget_;
+        size_t texture_memory_budget_;
         bool hidpi_;
         bool suspend_;
         bool accelerometer_;
+        bool texture_atlas_;
+        bool mipmaps_;
     };
 }  // namespace rainbow
 
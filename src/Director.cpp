@@ -4,6 +4,8 @@
 
 #include "Director.h"
 
+#include <limits>
+
 #include "Common/Logging.h"
 #include "Common/Random.h"
 #include "Script/NoGame.h"
@@ -15,6 +17,13 @@
 namespace
 {
     constexpr int kMaxAudioChannels = 24;
+
+    auto worker_count(const rainbow::Config& config)
+    {
+        const int count = config.worker_threads();
+        return count < 0 ? rainbow::JobPool::default_worker_count()
+                         : static_cast<unsigned int>(count);
+    }
 }  // namespace
 
 namespace rainbow
@@ -22,13 +31,24 @@ namespace rainbow
     Random random;  // NOLINT(cert-err58-cpp)
 
     Director::Director()
-        : active_(true), terminated_(false), error_(ErrorCode::Success)
+        : active_(true), terminated_(false), error_(ErrorCode::Success),
+          job_pool_(worker_count(config_))
     {
         if (std::error_code error = mixer_.initialize(kMaxAudioChannels))
             terminate(error);
         else if (std::error_code error = renderer_.initialize())
             terminate(error);
 
+        renderer_.texture_provider.set_atlas_enabled(config_.texture_atlas());
+        renderer_.texture_provider.set_upload_budget(
+            config_.texture_upload_budget());
+        renderer_.texture_provider.set_mipmaps_enabled(config_.mipmaps());
+        renderer_.texture_provider.set_skipped_mip_levels(
+            config_.skip_mip_levels());
+        renderer_.texture_provider.set_memory_budget(
+            config_.texture_memory_budget());
+        renderer_.texture_provider.set_job_pool(&job_pool_);
+
         IF_DEBUG(make_global());
     }
 
@@ -75,6 +95,9 @@ namespace rainbow
     {
         R_ASSERT(!terminated_, "App should have terminated by now");
 
+        renderer_.streaming_buffer.next_frame();
+        renderer_.texture_provider.upload_pending();
+        renderer_.texture_provider.next_frame();
         timer_manager_.update(dt);
         script_->update(dt);
 
@@ -102,6 +125,7 @@ namespace rainbow
         R_ASSERT(!terminated_, "App should have terminated by now");
 
         script_->on_memory_warning();
+        renderer_.texture_provider.evict(std::numeric_limits<size_t>::max());
     }
 
     void Director::start()
@@ -7,11 +7,13 @@
 
 #include "Audio/Mixer.h"
 #include "Common/Global.h"
+#include "Config.h"
 #include "Graphics/RenderQueue.h"
 #include "Graphics/Renderer.h"
 #include "Input/Input.h"
 #include "Script/Timer.h"
 #include "Text/Typesetter.h"
+#include "Threading/JobPool.h"
 
 namespace rainbow
 {
@@ -46,6 +48,7 @@ namespace rainbow
         }
 
         [[nodiscard]] auto input() -> Input& { return input_; }
+        [[nodiscard]] auto job_pool() -> JobPool& { return job_pool_; }
         [[nodiscard]] auto mixer() -> audio::Mixer& { return mixer_; }
 
         [[nodiscard]] auto render_queue() -> graphics::RenderQueue&
@@ -120,6 +123,8 @@ namespace rainbow
         bool active_;
         bool terminated_;
         std::error_code error_;
+        const Config config_;
+        JobPool job_pool_;
         TimerManager timer_manager_;
         std::unique_ptr<GameBase> script_;
         graphics::RenderQueue render_queue_;
@@ -4,14 +4,17 @@
 
 #include "Graphics/Buffer.h"
 
+#include <cstring>
+
 #include "Graphics/OpenGL.h"
+#include "Graphics/Renderer.h"
 #include "Graphics/ShaderDetails.h"
 #include "Graphics/SpriteVertex.h"
 
 using rainbow::graphics::Buffer;
 
 #define s_offsetof(type, field)                                                \
-    reinterpret_cast<const void*>(offsetof(type, field)))  // NOLINT
+    reinterpret_cast<const void*>(offset + offsetof(type, field)))  // NOLINT
 
 namespace
 {
@@ -21,13 +24,23 @@ namespace
         glGenBuffers(1, &id);
         return id;
     }
+
+    constexpr size_t kStreamAlignment = 16;
 }  // namespace
 
-Buffer::Buffer() : id_(glGenBuffer()) {}
+Buffer::Buffer(Usage usage)
+    : id_(glGenBuffer()), buffer_(id_),
+      streaming_(usage == Usage::Stream &&
+                 rainbow::graphics::streaming_buffer() != nullptr)
+{
+}
 
-Buffer::Buffer(Buffer&& buffer) noexcept : id_(buffer.id_)
+Buffer::Buffer(Buffer&& buffer) noexcept
+    : id_(buffer.id_), buffer_(buffer.buffer_), offset_(buffer.offset_),
+      streaming_(buffer.streaming_)
 {
     buffer.id_ = 0;
+    buffer.buffer_ = 0;
 }
 
 Buffer::~Buffer()
@@ -35,12 +48,13 @@ Buffer::~Buffer()
     if (id_ == 0)
         return;
 
-    glDeleteBuffers(1, &id_);
+    rainbow::graphics::delete_buffer(id_);
 }
 
-void Buffer::bind() const
+void Buffer::bind_at(uint32_t first) const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, id_);
+    const auto offset = offset_ + first * sizeof(SpriteVertex);
+    rainbow::graphics::state_cache().bind_array_buffer(buffer_);
     glEnableVertexAttribArray(Shader::kAttributeColor);
     glVertexAttribPointer(
         Shader::kAttributeColor,
@@ -67,17 +81,98 @@ void Buffer::bind() const
         s_offsetof(SpriteVertex, position);
 }
 
-void Buffer::bind(unsigned int index) const
+void Buffer::bind_at(unsigned int index, uint32_t first) const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, id_);
+    const auto offset = offset_ + first * sizeof(Vec2f);
+    rainbow::graphics::state_cache().bind_array_buffer(buffer_);
     glEnableVertexAttribArray(index);
-    glVertexAttribPointer(index, 2, GL_FLOAT, GL_FALSE, sizeof(Vec2f), nullptr);
+    glVertexAttribPointer(index,
+                          2,
+                          GL_FLOAT,
+                          GL_FALSE,
+                          sizeof(Vec2f),
+                          reinterpret_cast<const void*>(offset));  // NOLINT
+}
+
+void Buffer::bind_instances() const
+{
+#ifdef USE_INSTANCED_ARRAYS
+    const auto offset = offset_;
+    rainbow::graphics::state_cache().bind_array_buffer(buffer_);
+    glEnableVertexAttribArray(Shader::kAttributeColor);
+    glVertexAttribPointer(
+        Shader::kAttributeColor,
+        4,
+        GL_UNSIGNED_BYTE,
+        GL_TRUE,
+        sizeof(SpriteInstance),
+        s_offsetof(SpriteInstance, color);
+    glVertexAttribDivisor(Shader::kAttributeColor, 1);
+    glEnableVertexAttribArray(Shader::kAttributeTexCoord);
+    glVertexAttribPointer(
+        Shader::kAttributeTexCoord,
+        4,
+        GL_UNSIGNED_SHORT,
+        GL_TRUE,
+        sizeof(SpriteInstance),
+        s_offsetof(SpriteInstance, texcoords);
+    glVertexAttribDivisor(Shader::kAttributeTexCoord, 1);
+    glEnableVertexAttribArray(Shader::kAttributeTranslation);
+    glVertexAttribPointer(
+        Shader::kAttributeTranslation,
+        3,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(SpriteInstance),
+        s_offsetof(SpriteInstance, position);
+    glVertexAttribDivisor(Shader::kAttributeTranslation, 1);
+    glEnableVertexAttribArray(Shader::kAttributeQuad);
+    glVertexAttribPointer(
+        Shader::kAttributeQuad,
+        4,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(SpriteInstance),
+        s_offsetof(SpriteInstance, origin);
+    glVertexAttribDivisor(Shader::kAttributeQuad, 1);
+#endif  // USE_INSTANCED_ARRAYS
 }
 
-void Buffer::upload(const void* data, size_t size) const
+void Buffer::upload(const void* data, size_t size)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, id_);
+    if (streaming_)
+    {
+        auto& stream = *rainbow::graphics::streaming_buffer();
+        if (auto allocation = stream.map(size, kStreamAlignment))
+        {
+            std::memcpy(allocation.data, data, size);
+            stream.unmap(allocation);
+            buffer_ = stream.id();
+            offset_ = allocation.offset;
+
+            IF_DEBUG(increment_bytes_uploaded(size));
+            return;
+        }
+
+        // The current segment is full; fall back to our own buffer object for
+        // this frame.
+        buffer_ = id_;
+        offset_ = 0;
+    }
+
+    rainbow::graphics::state_cache().bind_array_buffer(id_);
     glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STREAM_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    IF_DEBUG(increment_bytes_uploaded(size));
+}
+
+void Buffer::update(const void* data, size_t size, size_t offset) const
+{
+    R_ASSERT(!streaming_, "Streaming buffers cannot be partially updated");
+
+    rainbow::graphics::state_cache().bind_array_buffer(id_);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+
+    IF_DEBUG(increment_bytes_uploaded(size));
 }
@@ -6,6 +6,7 @@
 #define GRAPHICS_BUFFER_H_
 
 #include <cstddef>
+#include <cstdint>
 
 namespace rainbow
 {
@@ -17,30 +18,84 @@ namespace rainbow::graphics
     class Buffer
     {
     public:
-        Buffer();
+        enum class Usage
+        {
+            /// <summary>Data is kept until it is uploaded again.</summary>
+            Dynamic,
+
+            /// <summary>
+            ///   Data is written to the context's streaming buffer and must be
+            ///   uploaded every frame it is drawn.
+            /// </summary>
+            Stream,
+        };
+
+        explicit Buffer(Usage usage = Usage::Dynamic);
         Buffer(Buffer&&) noexcept;
         ~Buffer();
 
+        /// <summary>
+        ///   Returns whether data is uploaded to the streaming buffer.
+        /// </summary>
+        [[nodiscard]] auto is_streaming() const { return streaming_; }
+
         /// <summary>
         ///   Used by Label and SpriteBatch for interleaved vertex buffer.
         /// </summary>
-        void bind() const;
+        void bind() const { bind_at(0); }
 
         /// <summary>Used by SpriteBatch for normal buffers.</summary>
-        void bind(unsigned int index) const;
+        void bind(unsigned int index) const { bind_at(index, 0); }
+
+        /// <summary>
+        ///   Used by InstancedSpriteBatch for per-instance sprite data.
+        /// </summary>
+        void bind_instances() const;
+
+        /// <summary>
+        ///   Binds interleaved vertex buffer such that vertex
+        ///   <paramref name="first"/> is the first one drawn.
+        /// </summary>
+        void bind_at(uint32_t first) const;
+
+        /// <summary>
+        ///   Binds normal buffer such that vertex <paramref name="first"/> is
+        ///   the first one drawn.
+        /// </summary>
+        void bind_at(unsigned int index, uint32_t first) const;
 
         /// <summary>
         ///   Uploads <paramref name="data"/> of size <paramref name="size"/> to
         ///   the GPU buffer.
         /// </summary>
-        void upload(const void* data, size_t size) const;
+        void upload(const void* data, size_t size);
+
+        /// <summary>
+        ///   Updates part of the GPU buffer, starting at byte
+        ///   <paramref name="offset"/>, with <paramref name="data"/> of size
+        ///   <paramref name="size"/>. The buffer must have been allocated with
+        ///   <see cref="upload"/> first, and must not be streaming.
+        /// </summary>
+        void update(const void* data, size_t size, size_t offset) const;
 
 #ifdef RAINBOW_TEST
-        explicit Buffer(const ISolemnlySwearThatIAmOnlyTesting&) : id_(0) {}
+        explicit Buffer(const ISolemnlySwearThatIAmOnlyTesting&)
+            : id_(0), buffer_(0)
+        {
+        }
 #endif
 
     private:
+        /// <summary>Buffer object owned by this instance.</summary>
         unsigned int id_;
+
+        /// <summary>Buffer object that holds the most recent upload.</summary>
+        unsigned int buffer_;
+
+        /// <summary>Offset of the most recent upload, in bytes.</summary>
+        size_t offset_ = 0;
+
+        bool streaming_ = false;
     };
 }  // namespace rainbow::graphics
 
@@ -21,6 +21,8 @@ namespace
     constexpr uint32_t kDDPFYUV = 0x200;
     constexpr uint32_t kDDPFLuminance = 0x20000;
 
+    constexpr uint32_t kDDSDMipMapCount = 0x20000;
+
     constexpr uint32_t kDDSMagic = 0x20534444;  // "DDS "
 
     constexpr uint32_t kFourCCDXT1 = rainbow::make_fourcc('D', 'X', 'T', '1');
@@ -105,7 +107,7 @@ namespace dds
                 break;
         }
 
-        return Image(  //
+        Image image(  //
             format,
             header.dwWidth,
             header.dwHeight,
@@ -113,6 +115,17 @@ namespace dds
             channels,
             header.dwPitchOrLinearSize,
             data.bytes() + sizeof(*dds));
+
+        if ((header.dwFlags & kDDSDMipMapCount) == kDDSDMipMapCount &&
+            header.dwMipMapCount > 1)
+        {
+            image.mip_levels = header.dwMipMapCount;
+            image.size = image.level_offset(image.mip_levels);
+            R_ASSERT(sizeof(*dds) + image.size <= data.size(),
+                     "DDS file is missing mip levels");
+        }
+
+        return image;
     }
 }  // namespace dds
 
@@ -0,0 +1,382 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_DECODERS_KTX_H_
+#define GRAPHICS_DECODERS_KTX_H_
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "Common/Logging.h"
+#include "Common/TypeCast.h"
+
+// https://registry.khronos.org/KTX/specs/1.0/ktxspec.v1.html
+// https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+#define USE_KTX
+
+namespace
+{
+    constexpr uint8_t kKTX1Identifier[12]{
+        0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+    constexpr uint8_t kKTX2Identifier[12]{
+        0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    constexpr uint32_t kKTXEndianness = 0x04030201;
+
+    /// <summary>
+    ///   Maximum number of mip levels read, enough for 32-bit dimensions.
+    /// </summary>
+    constexpr uint32_t kMaxMipLevels = 32;
+
+    /// <summary>ASTC block footprints in the order formats list them.</summary>
+    constexpr std::array<std::array<uint32_t, 2>, 14> kASTCFootprints{{
+        {4, 4},
+        {5, 4},
+        {5, 5},
+        {6, 5},
+        {6, 6},
+        {8, 5},
+        {8, 6},
+        {8, 8},
+        {10, 5},
+        {10, 6},
+        {10, 8},
+        {10, 10},
+        {12, 10},
+        {12, 12},
+    }};
+
+    struct KTXHeader
+    {
+        uint8_t identifier[12];
+        uint32_t endianness;
+        uint32_t gl_type;
+        uint32_t gl_type_size;
+        uint32_t gl_format;
+        uint32_t gl_internal_format;
+        uint32_t gl_base_internal_format;
+        uint32_t pixel_width;
+        uint32_t pixel_height;
+        uint32_t pixel_depth;
+        uint32_t number_of_array_elements;
+        uint32_t number_of_faces;
+        uint32_t number_of_mipmap_levels;
+        uint32_t bytes_of_key_value_data;
+    };
+
+    struct KTX2Header
+    {
+        uint8_t identifier[12];
+        uint32_t vk_format;
+        uint32_t type_size;
+        uint32_t pixel_width;
+        uint32_t pixel_height;
+        uint32_t pixel_depth;
+        uint32_t layer_count;
+        uint32_t face_count;
+        uint32_t level_count;
+        uint32_t supercompression_scheme;
+        uint32_t dfd_byte_offset;
+        uint32_t dfd_byte_length;
+        uint32_t kvd_byte_offset;
+        uint32_t kvd_byte_length;
+        uint64_t sgd_byte_offset;
+        uint64_t sgd_byte_length;
+    };
+
+    struct KTX2LevelIndex
+    {
+        uint64_t byte_offset;
+        uint64_t byte_length;
+        uint64_t uncompressed_byte_length;
+    };
+
+    struct KTXFormat
+    {
+        rainbow::Image::Format format;
+        uint32_t channels;
+        uint32_t block_width;
+        uint32_t block_height;
+    };
+
+    constexpr auto astc_format(uint32_t index) -> KTXFormat
+    {
+        return {rainbow::Image::Format::ASTC,
+                4,
+                kASTCFootprints[index][0],
+                kASTCFootprints[index][1]};
+    }
+
+    /// <summary>
+    ///   Maps a KTX 1 internal format to an image format. sRGB formats are
+    ///   treated as linear, the same as PNGs.
+    /// </summary>
+    constexpr auto from_gl_format(uint32_t internal_format) -> KTXFormat
+    {
+        using rainbow::Image;
+
+        switch (internal_format)
+        {
+            case 0x83F0:  // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+            case 0x8C4C:  // GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+                return {Image::Format::BC1, 3, 4, 4};
+            case 0x83F1:  // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+            case 0x8C4D:  // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+                return {Image::Format::BC1, 4, 4, 4};
+            case 0x83F2:  // GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+            case 0x8C4E:  // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT
+                return {Image::Format::BC2, 4, 4, 4};
+            case 0x83F3:  // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+            case 0x8C4F:  // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+                return {Image::Format::BC3, 4, 4, 4};
+            case 0x8DBB:  // GL_COMPRESSED_RED_RGTC1
+                return {Image::Format::BC4, 1, 4, 4};
+            case 0x8DBD:  // GL_COMPRESSED_RG_RGTC2
+                return {Image::Format::BC5, 2, 4, 4};
+            case 0x8E8F:  // GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT
+                return {Image::Format::BC6H, 3, 4, 4};
+            case 0x8E8C:  // GL_COMPRESSED_RGBA_BPTC_UNORM
+            case 0x8E8D:  // GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+                return {Image::Format::BC7, 4, 4, 4};
+            case 0x8D64:  // GL_ETC1_RGB8_OES
+                return {Image::Format::ETC1, 3, 4, 4};
+            case 0x9274:  // GL_COMPRESSED_RGB8_ETC2
+            case 0x9275:  // GL_COMPRESSED_SRGB8_ETC2
+                return {Image::Format::ETC2, 3, 4, 4};
+            case 0x9278:  // GL_COMPRESSED_RGBA8_ETC2_EAC
+            case 0x9279:  // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+                return {Image::Format::ETC2, 4, 4, 4};
+            default:
+                // GL_COMPRESSED_RGBA_ASTC_4x4_KHR and onwards
+                if (internal_format >= 0x93B0 && internal_format <= 0x93BD)
+                    return astc_format(internal_format - 0x93B0);
+                // GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR and onwards
+                if (internal_format >= 0x93D0 && internal_format <= 0x93DD)
+                    return astc_format(internal_format - 0x93D0);
+                return {Image::Format::Unknown, 0, 4, 4};
+        }
+    }
+
+    /// <summary>
+    ///   Maps a KTX 2 Vulkan format to an image format. sRGB formats are
+    ///   treated as linear, the same as PNGs.
+    /// </summary>
+    constexpr auto from_vk_format(uint32_t vk_format) -> KTXFormat
+    {
+        using rainbow::Image;
+
+        switch (vk_format)
+        {
+            case 131:  // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+            case 132:  // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+                return {Image::Format::BC1, 3, 4, 4};
+            case 133:  // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+            case 134:  // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+                return {Image::Format::BC1, 4, 4, 4};
+            case 135:  // VK_FORMAT_BC2_UNORM_BLOCK
+            case 136:  // VK_FORMAT_BC2_SRGB_BLOCK
+                return {Image::Format::BC2, 4, 4, 4};
+            case 137:  // VK_FORMAT_BC3_UNORM_BLOCK
+            case 138:  // VK_FORMAT_BC3_SRGB_BLOCK
+                return {Image::Format::BC3, 4, 4, 4};
+            case 139:  // VK_FORMAT_BC4_UNORM_BLOCK
+                return {Image::Format::BC4, 1, 4, 4};
+            case 141:  // VK_FORMAT_BC5_UNORM_BLOCK
+                return {Image::Format::BC5, 2, 4, 4};
+            case 143:  // VK_FORMAT_BC6H_UFLOAT_BLOCK
+                return {Image::Format::BC6H, 3, 4, 4};
+            case 145:  // VK_FORMAT_BC7_UNORM_BLOCK
+            case 146:  // VK_FORMAT_BC7_SRGB_BLOCK
+                return {Image::Format::BC7, 4, 4, 4};
+            case 147:  // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+            case 148:  // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+                return {Image::Format::ETC2, 3, 4, 4};
+            case 151:  // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+            case 152:  // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+                return {Image::Format::ETC2, 4, 4, 4};
+            default:
+                // VK_FORMAT_ASTC_4x4_UNORM_BLOCK to ASTC_12x12_SRGB_BLOCK,
+                // alternating between UNORM and SRGB.
+                if (vk_format >= 157 && vk_format <= 184)
+                    return astc_format((vk_format - 157) / 2);
+                return {Image::Format::Unknown, 0, 4, 4};
+        }
+    }
+
+    auto make_image(const KTXFormat& format,
+                    uint32_t width,
+                    uint32_t height,
+                    const uint8_t* data)
+    {
+        rainbow::Image image{format.format,
+                             width,
+                             height,
+                             1,
+                             format.channels,
+                             0,
+                             data};
+        image.block_width = format.block_width;
+        image.block_height = format.block_height;
+        return image;
+    }
+
+    /// <summary>
+    ///   Points <paramref name="image"/> straight at its only level if there
+    ///   are no others, so that it looks like any other compressed image.
+    /// </summary>
+    void finalize(rainbow::Image& image)
+    {
+        image.mip_levels = rainbow::narrow_cast<uint32_t>(
+            std::max<size_t>(image.level_offsets.size(), 1));
+        image.size = 0;
+        for (uint32_t i = 0; i < image.mip_levels; ++i)
+            image.size += image.level_size(i);
+
+        if (image.mip_levels == 1 && !image.level_offsets.empty())
+        {
+            image.data += image.level_offsets[0];
+            image.level_offsets.clear();
+        }
+    }
+
+    auto decode_ktx1(const rainbow::Data& data)
+    {
+        using rainbow::Image;
+
+        auto header = data.as<const KTXHeader*>();
+        if (data.size() < sizeof(*header) ||
+            header->endianness != kKTXEndianness || header->gl_type != 0 ||
+            header->number_of_faces != 1 ||
+            header->number_of_array_elements != 0 || header->pixel_depth > 1)
+        {
+            R_ASSERT(false, "Only compressed, 2D KTX textures are supported");
+            return Image{};
+        }
+
+        const auto format = from_gl_format(header->gl_internal_format);
+        if (format.format == Image::Format::Unknown)
+        {
+            R_ASSERT(false, "Unsupported KTX texture format");
+            return Image{};
+        }
+
+        auto image = make_image(
+            format, header->pixel_width, header->pixel_height, data.bytes());
+
+        // Each level is prefixed with its size, and padded to 4 bytes.
+        const auto levels = std::clamp(
+            header->number_of_mipmap_levels, 1U, kMaxMipLevels);
+        size_t offset = sizeof(*header) + header->bytes_of_key_value_data;
+        for (uint32_t level = 0; level < levels; ++level)
+        {
+            uint32_t image_size;
+            if (offset + sizeof(image_size) > data.size())
+                break;
+
+            std::memcpy(&image_size, data.bytes() + offset, sizeof(image_size));
+            offset += sizeof(image_size);
+            if (offset + image_size > data.size() ||
+                image_size != image.level_size(level))
+            {
+                break;
+            }
+
+            image.level_offsets.push_back(offset);
+            offset += (image_size + 3) & ~size_t{3};
+        }
+
+        R_ASSERT(image.level_offsets.size() == levels,
+                 "KTX file is truncated or malformed");
+        if (image.level_offsets.empty())
+            return Image{};
+
+        finalize(image);
+        return image;
+    }
+
+    auto decode_ktx2(const rainbow::Data& data)
+    {
+        using rainbow::Image;
+
+        auto header = data.as<const KTX2Header*>();
+        if (data.size() < sizeof(*header) || header->layer_count > 1 ||
+            header->face_count != 1 || header->pixel_depth > 1)
+        {
+            R_ASSERT(false, "Only 2D KTX2 textures are supported");
+            return Image{};
+        }
+
+        if (header->supercompression_scheme != 0)
+        {
+            R_ASSERT(false, "Supercompressed KTX2 textures are not supported");
+            return Image{};
+        }
+
+        const auto format = from_vk_format(header->vk_format);
+        if (format.format == Image::Format::Unknown)
+        {
+            R_ASSERT(false, "Unsupported KTX2 texture format");
+            return Image{};
+        }
+
+        auto image = make_image(
+            format, header->pixel_width, header->pixel_height, data.bytes());
+
+        // Levels are stored smallest first, but indexed largest first.
+        const auto levels = std::clamp(header->level_count, 1U, kMaxMipLevels);
+        if (sizeof(*header) + sizeof(KTX2LevelIndex) * levels > data.size())
+        {
+            R_ASSERT(false, "KTX2 file is truncated or malformed");
+            return Image{};
+        }
+
+        auto index = reinterpret_cast<const KTX2LevelIndex*>(  // NOLINT
+            data.bytes() + sizeof(*header));
+        for (uint32_t level = 0; level < levels; ++level)
+        {
+            const auto& entry = index[level];
+            // Both fields come from the file; do not let their sum wrap.
+            if (entry.byte_offset > data.size() ||
+                entry.byte_length > data.size() - entry.byte_offset ||
+                entry.byte_length != image.level_size(level))
+            {
+                break;
+            }
+
+            image.level_offsets.push_back(entry.byte_offset);
+        }
+
+        R_ASSERT(image.level_offsets.size() == levels,
+                 "KTX2 file is truncated or malformed");
+        if (image.level_offsets.empty())
+            return Image{};
+
+        finalize(image);
+        return image;
+    }
+}  // namespace
+
+namespace ktx
+{
+    bool check(const rainbow::Data& data)
+    {
+        auto matches = [&data](const uint8_t(&identifier)[12]) {
+            return memcmp(data.bytes(), identifier, sizeof(identifier)) == 0;
+        };
+        return data.size() >= sizeof(kKTX1Identifier) &&
+               (matches(kKTX1Identifier) || matches(kKTX2Identifier));
+    }
+
+    /// <summary>
+    ///   Decodes a KTX or KTX2 file without copying; the returned image
+    ///   points into <paramref name="data"/>.
+    /// </summary>
+    auto decode(const rainbow::Data& data)
+    {
+        return data.bytes()[5] == '2' ? decode_ktx2(data) : decode_ktx1(data);
+    }
+}  // namespace ktx
+
+#endif
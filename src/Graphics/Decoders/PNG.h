@@ -46,6 +46,65 @@ namespace png
             size,
             buffer.release());
     }
+
+    /// <summary>
+    ///   Returns the header of the image that <see cref="decode_into"/> would
+    ///   produce, or an unknown image if it should be decoded normally.
+    /// </summary>
+    auto probe(const rainbow::Data& data)
+    {
+        using rainbow::Image;
+
+        png_image pi{};
+        pi.version = PNG_IMAGE_VERSION;
+
+        auto memory = data.as<png_const_voidp>();
+        if (!png_image_begin_read_from_memory(&pi, memory, data.size()))
+            return Image{};
+
+        // Grayscale with alpha would double in size if expanded to RGBA.
+        const auto channels = PNG_IMAGE_PIXEL_CHANNELS(pi.format);
+        pi.format = PNG_FORMAT_RGBA;
+        Image header(Image::Format::RGBA,
+                     pi.width,
+                     pi.height,
+                     32,
+                     4,
+                     PNG_IMAGE_SIZE(pi));
+        png_image_free(&pi);
+        return channels == 2 ? Image{} : std::move(header);
+    }
+
+    /// <summary>
+    ///   Decodes <paramref name="data"/> as RGBA straight into
+    ///   <paramref name="buffer"/>, which is not owned by the returned image.
+    /// </summary>
+    auto decode_into(const rainbow::Data& data, uint8_t* buffer)
+    {
+        using rainbow::Image;
+
+        png_image pi{};
+        pi.version = PNG_IMAGE_VERSION;
+
+        auto memory = data.as<png_const_voidp>();
+        if (!png_image_begin_read_from_memory(&pi, memory, data.size()))
+            return Image{};
+
+        pi.format = PNG_FORMAT_RGBA;
+        if (!png_image_finish_read(
+                &pi, nullptr, buffer, PNG_IMAGE_ROW_STRIDE(pi), nullptr))
+        {
+            return Image{};
+        }
+
+        return Image(Image::Format::RGBA,
+                     pi.width,
+                     pi.height,
+                     32,
+                     4,
+                     PNG_IMAGE_SIZE(pi),
+                     buffer);
+    }
 }  // namespace png
 
 #endif
@@ -5,6 +5,7 @@
 #ifndef GRAPHICS_DECODERS_PVRTC_H_
 #define GRAPHICS_DECODERS_PVRTC_H_
 
+#include <algorithm>
 #include <cstdint>
 
 #include "Common/Logging.h"
@@ -47,9 +48,6 @@ namespace pvrtc
 
 #ifdef RAINBOW_OS_IOS
         auto header = data.as<PVRTexHeader*>();
-        R_ASSERT(CFSwapInt32LittleToHost(header->mipmap_count) == 1,
-                 "Mipmaps are not supported");
-
         image.height = CFSwapInt32LittleToHost(header->height);
         image.width = CFSwapInt32LittleToHost(header->width);
         R_ASSERT(image.width == image.height,
@@ -62,7 +60,9 @@ namespace pvrtc
 
         const size_t offset =
             sizeof(*header) + CFSwapInt32LittleToHost(header->metadata_size);
-        image.size = image.width * image.height * image.depth >> 3;
+        image.mip_levels =
+            std::max(CFSwapInt32LittleToHost(header->mipmap_count), 1U);
+        image.size = image.level_offset(image.mip_levels);
         R_ASSERT(
             offset + image.size == data.size(), "Unsupported PVR file format");
         image.data = data.bytes() + offset;
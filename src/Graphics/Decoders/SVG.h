@@ -5,8 +5,19 @@
 #ifndef GRAPHICS_DECODERS_SVG_H_
 #define GRAPHICS_DECODERS_SVG_H_
 
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
 #include "Common/Algorithm.h"
+#include "Common/Logging.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileSystem.h"
 #include "ThirdParty/NanoSVG/NanoSVG.h"
+#include "Threading/JobPool.h"
 
 #define USE_SVG
 
@@ -30,6 +41,25 @@ namespace std
 
 namespace svg
 {
+    /// <summary>
+    ///   Directory, relative to the preferences directory, where rasterized
+    ///   images are cached.
+    /// </summary>
+    constexpr char kCacheDirectory[] = "SVGCache";
+
+    /// <summary>Minimum number of rows worth rasterizing separately.</summary>
+    constexpr int kMinTileHeight = 64;
+
+    struct CacheHeader
+    {
+        std::array<char, 8> magic;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    constexpr std::array<char, 8> kCacheMagic{
+        'R', 'N', 'B', 'W', 'S', 'V', 'G', '1'};
+
     bool check(const rainbow::Data& data)
     {
         const auto p = data.bytes();
@@ -41,9 +71,139 @@ namespace svg
                p[4] == ' ';
     }
 
-    auto decode(const rainbow::Data& data, float scale)
+    /// <summary>
+    ///   Returns the cache path of <paramref name="data"/> rasterized at
+    ///   <paramref name="scale"/>.
+    /// </summary>
+    auto cache_path(const rainbow::Data& data, float scale) -> std::string
+    {
+        // FNV-1a; it needs to be stable across runs.
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            hash ^= data.bytes()[i];
+            hash *= 1099511628211ULL;
+        }
+
+        uint32_t scale_bits;
+        static_assert(sizeof(scale_bits) == sizeof(scale));
+        std::memcpy(&scale_bits, &scale, sizeof(scale));
+
+        std::array<char, 64> path;
+        std::snprintf(path.data(),
+                      path.size(),
+                      "%s/%016llx-%08x.rgba",
+                      kCacheDirectory,
+                      static_cast<unsigned long long>(hash),  // NOLINT
+                      scale_bits);
+        return path.data();
+    }
+
+    auto read_cache(const std::string& path)
+    {
+        using rainbow::File;
+        using rainbow::Image;
+
+        Image image{Image::Format::SVG};
+
+        const auto file = File::open(path.c_str(), rainbow::FileType::UserFile);
+        if (!file)
+            return image;
+
+        CacheHeader header{};
+        if (file.read(&header, sizeof(header)) != sizeof(header) ||
+            header.magic != kCacheMagic)
+        {
+            return image;
+        }
+
+        const auto size = size_t{header.width} * header.height * 4;
+        if (file.size() != sizeof(header) + size)
+            return image;
+
+        auto buffer = std::make_unique<uint8_t[]>(size);
+        if (file.read(buffer.get(), size) != size)
+            return image;
+
+        image.width = header.width;
+        image.height = header.height;
+        image.depth = 32;
+        image.channels = 4;
+        image.size = size;
+        image.data = buffer.release();
+        return image;
+    }
+
+    void write_cache(const std::string& path, const rainbow::Image& image)
+    {
+        // Fails quietly if there is no preferences directory.
+        rainbow::filesystem::create_directories(kCacheDirectory);
+        const auto file = rainbow::WriteableFile::open(path.c_str());
+        if (!file)
+            return;
+
+        const CacheHeader header{kCacheMagic, image.width, image.height};
+        if (file.write(&header, sizeof(header)) != sizeof(header) ||
+            file.write(image.data, image.size) != image.size)
+        {
+            LOGW("Failed to cache rasterized SVG: %s", path.c_str());
+        }
+    }
+
+    /// <summary>
+    ///   Rasterizes <paramref name="svg"/> in horizontal tiles, in parallel
+    ///   if <paramref name="job_pool"/> is set.
+    /// </summary>
+    /// <remarks>
+    ///   Every tile needs its own rasterizer, and flattens all paths again,
+    ///   so small images are done in one go.
+    /// </remarks>
+    void rasterize(NSVGimage* svg,
+                   float scale,
+                   int width,
+                   int height,
+                   int stride,
+                   uint8_t* dst,
+                   rainbow::JobPool* job_pool)
+    {
+        const auto workers = job_pool == nullptr
+                                 ? 0
+                                 : static_cast<int>(job_pool->worker_count());
+        const auto tile_count =
+            std::clamp(height / kMinTileHeight, 1, workers + 1);
+        const auto tile_height = (height + tile_count - 1) / tile_count;
+        auto rasterize_tile = [=](uint32_t tile) {
+            const auto y = static_cast<int>(tile) * tile_height;
+            const auto rows = std::min(tile_height, height - y);
+            if (rows <= 0)
+                return;
+
+            std::unique_ptr<NSVGrasterizer> rasterizer{nsvgCreateRasterizer()};
+            nsvgRasterize(rasterizer.get(),
+                          svg,
+                          0.0f,
+                          static_cast<float>(-y),
+                          scale,
+                          dst + static_cast<ptrdiff_t>(y) * stride,
+                          width,
+                          rows,
+                          stride);
+        };
+
+        if (tile_count == 1)
+            rasterize_tile(0);
+        else
+            job_pool->parallel_for(tile_count, rasterize_tile);
+    }
+
+    auto decode(const rainbow::Data& data,
+                float scale,
+                rainbow::JobPool* job_pool)
     {
-        rainbow::Image image{rainbow::Image::Format::SVG};
+        const auto path = cache_path(data, scale);
+        auto image = read_cache(path);
+        if (image.data != nullptr)
+            return image;
 
         std::unique_ptr<NSVGimage> img;
         {
@@ -61,19 +221,16 @@ namespace svg
         image.size = static_cast<size_t>(image.width) * image.height * 4;
 
         auto buffer = std::make_unique<uint8_t[]>(image.size);
-        std::unique_ptr<NSVGrasterizer> rasterizer{nsvgCreateRasterizer()};
-        nsvgRasterize(  //
-            rasterizer.get(),
-            img.get(),
-            0.0f,
-            0.0f,
-            scale,
-            buffer.get(),
-            img->width * scale,
-            img->height * scale,
-            image.width * 4);
+        rasterize(img.get(),
+                  scale,
+                  static_cast<int>(img->width * scale),
+                  static_cast<int>(img->height * scale),
+                  static_cast<int>(image.width * 4),
+                  buffer.get(),
+                  job_pool);
 
         image.data = buffer.release();
+        write_cache(path, image);
         return image;
     }
 }  // namespace svg
@@ -0,0 +1,77 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_DIRTYRANGES_H_
+#define GRAPHICS_DIRTYRANGES_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace rainbow::graphics
+{
+    /// <summary>
+    ///   Tracks ranges of stale elements that need to be uploaded.
+    /// </summary>
+    /// <remarks>
+    ///   Elements must be added in ascending order. Ranges separated by no
+    ///   more than <c>gap()</c> elements are coalesced into one to reduce the
+    ///   number of buffer updates.
+    /// </remarks>
+    class DirtyRanges
+    {
+    public:
+        /// <summary>Half-open range of elements, [first, last).</summary>
+        struct Range
+        {
+            uint32_t first;
+            uint32_t last;
+
+            [[nodiscard]] auto size() const { return last - first; }
+        };
+
+        static constexpr uint32_t kDefaultGap = 8;
+
+        [[nodiscard]] auto begin() const { return ranges_.begin(); }
+        [[nodiscard]] auto end() const { return ranges_.end(); }
+
+        [[nodiscard]] auto empty() const { return ranges_.empty(); }
+
+        /// <summary>
+        ///   Returns the maximum number of clean elements allowed between two
+        ///   ranges before they are kept apart.
+        /// </summary>
+        [[nodiscard]] auto gap() const { return gap_; }
+
+        /// <summary>Returns the number of ranges.</summary>
+        [[nodiscard]] auto size() const { return ranges_.size(); }
+
+        /// <summary>Marks element <paramref name="i"/> as stale.</summary>
+        void add(uint32_t i)
+        {
+            if (!ranges_.empty() && i <= ranges_.back().last + gap_)
+            {
+                auto& range = ranges_.back();
+                if (i >= range.last)
+                    range.last = i + 1;
+                return;
+            }
+
+            ranges_.push_back({i, i + 1});
+        }
+
+        void clear() { ranges_.clear(); }
+
+        /// <summary>
+        ///   Sets the maximum number of clean elements allowed between two
+        ///   ranges before they are kept apart.
+        /// </summary>
+        void set_gap(uint32_t gap) { gap_ = gap; }
+
+    private:
+        std::vector<Range> ranges_;
+        uint32_t gap_ = kDefaultGap;
+    };
+}  // namespace rainbow::graphics
+
+#endif
@@ -0,0 +1,224 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/DrawMerger.h"
+
+#include "Graphics/InstancedSpriteBatch.h"
+#include "Graphics/Label.h"
+#include "Graphics/RenderLayer.h"
+#include "Graphics/Renderer.h"
+#include "Text/FontCache.h"
+
+using rainbow::Animation;
+using rainbow::IDrawable;
+using rainbow::InstancedSpriteBatch;
+using rainbow::Label;
+using rainbow::SpriteBatch;
+using rainbow::SpriteVertex;
+using rainbow::graphics::DrawMerger;
+using rainbow::graphics::RenderLayer;
+using rainbow::graphics::RenderQueue;
+using rainbow::graphics::ShaderManager;
+using rainbow::graphics::Texture;
+
+namespace
+{
+    struct Mergeable
+    {
+        enum class Kind
+        {
+            /// <summary>Unit draws nothing; does not end a run.</summary>
+            Skip,
+
+            /// <summary>Unit must be drawn on its own; ends a run.</summary>
+            Break,
+
+            /// <summary>Unit can be merged with its neighbours.</summary>
+            Merge,
+        };
+
+        Kind kind;
+        const Texture* texture = nullptr;
+        const SpriteVertex* vertices = nullptr;
+        uint32_t sprites = 0;
+
+        /// <summary>Whether the unit is drawn with the text program.</summary>
+        bool glyphs = false;
+    };
+
+    struct ClassifyCommand
+    {
+        auto operator()(Animation*) const -> Mergeable
+        {
+            return {Mergeable::Kind::Skip};
+        }
+
+        auto operator()(IDrawable*) const -> Mergeable
+        {
+            return {Mergeable::Kind::Break};
+        }
+
+        auto operator()(InstancedSpriteBatch* batch) const -> Mergeable
+        {
+            if (!batch->is_visible() || batch->size() == 0)
+                return {Mergeable::Kind::Skip};
+
+            return {Mergeable::Kind::Break};
+        }
+
+        auto operator()(Label* label) const -> Mergeable
+        {
+            const auto length = label->length();
+            if (length == 0)
+                return {Mergeable::Kind::Skip};
+
+            // Distance fields are drawn with a shader of their own, and
+            // glyphs spread over several pages with several textures.
+            if (length > DrawMerger::kMaxMergeableSprites ||
+                label->pages().size() != 1 ||
+                label->glyph_rendering() ==
+                    rainbow::GlyphRendering::DistanceField)
+            {
+                return {Mergeable::Kind::Break};
+            }
+
+            return {Mergeable::Kind::Merge,
+                    &rainbow::FontCache::Get()->texture(
+                        label->pages().front().page),
+                    label->vertex_buffer(),
+                    length,
+                    true};
+        }
+
+        auto operator()(RenderLayer* layer) const -> Mergeable
+        {
+            // Layers change render target and blending when drawn.
+            return {layer->queue().empty() ? Mergeable::Kind::Skip
+                                           : Mergeable::Kind::Break};
+        }
+
+        auto operator()(SpriteBatch* batch) const -> Mergeable
+        {
+            if (!batch->is_visible() || batch->size() == 0)
+                return {Mergeable::Kind::Skip};
+
+            // Culling batches only draw their visible sprites, and keep count
+            // of them, when drawn on their own.
+            if (batch->texture() == nullptr || batch->normal() != nullptr ||
+                batch->is_culling() ||
+                batch->size() > DrawMerger::kMaxMergeableSprites)
+            {
+                return {Mergeable::Kind::Break};
+            }
+
+            return {Mergeable::Kind::Merge,
+                    batch->texture(),
+                    batch->vertices(),
+                    batch->size()};
+        }
+    };
+
+    auto classify(const rainbow::graphics::RenderUnit& unit)
+    {
+        return !unit.is_enabled() ? Mergeable{Mergeable::Kind::Skip}
+                                  : visit(ClassifyCommand{}, unit.object());
+    }
+}  // namespace
+
+void DrawMerger::compile(const RenderQueue& queue,
+                         uint32_t max_sprites,
+                         std::vector<Run>& runs)
+{
+    runs.clear();
+
+    Run run{};
+    auto flush = [&runs, &run] {
+        if (run.units > 1)
+            runs.push_back(run);
+        run.units = 0;
+        run.sprites = 0;
+    };
+
+    const auto size = narrow_cast<uint32_t>(queue.size());
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        const auto unit = classify(queue[i]);
+        switch (unit.kind)
+        {
+            case Mergeable::Kind::Skip:
+                break;
+
+            case Mergeable::Kind::Break:
+                flush();
+                break;
+
+            case Mergeable::Kind::Merge:
+                if (run.units > 0 &&
+                    (unit.texture->storage_key() !=
+                         run.texture->storage_key() ||
+                     run.sprites + unit.sprites > max_sprites))
+                {
+                    flush();
+                }
+                if (run.units == 0)
+                {
+                    run.first = i;
+                    run.texture = unit.texture;
+                }
+                run.last = i + 1;
+                ++run.units;
+                run.sprites += unit.sprites;
+                break;
+        }
+    }
+
+    flush();
+}
+
+DrawMerger::DrawMerger()
+{
+    array_.reconfigure([this] { buffer_.bind(); });
+}
+
+void DrawMerger::compile(const RenderQueue& queue)
+{
+    compile(queue, ElementBuffer::kInitialCapacity, runs_);
+}
+
+void DrawMerger::draw(Context& ctx, const RenderQueue& queue, const Run& run)
+{
+    // Units sharing a texture are either all labels or all sprite batches.
+    bool glyphs = false;
+    vertices_.clear();
+    for (auto i = run.first; i < run.last; ++i)
+    {
+        const auto unit = classify(queue[i]);
+        if (unit.kind != Mergeable::Kind::Merge)
+            continue;
+
+        glyphs = unit.glyphs;
+        vertices_.insert(vertices_.end(),
+                         unit.vertices,
+                         unit.vertices + unit.sprites * size_t{4});
+    }
+
+    buffer_.upload(vertices_.data(), vertices_.size() * sizeof(SpriteVertex));
+
+    bind(ctx, *run.texture);
+    if (glyphs)
+    {
+        const auto program = text_program(ctx);
+        if (program == ShaderManager::kInvalidProgram)
+            return;
+
+        auto scope = ctx.shader_manager.use_scoped(program);
+        graphics::draw(array_, buffer_, run.sprites * 6);
+    }
+    else
+    {
+        graphics::draw(array_, buffer_, run.sprites * 6);
+    }
+
+    IF_DEBUG(increment_merged_draw_count(run.units - 1));
+}
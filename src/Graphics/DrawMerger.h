@@ -0,0 +1,94 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_DRAWMERGER_H_
+#define GRAPHICS_DRAWMERGER_H_
+
+#include <vector>
+
+#include "Graphics/Buffer.h"
+#include "Graphics/RenderQueue.h"
+#include "Graphics/SpriteVertex.h"
+#include "Graphics/VertexArray.h"
+
+namespace rainbow::graphics
+{
+    class Texture;
+
+    /// <summary>
+    ///   Merges consecutive render units that share the same texture into a
+    ///   single draw call.
+    /// </summary>
+    /// <remarks>
+    ///   <para>
+    ///     Only label and sprite batch units without normal maps are merged.
+    ///     Any other unit ends the current run since it may change program or
+    ///     other GL state. Disabled, hidden and empty units draw nothing and
+    ///     are skipped over, so queue order is always preserved.
+    ///   </para>
+    ///   <para>
+    ///     Merged vertices are copied into a buffer that streams from the
+    ///     context's streaming buffer, if enabled.
+    ///   </para>
+    /// </remarks>
+    class DrawMerger : private NonCopyable<DrawMerger>
+    {
+    public:
+        /// <summary>
+        ///   Units larger than this keep their own draw call. Their retained
+        ///   buffers are cheaper than copying them every frame.
+        /// </summary>
+        static constexpr uint32_t kMaxMergeableSprites = 256;
+
+        /// <summary>A run of units to be drawn with a single call.</summary>
+        struct Run
+        {
+            /// <summary>Index of the first unit in the queue.</summary>
+            uint32_t first;
+
+            /// <summary>Index past the last merged unit in the queue.</summary>
+            uint32_t last;
+
+            /// <summary>Number of merged units.</summary>
+            uint32_t units;
+
+            /// <summary>Total number of sprites (or glyphs).</summary>
+            uint32_t sprites;
+
+            /// <summary>Texture shared by all merged units.</summary>
+            const Texture* texture;
+        };
+
+        /// <summary>
+        ///   Finds all runs of two or more mergeable units in
+        ///   <paramref name="queue"/>, with at most
+        ///   <paramref name="max_sprites"/> sprites each.
+        /// </summary>
+        static void compile(const RenderQueue& queue,
+                            uint32_t max_sprites,
+                            std::vector<Run>& runs);
+
+        DrawMerger();
+
+        /// <summary>Returns runs found during the last compile pass.</summary>
+        [[nodiscard]] auto runs() const -> const std::vector<Run>&
+        {
+            return runs_;
+        }
+
+        /// <summary>Compiles the render queue for drawing.</summary>
+        void compile(const RenderQueue& queue);
+
+        /// <summary>Draws a merged run of units.</summary>
+        void draw(Context&, const RenderQueue&, const Run&);
+
+    private:
+        std::vector<Run> runs_;
+        std::vector<SpriteVertex> vertices_;
+        Buffer buffer_{Buffer::Usage::Stream};
+        VertexArray array_;
+    };
+}  // namespace rainbow::graphics
+
+#endif
@@ -4,26 +4,106 @@
 
 #include "Graphics/ElementBuffer.h"
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include "Common/Logging.h"
 #include "Graphics/OpenGL.h"
+#include "Graphics/Renderer.h"
 
 using rainbow::graphics::ElementBuffer;
 
+namespace
+{
+    template <typename T>
+    void upload_indices(uint32_t count)
+    {
+        auto indices = std::make_unique<T[]>(count * size_t{6});
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto index = i * size_t{6};
+            const auto vertex = static_cast<T>(i * 4);
+            indices[index] = vertex;
+            indices[index + 1] = vertex + 1;
+            indices[index + 2] = vertex + 2;
+            indices[index + 3] = vertex + 2;
+            indices[index + 4] = vertex + 3;
+            indices[index + 5] = vertex;
+        }
+
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     count * 6 * sizeof(T),
+                     indices.get(),
+                     GL_STATIC_DRAW);
+    }
+
+    auto has_element_index_uint()
+    {
+#ifdef GL_ES_VERSION_2_0
+        return rainbow::graphics::has_gl_version(3, 0) ||
+               rainbow::graphics::has_extension("GL_OES_element_index_uint");
+#else
+        return true;
+#endif
+    }
+}  // namespace
+
 ElementBuffer::~ElementBuffer()
 {
     if (buffer_ == 0)
         return;
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // The state cache is torn down with the context that owns this buffer.
     glDeleteBuffers(1, &buffer_);
 }
 
+auto ElementBuffer::max_sprites() const -> uint32_t
+{
+    return index_type_ == GL_UNSIGNED_INT
+               ? std::numeric_limits<int32_t>::max() / 6
+               : kMaxShortIndexedSprites;
+}
+
 void ElementBuffer::bind() const
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer_);
+    state_cache().bind_element_buffer(buffer_);
+}
+
+void ElementBuffer::initialize()
+{
+    if (has_element_index_uint())
+    {
+        index_type_ = GL_UNSIGNED_INT;
+    }
+    else
+    {
+        LOGI("32-bit indices are not supported; large batches will be split");
+        index_type_ = GL_UNSIGNED_SHORT;
+    }
+
+    glGenBuffers(1, &buffer_);
+    upload(kInitialCapacity);
 }
 
-void ElementBuffer::upload(const void* data, size_t size) const
+void ElementBuffer::reserve(uint32_t count)
 {
+    count = std::min(count, max_sprites());
+    if (count <= capacity_)
+        return;
+
+    upload(std::min(std::max(count, capacity_ * 2), max_sprites()));
+}
+
+void ElementBuffer::upload(uint32_t count)
+{
+    // Vertex array objects keep referring to this buffer object, so there is
+    // no need to reconfigure them.
     bind();
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    if (index_type_ == GL_UNSIGNED_INT)
+        upload_indices<uint32_t>(count);
+    else
+        upload_indices<uint16_t>(count);
+
+    capacity_ = count;
 }
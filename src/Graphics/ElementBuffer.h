@@ -5,26 +5,63 @@
 #ifndef GRAPHICS_ELEMENTBUFFER_H_
 #define GRAPHICS_ELEMENTBUFFER_H_
 
+#include <cstdint>
 #include <cstdlib>
 
 namespace rainbow::graphics
 {
+    /// <summary>Shared index buffer for drawing quads.</summary>
+    /// <remarks>
+    ///   Indices are 32-bit where supported, and the buffer grows to fit the
+    ///   largest batch drawn. With 16-bit indices, at most
+    ///   <c>kMaxShortIndexedSprites</c> can be drawn per call.
+    /// </remarks>
     class ElementBuffer
     {
     public:
+        /// <summary>Number of quads initially indexed.</summary>
+        static constexpr uint32_t kInitialCapacity = 4096;
+
+        /// <summary>Number of quads addressable with 16-bit indices.</summary>
+        static constexpr uint32_t kMaxShortIndexedSprites = 0x10000 / 4;
+
         ~ElementBuffer();
 
+        /// <summary>Returns the number of quads currently indexed.</summary>
+        [[nodiscard]] auto capacity() const { return capacity_; }
+
+        /// <summary>
+        ///   Returns the index type; either <c>GL_UNSIGNED_INT</c> or
+        ///   <c>GL_UNSIGNED_SHORT</c>.
+        /// </summary>
+        [[nodiscard]] auto index_type() const { return index_type_; }
+
+        /// <summary>
+        ///   Returns the maximum number of quads that can be drawn per call.
+        /// </summary>
+        [[nodiscard]] auto max_sprites() const -> uint32_t;
+
         void bind() const;
-        void upload(const void* data, size_t size) const;
 
-        auto operator=(unsigned int buffer) -> ElementBuffer&
-        {
-            buffer_ = buffer;
-            return *this;
-        }
+        /// <summary>
+        ///   Creates the buffer object and picks the widest supported index
+        ///   type.
+        /// </summary>
+        void initialize();
+
+        /// <summary>
+        ///   Grows the buffer, if necessary, to index at least
+        ///   <paramref name="count"/> quads, or as many as
+        ///   <see cref="max_sprites"/> allows.
+        /// </summary>
+        void reserve(uint32_t count);
 
     private:
         unsigned int buffer_ = 0;
+        unsigned int index_type_ = 0;
+        uint32_t capacity_ = 0;
+
+        void upload(uint32_t count);
     };
 }  // namespace rainbow::graphics
 
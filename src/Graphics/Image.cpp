@@ -4,8 +4,12 @@
 
 #include "Graphics/Image.h"
 
+#include <algorithm>
+#include <memory>
+
 #include "Common/Data.h"
 #include "Common/Logging.h"
+#include "Graphics/Decoders/KTX.h"
 #include "Graphics/Decoders/PNG.h"
 #include "Graphics/Decoders/SVG.h"
 #include "Graphics/OpenGL.h"
@@ -19,7 +23,71 @@
 using rainbow::Data;
 using rainbow::Image;
 
-auto Image::decode(const Data& data, float scale) -> Image
+namespace
+{
+    auto is_compressed(Image::Format format)
+    {
+        switch (format)
+        {
+            case Image::Format::ASTC:
+            case Image::Format::ATITC:
+            case Image::Format::BC1:
+            case Image::Format::BC2:
+            case Image::Format::BC3:
+            case Image::Format::BC4:
+            case Image::Format::BC5:
+            case Image::Format::BC6H:
+            case Image::Format::BC7:
+            case Image::Format::ETC1:
+            case Image::Format::ETC2:
+            case Image::Format::PVRTC:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    auto mip_size(uint32_t size, uint32_t level)
+    {
+        return std::max(size >> level, 1U);
+    }
+
+    /// <summary>
+    ///   Writes the next mip level of the image at <paramref name="src"/>
+    ///   to <paramref name="dst"/>, averaging every 2x2 block of pixels.
+    /// </summary>
+    void box_filter(const uint8_t* src,
+                    uint32_t width,
+                    uint32_t height,
+                    uint32_t channels,
+                    uint8_t* dst)
+    {
+        const auto dst_width = mip_size(width, 1);
+        const auto dst_height = mip_size(height, 1);
+        for (uint32_t y = 0; y < dst_height; ++y)
+        {
+            const auto y0 = y * 2;
+            const auto y1 = std::min(y0 + 1, height - 1);
+            for (uint32_t x = 0; x < dst_width; ++x)
+            {
+                const auto x0 = x * 2;
+                const auto x1 = std::min(x0 + 1, width - 1);
+                for (uint32_t c = 0; c < channels; ++c)
+                {
+                    const auto sum = src[(y0 * width + x0) * channels + c] +
+                                     src[(y0 * width + x1) * channels + c] +
+                                     src[(y1 * width + x0) * channels + c] +
+                                     src[(y1 * width + x1) * channels + c];
+                    *dst++ = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+}  // namespace
+
+auto Image::decode(const Data& data,
+                   float scale,
+                   [[maybe_unused]] JobPool* job_pool) -> Image
 {
 #ifdef USE_DDS
     if (dds::check(data))
@@ -31,11 +99,14 @@ auto Image::decode(const Data& data, float scale) -> Image
         return pvrtc::decode(data);
 #endif  // USE_PVRTC
 
+    if (ktx::check(data))
+        return ktx::decode(data);
+
     if (png::check(data))
         return png::decode(data);
 
     if (svg::check(data))
-        return svg::decode(data, scale);
+        return svg::decode(data, scale, job_pool);
 
 #ifdef RAINBOW_TEST
     if (memcmp(data.bytes(), "RNBWMOCK", 8) == 0)
@@ -45,3 +116,148 @@ auto Image::decode(const Data& data, float scale) -> Image
     R_ASSERT(false, "Unknown image format");
     return {};
 }
+
+auto Image::decode_into(const Data& data, uint8_t* buffer) -> Image
+{
+    return png::check(data) ? png::decode_into(data, buffer) : Image{};
+}
+
+auto Image::probe(const Data& data) -> Image
+{
+    return png::check(data) ? png::probe(data) : Image{};
+}
+
+auto Image::with_mipmaps(Image&& image, uint32_t skip_levels, bool chain)
+    -> Image
+{
+    if (is_compressed(image.format))
+    {
+        // Compressed formats never own their data, so we can simply point
+        // past the skipped levels, or drop their offsets.
+        skip_levels = std::min(skip_levels, image.mip_levels - 1);
+        const auto levels = chain ? image.mip_levels - skip_levels : 1;
+        const auto has_offsets = !image.level_offsets.empty();
+        const auto offset = has_offsets ? 0 : image.level_offset(skip_levels);
+
+        Image result(image.format,
+                     mip_size(image.width, skip_levels),
+                     mip_size(image.height, skip_levels),
+                     image.depth,
+                     image.channels,
+                     0,
+                     image.data + offset);
+        result.mip_levels = levels;
+        result.block_width = image.block_width;
+        result.block_height = image.block_height;
+        if (has_offsets)
+        {
+            const auto first = image.level_offsets.begin() + skip_levels;
+            result.level_offsets.assign(first, first + levels);
+        }
+
+        for (uint32_t i = 0; i < levels; ++i)
+            result.size += result.level_size(i);
+        return result;
+    }
+
+    const auto is_owned =
+        image.format == Format::PNG || image.format == Format::SVG;
+    if ((!is_owned && image.format != Format::RGBA) || image.data == nullptr ||
+        image.depth != image.channels * 8 || (skip_levels == 0 && !chain))
+    {
+        return std::move(image);
+    }
+
+    // Halve until we reach the new base level, or cannot go any further.
+    std::unique_ptr<uint8_t[]> base;  // NOLINT(*-avoid-c-arrays)
+    auto base_data = image.data;
+    auto width = image.width;
+    auto height = image.height;
+    for (; skip_levels > 0 && (width > 1 || height > 1); --skip_levels)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+        auto next = std::make_unique<uint8_t[]>(size_t{mip_size(width, 1)} *
+                                                mip_size(height, 1) *
+                                                image.channels);
+        box_filter(base_data, width, height, image.channels, next.get());
+        base = std::move(next);
+        base_data = base.get();
+        width = mip_size(width, 1);
+        height = mip_size(height, 1);
+    }
+
+    Image result(image.format == Format::SVG ? Format::SVG : Format::PNG,
+                 width,
+                 height,
+                 image.depth,
+                 image.channels);
+    result.mip_levels = 1;
+    if (chain)
+    {
+        while (mip_size(width, result.mip_levels - 1) > 1 ||
+               mip_size(height, result.mip_levels - 1) > 1)
+        {
+            ++result.mip_levels;
+        }
+    }
+
+    result.size = result.level_offset(result.mip_levels);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+    auto buffer = std::make_unique<uint8_t[]>(result.size);
+    std::copy_n(base_data, result.level_size(0), buffer.get());
+    for (uint32_t level = 1; level < result.mip_levels; ++level)
+    {
+        box_filter(buffer.get() + result.level_offset(level - 1),
+                   mip_size(width, level - 1),
+                   mip_size(height, level - 1),
+                   image.channels,
+                   buffer.get() + result.level_offset(level));
+    }
+
+    result.data = buffer.release();
+    return result;
+}
+
+auto Image::level_offset(uint32_t level) const -> size_t
+{
+    if (!level_offsets.empty())
+        return level_offsets[level];
+
+    size_t offset = 0;
+    for (uint32_t i = 0; i < level; ++i)
+        offset += level_size(i);
+    return offset;
+}
+
+auto Image::level_size(uint32_t level) const -> size_t
+{
+    const size_t w = mip_size(width, level);
+    const size_t h = mip_size(height, level);
+    const auto blocks = ((w + 3) / 4) * ((h + 3) / 4);
+    switch (format)
+    {
+        case Format::ASTC:
+            return ((w + block_width - 1) / block_width) *
+                   ((h + block_height - 1) / block_height) * 16;
+        case Format::ATITC:
+        case Format::ETC2:
+            return blocks * (channels == 3 ? 8 : 16);
+        case Format::BC1:
+        case Format::BC4:
+        case Format::ETC1:
+            return blocks * 8;
+        case Format::BC2:
+        case Format::BC3:
+        case Format::BC5:
+        case Format::BC6H:
+        case Format::BC7:
+            return blocks * 16;
+        case Format::PVRTC:
+            return depth == 2
+                       ? std::max<size_t>(w, 16) * std::max<size_t>(h, 8) / 4
+                       : std::max<size_t>(w, 8) * std::max<size_t>(h, 8) / 2;
+        default:
+            return w * h * depth / 8;
+    }
+}
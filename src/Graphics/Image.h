@@ -7,23 +7,33 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 #include "Common/NonCopyable.h"
 
 namespace rainbow
 {
     class Data;
+    class JobPool;
 
     struct Image : private NonCopyable<Image>
     {
         enum class Format
         {
             Unknown,
+            Alpha,  // 8-bit coverage, e.g. glyphs
+            ASTC,   // OpenGL ES 3.2, most mobile GPUs
             ATITC,  // Adreno
             BC1,    // DXT1
             BC2,    // DXT3
             BC3,    // DXT5
+            BC4,    // RGTC1
+            BC5,    // RGTC2
+            BC6H,   // BPTC, unsigned float
+            BC7,    // BPTC
             ETC1,   // OpenGL ES standard
+            ETC2,   // OpenGL ES 3.0 standard
             PVRTC,  // iOS, OMAP43xx, PowerVR
             PNG,
             RGBA,
@@ -36,6 +46,10 @@ namespace rainbow
         ///   <list type="bullet">
         ///     <item>iOS: PVRTC and whatever UIImage devours.</item>
         ///     <item>Others: PNG.</item>
+        ///     <item>
+        ///       All: KTX and KTX2 containing ASTC, BC1-7 or ETC1/2. The
+        ///       image points straight into the file data.
+        ///     </item>
         ///   </list>
         ///   Limitations
         ///   <list type="bullet">
@@ -44,12 +58,51 @@ namespace rainbow
         ///       it's not supported.
         ///     </item>
         ///     <item>
-        ///       PVRTC: PVR3 only; square, power of 2; no mipmaps;
-        ///       pre-multiplied alpha.
+        ///       PVRTC: PVR3 only; square, power of 2; pre-multiplied alpha.
+        ///     </item>
+        ///     <item>
+        ///       KTX/KTX2: 2D only; no supercompression; sRGB is treated as
+        ///       linear; BC6H must be unsigned.
         ///     </item>
         ///   </list>
+        ///   SVGs are rasterized in tiles on <paramref name="job_pool"/> if
+        ///   set, and cached in the preferences directory.
+        /// </remarks>
+        static auto decode(const Data&,
+                           float scale,
+                           JobPool* job_pool = nullptr) -> Image;
+
+        /// <summary>
+        ///   Decodes <paramref name="data"/> into <paramref name="buffer"/>,
+        ///   which must hold at least <see cref="probe"/>'s size. The image
+        ///   does not own <paramref name="buffer"/>.
+        /// </summary>
+        static auto decode_into(const Data& data, uint8_t* buffer) -> Image;
+
+        /// <summary>
+        ///   Returns the size and dimensions of the RGBA image that
+        ///   <see cref="decode_into"/> would produce, without decoding it. The
+        ///   format is unknown if <paramref name="data"/> cannot be decoded
+        ///   into a caller-supplied buffer.
+        /// </summary>
+        /// <remarks>
+        ///   Only PNG, except grayscale with alpha, is supported.
         /// </remarks>
-        static auto decode(const Data&, float scale) -> Image;
+        static auto probe(const Data& data) -> Image;
+
+        /// <summary>
+        ///   Returns <paramref name="image"/> with its first
+        ///   <paramref name="skip_levels"/> mip levels dropped and, if
+        ///   <paramref name="chain"/> is set, with a full mip chain.
+        /// </summary>
+        /// <remarks>
+        ///   Compressed images can only use the levels they were baked with.
+        ///   Uncompressed images with 8 bits per channel are box filtered.
+        ///   Other images are returned as is.
+        /// </remarks>
+        static auto with_mipmaps(Image&& image,
+                                 uint32_t skip_levels,
+                                 bool chain) -> Image;
 
         Format format;        // NOLINT
         uint32_t width;       // NOLINT
@@ -59,6 +112,22 @@ namespace rainbow
         size_t size;          // NOLINT
         const uint8_t* data;  // NOLINT
 
+        /// <summary>
+        ///   Number of mip levels stored in <see cref="data"/>, starting with
+        ///   the full-size image.
+        /// </summary>
+        uint32_t mip_levels = 1;  // NOLINT
+
+        /// <summary>Block footprint of ASTC images.</summary>
+        uint32_t block_width = 4;   // NOLINT
+        uint32_t block_height = 4;  // NOLINT
+
+        /// <summary>
+        ///   Byte offsets of each mip level in <see cref="data"/>, if they are
+        ///   not stored consecutively.
+        /// </summary>
+        std::vector<size_t> level_offsets;  // NOLINT
+
         Image(Format format_ = Format::Unknown,
               uint32_t width_ = 0,
               uint32_t height_ = 0,
@@ -74,7 +143,9 @@ namespace rainbow
         Image(Image&& image) noexcept
             : format(image.format), width(image.width), height(image.height),
               depth(image.depth), channels(image.channels), size(image.size),
-              data(image.data)
+              data(image.data), mip_levels(image.mip_levels),
+              block_width(image.block_width), block_height(image.block_height),
+              level_offsets(std::move(image.level_offsets))
         {
             image.format = Format::Unknown;
             image.width = 0;
@@ -83,17 +154,37 @@ namespace rainbow
             image.channels = 0;
             image.size = 0;
             image.data = nullptr;
+            image.mip_levels = 1;
+            image.level_offsets.clear();
         }
 
+        /// <summary>
+        ///   Returns the byte offset of mip level <paramref name="level"/> in
+        ///   <see cref="data"/>.
+        /// </summary>
+        [[nodiscard]] auto level_offset(uint32_t level) const -> size_t;
+
+        /// <summary>
+        ///   Returns the size in bytes of mip level <paramref name="level"/>.
+        /// </summary>
+        [[nodiscard]] auto level_size(uint32_t level) const -> size_t;
+
         ~Image()
         {
             switch (format)
             {
+                case Format::Alpha:
+                case Format::ASTC:
                 case Format::ATITC:
                 case Format::BC1:
                 case Format::BC2:
                 case Format::BC3:
+                case Format::BC4:
+                case Format::BC5:
+                case Format::BC6H:
+                case Format::BC7:
                 case Format::ETC1:
+                case Format::ETC2:
                 case Format::PVRTC:
                 case Format::RGBA:
                     break;
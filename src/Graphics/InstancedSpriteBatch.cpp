@@ -0,0 +1,199 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/InstancedSpriteBatch.h"
+
+#include "Graphics/Renderer.h"
+#include "Graphics/Shaders.h"
+#include "Script/GameBase.h"
+
+using rainbow::GameBase;
+using rainbow::InstancedSpriteBatch;
+using rainbow::SpriteInstance;
+using rainbow::SpriteRef;
+using rainbow::Vec2f;
+using rainbow::graphics::Context;
+using rainbow::graphics::ShaderManager;
+using rainbow::graphics::Texture;
+
+namespace gl = rainbow::graphics::gl;
+
+namespace
+{
+    constexpr Vec2f kCorners[]{{0.0F, 0.0F},
+                               {1.0F, 0.0F},
+                               {1.0F, 1.0F},
+                               {0.0F, 1.0F}};
+
+    [[maybe_unused]] auto instanced_program(Context& context) -> unsigned int
+    {
+        if (context.sprite_instancing_program != ShaderManager::kInvalidProgram)
+            return context.sprite_instancing_program;
+
+        auto& shader_manager = context.shader_manager;
+        Shader::Params shaders[]{
+            gl::Instanced2D_vert(),
+            {Shader::kTypeFragment, 1, nullptr, nullptr}};  // kFixed2Df
+        const Shader::AttributeParams attributes[]{
+            {Shader::kAttributeVertex, "corner"},
+            {Shader::kAttributeColor, "color"},
+            {Shader::kAttributeTexCoord, "texcoord"},
+            {Shader::kAttributeTranslation, "translation"},
+            {Shader::kAttributeQuad, "quad"},
+            {Shader::kAttributeNone, nullptr}};
+        const auto program = shader_manager.compile(shaders, attributes);
+        if (program == ShaderManager::kInvalidProgram)
+            return program;
+
+        auto scope = shader_manager.use_scoped(program);
+        const auto& details = shader_manager.get_program(program);
+        glUniform1i(glGetUniformLocation(details.program, "texture"), 0);
+
+        R_ASSERT(glGetError() == GL_NO_ERROR,
+                 "Failed to load instanced sprite shader");
+
+        context.sprite_instancing_program = program;
+        return program;
+    }
+}  // namespace
+
+auto InstancedSpriteBatch::is_supported() -> bool
+{
+#ifdef USE_INSTANCED_ARRAYS
+    static const bool supported =
+        graphics::has_gl_version(3, 3) ||
+        (graphics::has_extension("GL_ARB_instanced_arrays") &&
+         graphics::has_extension("GL_ARB_draw_instanced"));
+    return supported;
+#else
+    return false;
+#endif
+}
+
+InstancedSpriteBatch::InstancedSpriteBatch(uint32_t count)
+    : SpriteBatch(count, !is_supported())
+{
+    if (!is_supported())
+        return;
+
+    instances_ = std::make_unique<SpriteInstance[]>(count);
+    capacity_ = count;
+    corner_buffer_.upload(kCorners, sizeof(kCorners));
+    array_.reconfigure([this] {
+        corner_buffer_.bind(Shader::kAttributeVertex);
+        instance_buffer_.bind_instances();
+    });
+}
+
+void InstancedSpriteBatch::set_normal(const Texture& texture)
+{
+    R_ASSERT(!is_instanced(), "Normal maps are not supported when instanced");
+
+    SpriteBatch::set_normal(texture);
+}
+
+auto InstancedSpriteBatch::create_sprite(uint32_t width, uint32_t height)
+    -> SpriteRef
+{
+    auto ref = SpriteBatch::create_sprite(width, height);
+    if (ref && is_instanced())
+        instances_[size() - 1] = SpriteInstance{};
+    return ref;
+}
+
+void InstancedSpriteBatch::update(GameBase& context)
+{
+    update_vertices(context);
+    upload();
+}
+
+void InstancedSpriteBatch::update_vertices(GameBase& context)
+{
+    if (!is_instanced())
+    {
+        SpriteBatch::update_vertices(context);
+        return;
+    }
+
+    auto sprites = begin();
+    auto texture = context.texture_provider().raw_get(*this->texture());
+    invalidate_stale_texture(texture);
+
+    dirty_ranges_.clear();
+    auto& stale = stale_sprites();
+    for (auto i : stale.sorted(size()))
+    {
+        if (sprites[i].update(instances_[i], texture))
+            dirty_ranges_.add(i);
+    }
+    stale.clear();
+}
+
+void InstancedSpriteBatch::upload()
+{
+    if (!is_instanced())
+    {
+        SpriteBatch::upload();
+        return;
+    }
+
+    if (dirty_ranges_.empty())
+        return;
+
+    if (needs_allocation_)
+    {
+        // Allocate for the full capacity so that subsequent updates only need
+        // to touch the stale ranges.
+        instance_buffer_.upload(instances_.get(),
+                                capacity_ * sizeof(SpriteInstance));
+        needs_allocation_ = false;
+        return;
+    }
+
+    for (auto&& range : dirty_ranges_)
+    {
+        instance_buffer_.update(instances_.get() + range.first,
+                                range.size() * sizeof(SpriteInstance),
+                                range.first * sizeof(SpriteInstance));
+    }
+}
+
+void rainbow::graphics::draw(Context& context,
+                             const InstancedSpriteBatch& batch)
+{
+    if (!batch.is_instanced())
+    {
+        draw(context, static_cast<const SpriteBatch&>(batch));
+        return;
+    }
+
+#ifdef USE_INSTANCED_ARRAYS
+    if (batch.texture() == nullptr)
+    {
+        R_ASSERT(batch.texture() != nullptr,  //
+                 "Cannot draw an untextured InstancedSpriteBatch");
+        return;
+    }
+
+    if (!batch.is_visible() || batch.size() == 0)
+        return;
+
+    const auto program = instanced_program(context);
+    if (program == ShaderManager::kInvalidProgram)
+        return;
+
+    bind(context, *batch.texture());
+
+    auto scope = context.shader_manager.use_scoped(program);
+    draw_instanced(batch.vertex_array(), 6, batch.size());
+#endif  // USE_INSTANCED_ARRAYS
+}
+
+#ifndef NDEBUG
+InstancedSpriteBatch::~InstancedSpriteBatch()
+{
+    Director::assert_unused(
+        this, "InstancedSpriteBatch deleted but is still in the render queue.");
+}
+#endif
@@ -0,0 +1,139 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_INSTANCEDSPRITEBATCH_H_
+#define GRAPHICS_INSTANCEDSPRITEBATCH_H_
+
+#include "Graphics/SpriteBatch.h"
+
+namespace rainbow
+{
+    /// <summary>A drawable batch of sprites, expanded on the GPU.</summary>
+    /// <remarks>
+    ///   <para>
+    ///     Instead of four transformed vertices per sprite, only a 40-byte
+    ///     instance record (position, angle, scaled quad, colour and UVs) is
+    ///     uploaded. Quads are expanded and rotated in the vertex shader, and
+    ///     the whole batch is drawn with a single instanced draw call.
+    ///   </para>
+    ///   <para>
+    ///     Where instanced arrays are unavailable (e.g. OpenGL ES 2.0), the
+    ///     batch behaves exactly like <see cref="SpriteBatch"/>. Normal maps
+    ///     are only supported in that case.
+    ///   </para>
+    /// </remarks>
+    class InstancedSpriteBatch : public SpriteBatch
+    {
+    public:
+        /// <summary>
+        ///   Returns whether the current context supports instanced drawing.
+        /// </summary>
+        static auto is_supported() -> bool;
+
+        /// <summary>Creates a batch of sprites.</summary>
+        /// <param name="count">Number of sprites to allocate for.</param>
+        explicit InstancedSpriteBatch(uint32_t count);
+
+        /// <summary>Returns the client instance buffer.</summary>
+        [[nodiscard]] auto instances() const { return instances_.get(); }
+
+        /// <summary>Returns whether sprites are drawn instanced.</summary>
+        [[nodiscard]] auto is_instanced() const -> bool
+        {
+            return static_cast<bool>(instances_);
+        }
+
+        /// <summary>
+        ///   Returns whether the last call to <see cref="update_vertices"/>
+        ///   found any stale sprites.
+        /// </summary>
+        [[nodiscard]] auto is_stale() const -> bool
+        {
+            return is_instanced() ? !dirty_ranges_.empty()
+                                  : SpriteBatch::is_stale();
+        }
+
+        /// <summary>Returns the vertex array object.</summary>
+        [[nodiscard]] auto vertex_array() const -> const graphics::VertexArray&
+        {
+            return is_instanced() ? array_ : SpriteBatch::vertex_array();
+        }
+
+        /// <summary>Assigns a normal map.</summary>
+        /// <remarks>Not supported when drawing instanced.</remarks>
+        void set_normal(const graphics::Texture&);
+        void set_normal(NotNull<const graphics::Texture*> texture)
+        {
+            set_normal(*texture.get());
+        }
+
+        /// <summary>
+        ///   Sets the maximum number of unchanged sprites allowed between two
+        ///   stale ranges before they are uploaded separately.
+        /// </summary>
+        void set_upload_gap(uint32_t gap)
+        {
+            SpriteBatch::set_upload_gap(gap);
+            dirty_ranges_.set_gap(gap);
+        }
+
+        /// <summary>Creates a sprite.</summary>
+        /// <param name="width">Width of the sprite.</param>
+        /// <param name="height">Height of the sprite.</param>
+        /// <returns>
+        ///   Reference to the newly created sprite, positioned at (0,0).
+        /// </returns>
+        auto create_sprite(uint32_t width, uint32_t height) -> SpriteRef;
+
+        /// <summary>Updates the batch of sprites.</summary>
+        void update(GameBase&);
+
+        /// <summary>
+        ///   Updates the client buffers of stale sprites. Does not make any GL
+        ///   calls and may be called from a worker thread.
+        /// </summary>
+        void update_vertices(GameBase&);
+
+        /// <summary>
+        ///   Uploads sprites found stale by the last call to
+        ///   <see cref="update_vertices"/>.
+        /// </summary>
+        void upload();
+
+#ifndef NDEBUG
+        ~InstancedSpriteBatch();
+#endif
+
+    private:
+        /// <summary>Client instance buffer.</summary>
+        std::unique_ptr<SpriteInstance[]> instances_;
+
+        /// <summary>Number of sprites allocated for.</summary>
+        uint32_t capacity_ = 0;
+
+        /// <summary>Stale sprites found during last update.</summary>
+        graphics::DirtyRanges dirty_ranges_;
+
+        /// <summary>Unit quad shared by all instances.</summary>
+        graphics::Buffer corner_buffer_;
+
+        /// <summary>Per-instance sprite data.</summary>
+        graphics::Buffer instance_buffer_;
+
+        /// <summary>Vertex array object for instanced drawing.</summary>
+        graphics::VertexArray array_;
+
+        /// <summary>
+        ///   Whether GPU buffers must be (re)allocated on next upload.
+        /// </summary>
+        bool needs_allocation_ = true;
+    };
+}  // namespace rainbow
+
+namespace rainbow::graphics
+{
+    void draw(Context&, const InstancedSpriteBatch&);
+}  // namespace rainbow::graphics
+
+#endif
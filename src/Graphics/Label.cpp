@@ -4,15 +4,65 @@
 
 #include "Graphics/Label.h"
 
+#include <algorithm>
+#include <string_view>
+
+#include "Graphics/Shaders.h"
 #include "Math/Transform.h"
 #include "Script/GameBase.h"
 
 using rainbow::Color;
 using rainbow::czstring;
+using rainbow::FontCache;
 using rainbow::GameBase;
+using rainbow::GlyphRendering;
 using rainbow::Label;
 using rainbow::TextAlignment;
 using rainbow::Vec2f;
+using rainbow::graphics::Context;
+using rainbow::graphics::ShaderManager;
+
+namespace gl = rainbow::graphics::gl;
+
+namespace
+{
+    auto compile_glyph_program(Context& context, Shader::Params fragment)
+        -> unsigned int
+    {
+        auto& shader_manager = context.shader_manager;
+        Shader::Params shaders[]{
+            {Shader::kTypeVertex, 0, nullptr, nullptr},  // kFixed2Dv
+            fragment};
+        const auto program = shader_manager.compile(shaders, nullptr);
+        if (program == ShaderManager::kInvalidProgram)
+            return program;
+
+        auto scope = shader_manager.use_scoped(program);
+        const auto& details = shader_manager.get_program(program);
+        glUniform1i(glGetUniformLocation(details.program, "texture"), 0);
+
+        R_ASSERT(glGetError() == GL_NO_ERROR, "Failed to load text shader");
+
+        return program;
+    }
+
+    auto distance_field_program(Context& context) -> unsigned int
+    {
+        if (context.distance_field_program != ShaderManager::kInvalidProgram)
+            return context.distance_field_program;
+
+        const auto program =
+            compile_glyph_program(context, gl::DistanceField_frag());
+        if (program == ShaderManager::kInvalidProgram)
+            return program;
+
+        const auto& details = context.shader_manager.get_program(program);
+        context.distance_field_program = program;
+        context.distance_field_smoothing =
+            glGetUniformLocation(details.program, "smoothing");
+        return program;
+    }
+}  // namespace
 
 Label::Label()
 {
@@ -65,10 +115,17 @@ auto Label::font_size(int font_size) -> Label&
     return *this;
 }
 
+auto Label::glyph_rendering(GlyphRendering rendering) -> Label&
+{
+    rendering_ = rendering;
+    set_needs_update(kStaleBuffer);
+    return *this;
+}
+
 auto Label::move(Vec2f delta) -> Label&
 {
     position_ += delta;
-    set_needs_update(kStaleBuffer);
+    set_needs_update(kStalePosition);
     return *this;
 }
 
@@ -76,7 +133,7 @@ auto Label::position(Vec2f position) -> Label&
 {
     position_.x = std::round(position.x);
     position_.y = std::round(position.y);
-    set_needs_update(kStaleBuffer);
+    set_needs_update(kStalePosition);
     return *this;
 }
 
@@ -94,31 +151,130 @@ auto Label::scale(float f) -> Label&
 auto Label::text(czstring text) -> Label&
 {
     text_ = text;
-    set_needs_update(kStaleBuffer);
+    set_needs_update(kStaleText);
     return *this;
 }
 
 void Label::update(GameBase& context)
 {
-    if (stale_ != 0)
+    prepare(context);
+    update_vertices();
+    upload();
+}
+
+void Label::prepare(GameBase& context)
+{
+    auto& typesetter = context.typesetter();
+
+    // Glyphs may have been evicted from the atlas since they were laid out.
+    auto& font_cache = typesetter.font_cache();
+    if (font_cache.generation() != atlas_generation_)
     {
-        update_internal(context);
-        upload();
-        clear_state();
+        atlas_generation_ = font_cache.generation();
+        set_needs_update(kStaleBuffer);
     }
+    else
+    {
+        for (auto&& range : pages_)
+            font_cache.mark_used(range.page);
+    }
+
+    if ((stale_ & (kStaleBuffer | kStaleText)) == 0)
+        return;
+
+    // Lines are laid out on their own so that only the ones that changed
+    // need to be shaped again, e.g. when a line is appended.
+    if ((stale_ & kStaleBuffer) != 0)
+        lines_.clear();
+
+    const TextAttributes attributes{
+        font_face_, font_size_, alignment_, rendering_};
+    const auto line_height = typesetter.line_height(attributes);
+
+    const std::string_view text = text_;
+    float width = 0.0F;
+    size_t line_count = 0;
+    size_t start = 0;
+    while (start < text.length())
+    {
+        const auto end = std::min(text.find('\n', start), text.length());
+        const auto line = text.substr(start, end - start);
+        if (line_count == lines_.size())
+            lines_.emplace_back();
+
+        auto& cached = lines_[line_count];
+        if (cached.text != line)
+        {
+            cached.text = line;
+            cached.vertices.clear();
+            cached.pages.clear();
+            cached.width = 0.0F;
+            if (!line.empty())
+            {
+                const Vec2f origin{
+                    0.0F, -line_height * narrow_cast<float>(line_count)};
+                Vec2f size;
+                cached.vertices = typesetter.draw_text(
+                    line, origin, attributes, &size, &cached.pages);
+                cached.width = size.x;
+            }
+        }
+
+        width = std::max(width, cached.width);
+        start = end + 1;  // Skip newline
+        ++line_count;
+    }
+
+    lines_.resize(line_count);
+    size_ = {width, line_height * narrow_cast<float>(line_count)};
 }
 
-void Label::update_internal(GameBase& context)
+void Label::update_vertices()
 {
-    if ((stale_ & kStaleBuffer) != 0)
+    if ((stale_ & (kStaleBuffer | kStalePosition | kStaleText)) != 0)
     {
-        vertices_ = context.typesetter().draw_text(
-            text_,
-            position_,
-            TextAttributes{font_face_, font_size_, alignment_},
-            &size_);
-        for (auto&& vx : vertices_)
-            vx.color = color_;
+        // Glyphs are grouped by atlas page so that each page takes only one
+        // draw call. Most labels fit in a single page.
+        pages_.clear();
+        for (auto&& line : lines_)
+        {
+            for (auto page : line.pages)
+            {
+                if (std::none_of(
+                        pages_.begin(), pages_.end(), [page](auto&& range) {
+                            return range.page == page;
+                        }))
+                {
+                    pages_.push_back({page, 0, 0});
+                }
+            }
+        }
+        std::sort(pages_.begin(), pages_.end(), [](auto&& lhs, auto&& rhs) {
+            return lhs.page < rhs.page;
+        });
+
+        vertices_.clear();
+        for (auto&& range : pages_)
+        {
+            range.first = length();
+            for (auto&& line : lines_)
+            {
+                for (size_t i = 0; i < line.pages.size(); ++i)
+                {
+                    if (line.pages[i] != range.page)
+                        continue;
+
+                    for (size_t j = i * 4; j < i * 4 + 4; ++j)
+                    {
+                        auto vx = line.vertices[j];
+                        vx.color = color_;
+                        vx.position += position_;
+                        vertices_.push_back(vx);
+                    }
+                }
+            }
+            range.count = length() - range.first;
+        }
     }
     else if ((stale_ & kStaleColor) != 0)
     {
@@ -127,14 +283,50 @@ void Label::update_internal(GameBase& context)
     }
 }
 
-void Label::upload() const
+void Label::upload()
 {
+    // Streamed vertices only last for the current frame.
+    if (stale_ == 0 && !buffer_.is_streaming())
+        return;
+
     buffer_.upload(vertices_.data(), vertices_.size() * sizeof(vertices_[0]));
+    clear_state();
+}
+
+auto rainbow::graphics::text_program(Context& ctx) -> unsigned int
+{
+    if (ctx.text_program == ShaderManager::kInvalidProgram)
+        ctx.text_program = compile_glyph_program(ctx, gl::Text_frag());
+    return ctx.text_program;
 }
 
 void rainbow::graphics::draw(Context& ctx, const Label& label)
 {
+    const bool distance_field =
+        label.glyph_rendering() == GlyphRendering::DistanceField;
+    const auto program =
+        distance_field ? distance_field_program(ctx) : text_program(ctx);
+    if (program == ShaderManager::kInvalidProgram)
+        return;
+
+    auto scope = ctx.shader_manager.use_scoped(program);
+    if (distance_field)
+    {
+        // Fields span twice the spread at the reference size; keep edges
+        // about a pixel wide at the label's size.
+        const auto scale = label.font_size() /
+                           narrow_cast<float>(FontCache::kDistanceFieldSize);
+        glUniform1f(ctx.distance_field_smoothing,
+                    0.25F / (FontCache::kDistanceFieldSpread * scale));
+    }
+
     auto& font_cache = *FontCache::Get();
-    bind(ctx, font_cache.texture());
-    draw(label.vertex_array(), label.vertex_count());
+    for (auto&& range : label.pages())
+    {
+        bind(ctx, font_cache.texture(range.page));
+        draw(label.vertex_array(),
+             label.buffer(),
+             range.first * 6,
+             range.count * 6);
+    }
 }
@@ -18,6 +18,7 @@
 #include "Graphics/SpriteVertex.h"
 #include "Graphics/VertexArray.h"
 #include "Math/Vec2.h"
+#include "Text/GlyphRendering.h"
 
 namespace rainbow
 {
@@ -31,9 +32,19 @@ namespace rainbow
         static constexpr uint32_t kStaleBuffer      = 1U << 0;
         static constexpr uint32_t kStaleBufferSize  = 1U << 1;
         static constexpr uint32_t kStaleColor       = 1U << 2;
+        static constexpr uint32_t kStalePosition    = 1U << 3;
+        static constexpr uint32_t kStaleText        = 1U << 4;
         static constexpr uint32_t kStaleMask        = 0xffffU;
         // clang-format on
 
+        /// <summary>Glyphs packed into the same atlas page.</summary>
+        struct PageRange
+        {
+            uint32_t page;
+            uint32_t first;
+            uint32_t count;
+        };
+
         Label();
         ~Label();
 
@@ -43,6 +54,12 @@ namespace rainbow
         /// <summary>Returns label angle of rotation.</summary>
         [[nodiscard]] auto angle() const { return angle_; }
 
+        /// <summary>Returns the vertex buffer.</summary>
+        [[nodiscard]] auto buffer() const -> const graphics::Buffer&
+        {
+            return buffer_;
+        }
+
         /// <summary>Returns label text color.</summary>
         [[nodiscard]] auto color() const { return color_; }
 
@@ -55,15 +72,32 @@ namespace rainbow
         /// <summary>Returns font size.</summary>
         [[nodiscard]] auto font_size() const { return font_size_; }
 
+        /// <summary>Returns how glyphs are rendered.</summary>
+        [[nodiscard]] auto glyph_rendering() const { return rendering_; }
+
         /// <summary>Returns label height.</summary>
         [[nodiscard]] auto height() const { return size_.y; }
 
+        /// <summary>
+        ///   Returns whether the label has changed since it was last uploaded.
+        /// </summary>
+        [[nodiscard]] auto is_stale() const { return stale_ != 0; }
+
         /// <summary>Returns the number of characters.</summary>
         [[nodiscard]] auto length() const
         {
             return narrow_cast<uint32_t>(vertices_.size() / 4);
         }
 
+        /// <summary>
+        ///   Returns the glyphs of each atlas page used, in the order they are
+        ///   stored in the vertex buffer.
+        /// </summary>
+        [[nodiscard]] auto pages() const -> const std::vector<PageRange>&
+        {
+            return pages_;
+        }
+
         /// <summary>Returns label position.</summary>
         [[nodiscard]] auto position() const { return position_; }
 
@@ -73,6 +107,9 @@ namespace rainbow
         /// <summary>Returns the string.</summary>
         [[nodiscard]] auto text() const { return text_.c_str(); }
 
+        /// <summary>Returns the client vertex buffer.</summary>
+        [[nodiscard]] auto vertex_buffer() const { return vertices_.data(); }
+
         /// <summary>Returns the vertex array object.</summary>
         [[nodiscard]] auto vertex_array() const -> const graphics::VertexArray&
         {
@@ -107,6 +144,12 @@ namespace rainbow
         /// <summary>Sets font size.</summary>
         auto font_size(int font_size) -> Label&;
 
+        /// <summary>
+        ///   Sets how glyphs are rendered. Distance field glyphs are shared by
+        ///   all font sizes and stay sharp when scaled.
+        /// </summary>
+        auto glyph_rendering(GlyphRendering) -> Label&;
+
         /// <summary>Moves label by (x,y).</summary>
         auto move(Vec2f) -> Label&;
 
@@ -124,19 +167,38 @@ namespace rainbow
         /// <summary>Populates the vertex array.</summary>
         void update(GameBase&);
 
+        /// <summary>
+        ///   Lays out text if needed. Must be called on the main thread.
+        /// </summary>
+        void prepare(GameBase&);
+
+        /// <summary>
+        ///   Updates the client vertex buffer. Does not make any GL calls and
+        ///   may be called from a worker thread.
+        /// </summary>
+        void update_vertices();
+
+        /// <summary>Uploads the client vertex buffer, if needed.</summary>
+        void upload();
+
     protected:
         [[nodiscard]] auto state() const { return stale_; }
-        [[nodiscard]] auto vertex_buffer() const { return vertices_.data(); }
 
         void clear_state() { stale_ = 0; }
 
         /// <summary>Sets label as needing update.</summary>
         void set_needs_update(unsigned int what) { stale_ |= what; }
 
-        void update_internal(GameBase&);
-        void upload() const;
-
     private:
+        /// <summary>A line of text, laid out relative to the label.</summary>
+        struct Line
+        {
+            std::string text;
+            std::vector<SpriteVertex> vertices;
+            std::vector<uint32_t> pages;
+            float width = 0.0F;
+        };
+
         /// <summary>Flags indicating need for update.</summary>
         unsigned int stale_ = 0;
 
@@ -146,6 +208,15 @@ namespace rainbow
         /// <summary>Client vertex buffer.</summary>
         std::vector<SpriteVertex> vertices_;
 
+        /// <summary>Glyphs of each atlas page used.</summary>
+        std::vector<PageRange> pages_;
+
+        /// <summary>
+        ///   Lines of text as they were last laid out. Only lines that change
+        ///   are shaped again.
+        /// </summary>
+        std::vector<Line> lines_;
+
         /// <summary>Content of this label.</summary>
         std::string text_;
 
@@ -158,6 +229,9 @@ namespace rainbow
         /// <summary>Text alignment.</summary>
         TextAlignment alignment_ = TextAlignment::Left;
 
+        /// <summary>How glyphs are rendered.</summary>
+        GlyphRendering rendering_ = GlyphRendering::Bitmap;
+
         /// <summary>Position of the text (bottom left).</summary>
         Vec2f position_;
 
@@ -173,8 +247,13 @@ namespace rainbow
         /// <summary>Label size.</summary>
         Vec2f size_;
 
+        /// <summary>
+        ///   Font cache generation that glyphs were laid out with.
+        /// </summary>
+        uint32_t atlas_generation_ = 0;
+
         /// <summary>Vertex buffer.</summary>
-        graphics::Buffer buffer_;
+        graphics::Buffer buffer_{graphics::Buffer::Usage::Stream};
     };
 }  // namespace rainbow
 
@@ -182,6 +261,12 @@ namespace rainbow::graphics
 {
     struct Context;
 
+    /// <summary>
+    ///   Returns the program that draws glyphs from the glyph atlas,
+    ///   compiling it on first use.
+    /// </summary>
+    auto text_program(Context&) -> unsigned int;
+
     void draw(Context&, const Label&);
 }  // namespace rainbow::graphics
 
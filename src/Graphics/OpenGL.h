@@ -19,6 +19,15 @@
 #   define glBindVertexArray     glBindVertexArrayAPPLE
 #   define glDeleteVertexArrays  glDeleteVertexArraysAPPLE
 #   define glGenVertexArrays     glGenVertexArraysAPPLE
+#   define glBindFramebuffer         glBindFramebufferEXT
+#   define glCheckFramebufferStatus  glCheckFramebufferStatusEXT
+#   define glDeleteFramebuffers      glDeleteFramebuffersEXT
+#   define glFramebufferTexture2D    glFramebufferTexture2DEXT
+#   define glGenFramebuffers         glGenFramebuffersEXT
+#   define GL_COLOR_ATTACHMENT0      GL_COLOR_ATTACHMENT0_EXT
+#   define GL_FRAMEBUFFER            GL_FRAMEBUFFER_EXT
+#   define GL_FRAMEBUFFER_BINDING    GL_FRAMEBUFFER_BINDING_EXT
+#   define GL_FRAMEBUFFER_COMPLETE   GL_FRAMEBUFFER_COMPLETE_EXT
 #elif defined(RAINBOW_OS_WINDOWS)
 #   include <glad/glad.h>
 #else
@@ -56,4 +65,16 @@
 #   define USE_VERTEX_ARRAY_OBJECT 1
 #endif
 
+#if defined(GL_VERSION_3_0) && !defined(GL_ES_VERSION_2_0)
+#   define USE_PIXEL_UNPACK_BUFFER 1
+#endif
+
+#if defined(GL_VERSION_3_2) && !defined(GL_ES_VERSION_2_0)
+#   define USE_STREAMING_BUFFER 1
+#endif
+
+#if defined(GL_VERSION_3_3) && !defined(GL_ES_VERSION_2_0)
+#   define USE_INSTANCED_ARRAYS 1
+#endif
+
 #endif
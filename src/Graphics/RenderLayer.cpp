@@ -0,0 +1,223 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/RenderLayer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+
+#include "Graphics/Drawable.h"
+#include "Graphics/Image.h"
+#include "Graphics/InstancedSpriteBatch.h"
+#include "Graphics/Label.h"
+#include "Graphics/Renderer.h"
+#include "Graphics/SpriteBatch.h"
+
+using rainbow::GameBase;
+using rainbow::IDrawable;
+using rainbow::Image;
+using rainbow::InstancedSpriteBatch;
+using rainbow::Label;
+using rainbow::SpriteBatch;
+using rainbow::SpriteVertex;
+using rainbow::Vec2i;
+using rainbow::graphics::Context;
+using rainbow::graphics::DrawMerger;
+using rainbow::graphics::Filter;
+using rainbow::graphics::RenderLayer;
+using rainbow::graphics::RenderUnit;
+
+namespace
+{
+    /// <summary>
+    ///   Changes that are cleared by the update, and must be looked for
+    ///   before it.
+    /// </summary>
+    struct HasPendingChanges
+    {
+        auto operator()(Label* label) const { return label->is_stale(); }
+
+        template <typename T>
+        auto operator()(T&&) const
+        {
+            return false;
+        }
+    };
+
+    /// <summary>
+    ///   Changes that are found by the update, and must be looked for after
+    ///   it. Animations change sprites, and are covered by their batches.
+    /// </summary>
+    struct HasChanged
+    {
+        auto operator()(IDrawable*) const { return true; }
+
+        auto operator()(InstancedSpriteBatch* batch) const
+        {
+            return batch->is_stale();
+        }
+
+        auto operator()(RenderLayer* layer) const { return layer->is_stale(); }
+
+        auto operator()(SpriteBatch* batch) const { return batch->is_stale(); }
+
+        template <typename T>
+        auto operator()(T&&) const
+        {
+            return false;
+        }
+    };
+
+    template <typename F>
+    auto any_of(const rainbow::graphics::RenderQueue& queue, F&& f)
+    {
+        return std::any_of(
+            queue.begin(), queue.end(), [&f](const RenderUnit& unit) {
+                return unit.is_enabled() && rainbow::visit(f, unit.object());
+            });
+    }
+
+    /// <summary>Returns the size of the viewport, in pixels.</summary>
+    auto viewport_size(const Context& ctx)
+    {
+        return Vec2i{
+            static_cast<int>(std::ceil(ctx.surface_size.x * ctx.zoom)),
+            static_cast<int>(std::ceil(ctx.surface_size.y * ctx.zoom))};
+    }
+}  // namespace
+
+RenderLayer::RenderLayer() = default;
+
+RenderLayer::~RenderLayer()
+{
+    if (framebuffer_ != 0)
+        glDeleteFramebuffers(1, &framebuffer_);
+}
+
+void RenderLayer::update(GameBase& ctx, uint64_t dt)
+{
+    if (queue_.size() != unit_count_)
+    {
+        unit_count_ = queue_.size();
+        stale_ = true;
+    }
+
+    stale_ = stale_ || any_of(queue_, HasPendingChanges{});
+    graphics::update(ctx, queue_, dt);
+    stale_ = stale_ || any_of(queue_, HasChanged{});
+}
+
+void RenderLayer::redraw(Context& ctx, const Vec2i& size)
+{
+    if (size != size_ || !texture_)
+    {
+        std::array<char, 48> key;
+        std::snprintf(key.data(),
+                      key.size(),
+                      "rainbow://render-layer/%p",
+                      static_cast<void*>(this));
+
+        // Texture contents are undefined until drawn into.
+        const Image image{Image::Format::RGBA,
+                          static_cast<uint32_t>(size.x),
+                          static_cast<uint32_t>(size.y),
+                          32,
+                          4,
+                          size_t{4} * size.x * size.y};
+        texture_ = {};
+        texture_ = ctx.texture_provider.get(
+            key.data(), image, Filter::Linear, Filter::Linear);
+        size_ = size;
+
+        if (framebuffer_ == 0)
+            glGenFramebuffers(1, &framebuffer_);
+
+        const auto name = ctx.texture_provider.raw_get(texture_).data[0];
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+        glFramebufferTexture2D(GL_FRAMEBUFFER,
+                               GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D,
+                               static_cast<GLuint>(name),
+                               0);
+
+        R_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) ==
+                     GL_FRAMEBUFFER_COMPLETE,
+                 "Failed to create render layer");
+    }
+
+    // The default framebuffer is not necessarily 0, e.g. on iOS.
+    GLint framebuffer;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    std::array<GLint, 4> viewport;
+    glGetIntegerv(GL_VIEWPORT, viewport.data());
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, size.x, size.y);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    auto& state = ctx.state_cache;
+    state.blend_func_separate(
+        GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    // The outer queue is still being drawn with the context's merger, which
+    // must be left untouched.
+    if (ctx.draw_merger != nullptr && draw_merger_ == nullptr)
+        draw_merger_ = std::make_unique<DrawMerger>();
+    std::swap(ctx.draw_merger, draw_merger_);
+    graphics::draw(ctx, queue_);
+    std::swap(ctx.draw_merger, draw_merger_);
+
+    state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    ++redraw_count_;
+}
+
+void rainbow::graphics::draw(Context& ctx, RenderLayer& layer)
+{
+    const auto size = viewport_size(ctx);
+    if (size.x <= 0 || size.y <= 0)
+        return;
+
+    if (layer.stale_ || ctx.projection != layer.projection_ ||
+        size != layer.size_)
+    {
+        layer.redraw(ctx, size);
+        layer.stale_ = false;
+    }
+
+    if (!layer.buffer_.has_value())
+    {
+        layer.buffer_.emplace();
+        layer.array_.reconfigure([&layer] { layer.buffer_->bind(); });
+    }
+
+    if (ctx.projection != layer.projection_)
+    {
+        const auto& rect = ctx.projection;
+        layer.projection_ = rect;
+
+        // Texture rows start at the bottom of the viewport.
+        std::array<SpriteVertex, 4> quad;
+        quad[0].texcoord = {0.0F, 0.0F};
+        quad[0].position = rect.bottom_left();
+        quad[1].texcoord = {1.0F, 0.0F};
+        quad[1].position = rect.bottom_right();
+        quad[2].texcoord = {1.0F, 1.0F};
+        quad[2].position = rect.top_right();
+        quad[3].texcoord = {0.0F, 1.0F};
+        quad[3].position = rect.top_left();
+        layer.buffer_->upload(quad.data(), sizeof(quad));
+    }
+
+    bind(ctx, layer.texture_);
+
+    // Colours are already multiplied with alpha.
+    ctx.state_cache.blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    draw(layer.array_, *layer.buffer_, 6);
+    ctx.state_cache.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
@@ -0,0 +1,110 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_RENDERLAYER_H_
+#define GRAPHICS_RENDERLAYER_H_
+
+#include <memory>
+#include <optional>
+
+#include "Common/NonCopyable.h"
+#include "Graphics/Buffer.h"
+#include "Graphics/RenderQueue.h"
+#include "Graphics/Texture.h"
+#include "Graphics/VertexArray.h"
+#include "Math/Geometry.h"
+#include "Math/Vec2.h"
+
+namespace rainbow::graphics
+{
+    class DrawMerger;
+
+    /// <summary>
+    ///   Render unit that draws a queue of its own into a texture once, and
+    ///   then only draws the texture until any of its units change.
+    /// </summary>
+    /// <remarks>
+    ///   <para>
+    ///     Units are drawn into the texture again when a label or sprite was
+    ///     marked stale during update, or when the projection or viewport
+    ///     size changes. Drawables cannot tell whether they changed and are
+    ///     assumed to change every frame. Anything else that affects how
+    ///     units are drawn, e.g. disabling units, hiding a batch or changing
+    ///     its texture, requires a call to <see cref="invalidate"/>.
+    ///   </para>
+    ///   <para>
+    ///     Colours are stored with premultiplied alpha so that translucent
+    ///     units blend as if they were drawn directly.
+    ///   </para>
+    /// </remarks>
+    class RenderLayer : private NonCopyable<RenderLayer>
+    {
+    public:
+        RenderLayer();
+        ~RenderLayer();
+
+        /// <summary>
+        ///   Returns whether units will be drawn into the texture the next
+        ///   time the layer is drawn.
+        /// </summary>
+        [[nodiscard]] auto is_stale() const { return stale_; }
+
+        /// <summary>Returns the units drawn into this layer.</summary>
+        [[nodiscard]] auto queue() -> RenderQueue& { return queue_; }
+        [[nodiscard]] auto queue() const -> const RenderQueue&
+        {
+            return queue_;
+        }
+
+        /// <summary>
+        ///   Returns the number of times units were drawn into the texture.
+        /// </summary>
+        [[nodiscard]] auto redraw_count() const { return redraw_count_; }
+
+        /// <summary>
+        ///   Returns the texture units are drawn into. It is only valid after
+        ///   the layer was first drawn.
+        /// </summary>
+        [[nodiscard]] auto texture() const -> const Texture&
+        {
+            return texture_;
+        }
+
+        /// <summary>
+        ///   Marks the layer stale, forcing units to be drawn into the texture
+        ///   the next time it is drawn.
+        /// </summary>
+        void invalidate() { stale_ = true; }
+
+        /// <summary>
+        ///   Updates all enabled units, and marks the layer stale if any of
+        ///   them changed.
+        /// </summary>
+        void update(GameBase&, uint64_t dt);
+
+    private:
+        RenderQueue queue_;
+        Texture texture_;
+        std::unique_ptr<DrawMerger> draw_merger_;
+        std::optional<Buffer> buffer_;
+        VertexArray array_;
+        unsigned int framebuffer_ = 0;
+        Rect projection_;
+        Vec2i size_;
+        size_t unit_count_ = 0;
+        uint32_t redraw_count_ = 0;
+        bool stale_ = true;
+
+        /// <summary>
+        ///   Draws all units into a texture of <paramref name="size"/> pixels.
+        /// </summary>
+        void redraw(Context&, const Vec2i& size);
+
+        friend void draw(Context&, RenderLayer&);
+    };
+
+    void draw(Context&, RenderLayer&);
+}  // namespace rainbow::graphics
+
+#endif
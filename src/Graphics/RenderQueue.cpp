@@ -4,18 +4,31 @@
 
 #include "Graphics/RenderQueue.h"
 
+#include <algorithm>
+#include <functional>
+
 #include "Graphics/Animation.h"
+#include "Graphics/DrawMerger.h"
 #include "Graphics/Drawable.h"
+#include "Graphics/InstancedSpriteBatch.h"
 #include "Graphics/Label.h"
+#include "Graphics/RenderLayer.h"
+#include "Graphics/Renderer.h"
 #include "Graphics/SpriteBatch.h"
+#include "Script/GameBase.h"
+#include "Text/FontCache.h"
 
 using rainbow::Animation;
 using rainbow::GameBase;
 using rainbow::IDrawable;
+using rainbow::InstancedSpriteBatch;
 using rainbow::Label;
 using rainbow::SpriteBatch;
 using rainbow::graphics::Context;
+using rainbow::graphics::RenderLayer;
 using rainbow::graphics::RenderQueue;
+using rainbow::graphics::RenderUnit;
+using rainbow::graphics::Texture;
 
 namespace
 {
@@ -34,6 +47,10 @@ namespace
         }
     };
 
+    /// <summary>
+    ///   Updates that must run on the main thread, e.g. because they may call
+    ///   into scripts or use the font cache.
+    /// </summary>
     struct UpdateCommand
     {
         GameBase& context;  // NOLINT
@@ -41,24 +58,244 @@ namespace
 
         void operator()(Animation* animation) const { animation->update(dt); }
 
-        void operator()(Label* label) const { label->update(context); }
+        void operator()(IDrawable* drawable) const
+        {
+            drawable->update(context, dt);
+        }
+
+        void operator()(InstancedSpriteBatch*) const {}
+
+        void operator()(Label* label) const { label->prepare(context); }
+
+        void operator()(RenderLayer* layer) const
+        {
+            layer->update(context, dt);
+        }
+
+        void operator()(SpriteBatch*) const {}
+    };
+
+    /// <summary>Updates that may run on any thread.</summary>
+    struct UpdateVerticesCommand
+    {
+        GameBase& context;  // NOLINT
+
+        void operator()(InstancedSpriteBatch* batch) const
+        {
+            batch->update_vertices(context);
+        }
 
-        void operator()(SpriteBatch* batch) const { batch->update(context); }
+        void operator()(Label* label) const { label->update_vertices(); }
+
+        void operator()(SpriteBatch* batch) const
+        {
+            batch->update_vertices(context);
+        }
 
         template <typename T>
-        void operator()(T&& unit) const
+        void operator()(T&&) const
+        {
+        }
+    };
+
+    /// <summary>Programs, in the order they are sorted.</summary>
+    enum class ProgramKey : uint64_t
+    {
+        Default,
+        DistanceField,
+        Instanced,
+        NormalMapped,
+        Text,
+        Unknown = 0xff,
+    };
+
+    auto texture_key(const Texture* texture) -> uint64_t
+    {
+        if (texture == nullptr)
+            return 0;
+
+        // Textures packed into the same atlas page must sort together.
+        return std::hash<std::string_view>{}(texture->storage_key()) &
+               0xffffffffU;
+    }
+
+    auto make_key(const RenderUnit& unit, ProgramKey program, uint64_t texture)
+    {
+        return (uint64_t{unit.layer()} << 48) |
+               (static_cast<uint64_t>(program) << 40) | (texture << 8) |
+               unit.depth();
+    }
+
+    struct SortKeyCommand
+    {
+        const RenderUnit& unit;  // NOLINT
+
+        auto operator()(Animation*) const
+        {
+            return make_key(unit, ProgramKey::Default, 0);
+        }
+
+        auto operator()(IDrawable*) const
+        {
+            // Drawables may change any state; keep them after the others.
+            return make_key(unit, ProgramKey::Unknown, 0);
+        }
+
+        auto operator()(InstancedSpriteBatch* batch) const
+        {
+            return make_key(unit,
+                            batch->is_instanced() ? ProgramKey::Instanced
+                                                  : ProgramKey::Default,
+                            texture_key(batch->texture()));
+        }
+
+        auto operator()(Label* label) const
+        {
+            auto font_cache = rainbow::FontCache::Get();
+            const auto& pages = label->pages();
+            const auto texture =
+                font_cache == nullptr
+                    ? nullptr
+                    : &font_cache->texture(pages.empty() ? 0
+                                                         : pages.front().page);
+            return make_key(unit,
+                            label->glyph_rendering() ==
+                                    rainbow::GlyphRendering::DistanceField
+                                ? ProgramKey::DistanceField
+                                : ProgramKey::Text,
+                            texture_key(texture));
+        }
+
+        auto operator()(RenderLayer* layer) const
+        {
+            return make_key(
+                unit, ProgramKey::Default, texture_key(&layer->texture()));
+        }
+
+        auto operator()(SpriteBatch* batch) const
+        {
+            return make_key(unit,
+                            batch->normal() != nullptr
+                                ? ProgramKey::NormalMapped
+                                : ProgramKey::Default,
+                            texture_key(batch->texture()));
+        }
+    };
+
+    struct UploadCommand
+    {
+        void operator()(InstancedSpriteBatch* batch) const { batch->upload(); }
+
+        void operator()(Label* label) const { label->upload(); }
+
+        void operator()(SpriteBatch* batch) const { batch->upload(); }
+
+        template <typename T>
+        void operator()(T&&) const
         {
-            unit->update(context, dt);
         }
     };
 }  // namespace
 
+auto RenderQueue::sort() -> bool
+{
+    const auto count = size();
+    keys_.resize(count);
+
+    bool is_ordered = true;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto& unit = (*this)[i];
+        const auto key = visit(SortKeyCommand{unit}, unit.object());
+        unit.set_sort_key(key);
+        keys_[i] = {key, static_cast<uint32_t>(i)};
+        is_ordered = is_ordered && (i == 0 || keys_[i - 1].first <= key);
+    }
+
+    if (is_ordered)
+        return false;
+
+    // Stable least-significant-digit radix sort, one byte at a time. Passes
+    // where all keys share the same digit are skipped; in practice, most of
+    // the key is constant.
+    scratch_.resize(count);
+    for (uint32_t shift = 0; shift < 64; shift += 8)
+    {
+        size_t offsets[256]{};
+        for (auto&& [key, index] : keys_)
+            ++offsets[(key >> shift) & 0xff];
+
+        if (offsets[(keys_.front().first >> shift) & 0xff] == count)
+            continue;
+
+        size_t total = 0;
+        for (auto&& offset : offsets)
+        {
+            const auto n = offset;
+            offset = total;
+            total += n;
+        }
+
+        for (auto&& key_index : keys_)
+            scratch_[offsets[(key_index.first >> shift) & 0xff]++] = key_index;
+
+        std::swap(keys_, scratch_);
+    }
+
+    std::vector<RenderUnit> sorted;
+    sorted.reserve(count);
+    for (auto&& key_index : keys_)
+        sorted.push_back(std::move((*this)[key_index.second]));
+    static_cast<std::vector<RenderUnit>&>(*this) = std::move(sorted);
+    return true;
+}
+
 void rainbow::graphics::draw(Context& ctx, RenderQueue& queue)
 {
-    visit_all(DrawCommand{ctx}, queue);
+    if (queue.is_sorted())
+        queue.sort();
+
+    if (ctx.draw_merger == nullptr)
+    {
+        visit_all(DrawCommand{ctx}, queue);
+        return;
+    }
+
+    auto& merger = *ctx.draw_merger;
+    merger.compile(queue);
+
+    const auto& runs = merger.runs();
+    auto run = runs.begin();
+    for (size_t i = 0; i < queue.size();)
+    {
+        if (run != runs.end() && run->first == i)
+        {
+            merger.draw(ctx, queue, *run);
+            i = run->last;
+            ++run;
+            continue;
+        }
+
+        const auto& unit = queue[i++];
+        if (!unit.is_enabled())
+            continue;
+
+        visit(DrawCommand{ctx}, unit.object());
+    }
 }
 
 void rainbow::graphics::update(GameBase& ctx, RenderQueue& queue, uint64_t dt)
 {
     visit_all(UpdateCommand{ctx, dt}, queue);
+
+    ctx.job_pool().parallel_for(
+        narrow_cast<uint32_t>(queue.size()), [&ctx, &queue](uint32_t i) {
+            const auto& unit = queue[i];
+            if (!unit.is_enabled())
+                return;
+
+            visit(UpdateVerticesCommand{ctx}, unit.object());
+        });
+
+    visit_all(UploadCommand{}, queue);
 }
@@ -5,8 +5,10 @@
 #ifndef GRAPHICS_RENDERQUEUE_H_
 #define GRAPHICS_RENDERQUEUE_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/String.h"
@@ -17,6 +19,7 @@ namespace rainbow
     class Animation;
     class GameBase;
     class IDrawable;
+    class InstancedSpriteBatch;
     class Label;
     class SpriteBatch;
 }  // namespace rainbow
@@ -24,6 +27,7 @@ namespace rainbow
 namespace rainbow::graphics
 {
     struct Context;
+    class RenderLayer;
 
     class RenderUnit
     {
@@ -31,7 +35,9 @@ namespace rainbow::graphics
         using variant_type = variant<  //
             Animation*,
             IDrawable*,
+            InstancedSpriteBatch*,
             Label*,
+            RenderLayer*,
             SpriteBatch*>;
 
         template <typename T>
@@ -52,15 +58,32 @@ namespace rainbow::graphics
         {
         }
 
+        /// <summary>
+        ///   Returns the depth of this unit within its layer and texture.
+        /// </summary>
+        [[nodiscard]] auto depth() const { return depth_; }
+
         [[nodiscard]] auto is_enabled() const { return enabled_; }
 
+        /// <summary>Returns the layer this unit is drawn in.</summary>
+        [[nodiscard]] auto layer() const { return layer_; }
+
         [[nodiscard]] auto object() const -> const variant_type&
         {
             return variant_;
         }
 
+        /// <summary>
+        ///   Returns the key this unit was last sorted by. Only valid in
+        ///   sorted mode.
+        /// </summary>
+        [[nodiscard]] auto sort_key() const { return sort_key_; }
+
         [[nodiscard]] auto tag() const -> std::string_view { return tag_; }
 
+        void set_depth(uint8_t depth) { depth_ = depth; }
+        void set_layer(uint16_t layer) { layer_ = layer; }
+        void set_sort_key(uint64_t key) { sort_key_ = key; }
         void set_tag(std::string_view tag) { tag_ = tag; }
 
         void disable() { enabled_ = false; }
@@ -88,14 +111,63 @@ namespace rainbow::graphics
 
     private:
         bool enabled_ = true;
+        uint8_t depth_ = 0;
+        uint16_t layer_ = 0;
+        uint64_t sort_key_ = 0;
         variant_type variant_;
         std::string tag_;
     };
 
-    using RenderQueue = std::vector<RenderUnit>;
+    /// <summary>Ordered list of units to update and draw.</summary>
+    /// <remarks>
+    ///   <para>
+    ///     By default, units are drawn strictly in the order they appear in
+    ///     the queue. In sorted mode, the queue is reordered before drawing by
+    ///     a 64-bit key made of layer, program, texture and depth, in that
+    ///     order of significance. Units on the same layer may then be drawn in
+    ///     any order that minimises program and texture switches; units that
+    ///     must be drawn in a particular order should be put in different
+    ///     layers.
+    ///   </para>
+    ///   <para>
+    ///     Sorting is stable and only performed when keys are out of order,
+    ///     e.g. after units are added or change texture.
+    ///   </para>
+    /// </remarks>
+    class RenderQueue : public std::vector<RenderUnit>
+    {
+    public:
+        using vector::vector;
+
+        /// <summary>Returns whether units are sorted before drawing.</summary>
+        [[nodiscard]] auto is_sorted() const { return sorted_; }
+
+        /// <summary>Sets whether units are sorted before drawing.</summary>
+        void set_sorted(bool sorted) { sorted_ = sorted; }
+
+        /// <summary>
+        ///   Recomputes sort keys and reorders units if necessary.
+        /// </summary>
+        /// <returns><c>true</c> if units were reordered.</returns>
+        auto sort() -> bool;
+
+    private:
+        using KeyIndex = std::pair<uint64_t, uint32_t>;
+
+        bool sorted_ = false;
+        std::vector<KeyIndex> keys_;
+        std::vector<KeyIndex> scratch_;
+    };
 
     void draw(Context&, RenderQueue&);
 
+    /// <summary>Updates all enabled units in the render queue.</summary>
+    /// <remarks>
+    ///   Animations, drawables and text layout are updated first, in queue
+    ///   order, on the calling thread. Vertices are then generated in parallel
+    ///   on the game's job pool, and finally uploaded on the calling thread. A
+    ///   unit must therefore not appear more than once in the queue.
+    /// </remarks>
     void update(GameBase&, RenderQueue&, uint64_t dt);
 
     template <typename F>
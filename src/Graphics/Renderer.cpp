@@ -4,6 +4,7 @@
 
 #include "Graphics/Renderer.h"
 
+#include <cstdio>
 #include <string_view>
 
 #include "Common/Error.h"
@@ -20,7 +21,8 @@ namespace graphics = rainbow::graphics;
 
 namespace
 {
-    unsigned int g_draw_count = 0;
+    size_t g_bytes_uploaded = 0;
+    graphics::DrawCount g_draw_count{};
     Context* g_context = nullptr;
 
     auto gl_get_string(GLenum name)
@@ -33,11 +35,18 @@ namespace
 #ifndef NDEBUG
 namespace rainbow::graphics::detail
 {
+    size_t g_bytes_uploaded_accumulator = 0;
     unsigned int g_draw_count_accumulator = 0;
+    unsigned int g_merged_draw_count_accumulator = 0;
 }  // namespace rainbow::graphics::detail
 #endif  // NDEBUG
 
-auto graphics::draw_count() -> unsigned int
+auto graphics::bytes_uploaded() -> size_t
+{
+    return g_bytes_uploaded;
+}
+
+auto graphics::draw_count() -> DrawCount
 {
     return g_draw_count;
 }
@@ -47,6 +56,41 @@ auto graphics::gl_version() -> czstring
     return gl_get_string(GL_VERSION);
 }
 
+auto graphics::has_extension(std::string_view extension) -> bool
+{
+    static const std::string_view extensions = gl_get_string(GL_EXTENSIONS);
+    for (auto pos = extensions.find(extension);
+         pos != std::string_view::npos;
+         pos = extensions.find(extension, pos + 1))
+    {
+        // Make sure we don't match a prefix of another extension.
+        const auto end = pos + extension.length();
+        if ((pos == 0 || extensions[pos - 1] == ' ') &&
+            (end == extensions.length() || extensions[end] == ' '))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto graphics::has_gl_version(int major, int minor) -> bool
+{
+    static const auto version = [] {
+        std::string_view version_string = gl_get_string(GL_VERSION);
+        constexpr auto kOpenGLES = "OpenGL ES "sv;
+        if (version_string.substr(0, kOpenGLES.length()) == kOpenGLES)
+            version_string.remove_prefix(kOpenGLES.length());
+
+        int major = 0;
+        int minor = 0;
+        if (std::sscanf(version_string.data(), "%d.%d", &major, &minor) != 2)
+            return 0;
+        return major * 100 + minor;
+    }();
+    return version >= major * 100 + minor;
+}
+
 auto graphics::max_texture_size() -> int
 {
     static const int max_texture_size = [] {
@@ -147,13 +191,62 @@ void graphics::bind_element_array()
     g_context->element_buffer.bind();
 }
 
+auto graphics::state_cache() -> StateCache&
+{
+    return g_context->state_cache;
+}
+
+void graphics::delete_buffer(unsigned int buffer)
+{
+    // Objects may outlive the context, e.g. when they are static.
+    if (g_context == nullptr)
+    {
+        glDeleteBuffers(1, &buffer);
+        return;
+    }
+
+    g_context->state_cache.delete_buffer(buffer);
+}
+
+void graphics::delete_vertex_array([[maybe_unused]] unsigned int array)
+{
+#ifdef USE_VERTEX_ARRAY_OBJECT
+    if (g_context == nullptr)
+    {
+        glDeleteVertexArrays(1, &array);
+        return;
+    }
+
+    g_context->state_cache.delete_vertex_array(array);
+#endif
+}
+
+auto graphics::element_buffer() -> ElementBuffer&
+{
+    return g_context->element_buffer;
+}
+
+auto graphics::streaming_buffer() -> StreamingBuffer*
+{
+    return g_context == nullptr || !g_context->streaming_buffer.is_enabled()
+               ? nullptr
+               : &g_context->streaming_buffer;
+}
+
 void graphics::clear()
 {
     glClear(GL_COLOR_BUFFER_BIT);
 
+    g_context->state_cache.next_frame();
+
 #ifndef NDEBUG
-    g_draw_count = detail::g_draw_count_accumulator;
+    g_bytes_uploaded = detail::g_bytes_uploaded_accumulator;
+    detail::g_bytes_uploaded_accumulator = 0;
+    g_draw_count.issued = detail::g_draw_count_accumulator;
+    g_draw_count.requested = detail::g_draw_count_accumulator +
+                             detail::g_merged_draw_count_accumulator;
     detail::g_draw_count_accumulator = 0;
+    detail::g_merged_draw_count_accumulator = 0;
 #endif
 }
 
@@ -177,29 +270,42 @@ auto graphics::convert_to_view(const Context& ctx, const Vec2i& p) -> Vec2i
 }
 
 #ifndef NDEBUG
+void graphics::increment_bytes_uploaded(size_t size)
+{
+    detail::g_bytes_uploaded_accumulator += size;
+}
+
 void graphics::increment_draw_count()
 {
     ++detail::g_draw_count_accumulator;
 }
+
+void graphics::increment_merged_draw_count(unsigned int count)
+{
+    detail::g_merged_draw_count_accumulator += count;
+}
 #endif  // NDEBUG
 
 void graphics::reset()
 {
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_SCISSOR_TEST);
+    auto& state = g_context->state_cache;
+    state.invalidate();
+
+    state.disable(GL_CULL_FACE);
+    state.disable(GL_DEPTH_TEST);
+    state.disable(GL_SCISSOR_TEST);
 
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_BLEND);
+    state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state.enable(GL_BLEND);
 
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
-    glActiveTexture(GL_TEXTURE0);
+    state.active_texture(0);
 }
 
-void graphics::scissor(const Context& ctx, int x, int y, int width, int height)
+void graphics::scissor(Context& ctx, int x, int y, int width, int height)
 {
-    glScissor(ctx.origin.x + x, ctx.origin.y + y, width, height);
+    ctx.state_cache.scissor(ctx.origin.x + x, ctx.origin.y + y, width, height);
 }
 
 Context::~Context()
@@ -217,36 +323,25 @@ auto Context::initialize() -> std::error_code
         return ErrorCode::GLInitializationFailed;
 #endif
 
+    // Resources created below bind through the state cache of this context.
+    g_context = this;
+
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state_cache.enable(GL_BLEND);
+    state_cache.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     if (!shader_manager.init())
         return ErrorCode::ShaderManagerInitializationFailed;
 
-    constexpr size_t kElementBufferSize = kMaxSprites * 6;
-    auto default_indices = std::make_unique<uint16_t[]>(kElementBufferSize);
-    for (size_t i = 0; i < kMaxSprites; ++i)
-    {
-        const auto index = i * 6;
-        const auto vertex = static_cast<uint16_t>(i * 4);
-        default_indices[index] = vertex;
-        default_indices[index + 1] = vertex + 1;
-        default_indices[index + 2] = vertex + 2;
-        default_indices[index + 3] = vertex + 2;
-        default_indices[index + 4] = vertex + 3;
-        default_indices[index + 5] = vertex;
-    }
-
-    unsigned int buffer;
-    glGenBuffers(1, &buffer);
-    element_buffer = buffer;
-    element_buffer.upload(default_indices.get(), kElementBufferSize);
+    streaming_buffer.initialize();
+    element_buffer.initialize();
+    texture_allocator.initialize();
+    texture_provider.set_texture_variants(gl::compressed_texture_variants());
 
     if (glGetError() != GL_NO_ERROR)
         return ErrorCode::RenderInitializationFailed;
 
-    g_context = this;
+    draw_merger = std::make_unique<DrawMerger>();
     return ErrorCode::Success;
 }
@@ -5,10 +5,15 @@
 #ifndef GRAPHICS_RENDERER_H_
 #define GRAPHICS_RENDERER_H_
 
+#include <memory>
+#include <string_view>
 #include <system_error>
 
+#include "Graphics/DrawMerger.h"
 #include "Graphics/ElementBuffer.h"
 #include "Graphics/ShaderManager.h"
+#include "Graphics/StateCache.h"
+#include "Graphics/StreamingBuffer.h"
 #include "Graphics/Texture.h"
 #include "Graphics/TextureAllocator.gl.h"
 #include "Graphics/VertexArray.h"
@@ -16,9 +21,6 @@
 
 namespace rainbow::graphics
 {
-    /// <summary>Hard-coded limit on number of sprites.</summary>
-    static constexpr size_t kMaxSprites = 4096;
-
     struct Context
     {
         float scale = 1.0F;
@@ -27,24 +29,47 @@ namespace rainbow::graphics
         Vec2i surface_size;
         Vec2i window_size;
         Rect projection;
+        StateCache state_cache;
         ElementBuffer element_buffer;
-        gl::TextureAllocator texture_allocator;
+        StreamingBuffer streaming_buffer;
+        gl::TextureAllocator texture_allocator{state_cache};
         TextureProvider texture_provider{texture_allocator};
         ShaderManager shader_manager{*this, Passkey<Context>{}};
+        std::unique_ptr<DrawMerger> draw_merger;
+        unsigned int sprite_instancing_program = ShaderManager::kInvalidProgram;
+        unsigned int text_program = ShaderManager::kInvalidProgram;
+        unsigned int distance_field_program = ShaderManager::kInvalidProgram;
+        int distance_field_smoothing = -1;
 
         ~Context();
 
         auto initialize() -> std::error_code;
     };
 
+    struct DrawCount
+    {
+        /// <summary>Number of draw calls issued.</summary>
+        unsigned int issued;
+
+        /// <summary>Number of draw calls before merging.</summary>
+        unsigned int requested;
+    };
+
     struct MemoryInfo
     {
         int current_available;
         int total_available;
     };
 
-    auto draw_count() -> unsigned int;
+    /// <summary>Returns the number of bytes uploaded last frame.</summary>
+    auto bytes_uploaded() -> size_t;
+
+    /// <summary>Returns the number of draw calls made last frame.</summary>
+    auto draw_count() -> DrawCount;
+
     auto gl_version() -> czstring;
+    auto has_extension(std::string_view extension) -> bool;
+    auto has_gl_version(int major, int minor) -> bool;
     auto max_texture_size() -> int;
     auto memory_info() -> MemoryInfo;
     auto renderer() -> czstring;
@@ -56,14 +81,44 @@ namespace rainbow::graphics
 
     void bind_element_array();
 
+    /// <summary>Returns the GL state cache of the current context.</summary>
+    auto state_cache() -> StateCache&;
+
+    /// <summary>
+    ///   Deletes a buffer object, keeping the state cache of the current
+    ///   context, if any, in sync.
+    /// </summary>
+    void delete_buffer(unsigned int buffer);
+
+    /// <summary>
+    ///   Deletes a vertex array object, keeping the state cache of the current
+    ///   context, if any, in sync.
+    /// </summary>
+    void delete_vertex_array(unsigned int array);
+
+    /// <summary>Returns the element buffer of the current context.</summary>
+    auto element_buffer() -> ElementBuffer&;
+
+    /// <summary>
+    ///   Returns the streaming buffer of the current context, if enabled.
+    /// </summary>
+    auto streaming_buffer() -> StreamingBuffer*;
+
     void clear();
 
     auto convert_to_flipped_view(const Context&, const Vec2i&) -> Vec2i;
     auto convert_to_screen(const Context&, const Vec2i&) -> Vec2i;
     auto convert_to_view(const Context&, const Vec2i&) -> Vec2i;
 
+    void increment_bytes_uploaded(size_t size);
     void increment_draw_count();
 
+    /// <summary>
+    ///   Records that <paramref name="count"/> draw calls were saved by
+    ///   merging.
+    /// </summary>
+    void increment_merged_draw_count(unsigned int count);
+
     template <typename T>
     void draw_arrays(const T& obj, int first, size_t count)
     {
@@ -73,7 +128,7 @@ namespace rainbow::graphics
 
     void reset();
 
-    void scissor(const Context&, int x, int y, int width, int height);
+    void scissor(Context&, int x, int y, int width, int height);
 
     class ScopedProjection
     {
@@ -94,8 +149,8 @@ namespace rainbow::graphics
     template <int GL_STATE>
     struct ScopedState
     {
-        ScopedState() { glEnable(GL_STATE); }
-        ~ScopedState() { glDisable(GL_STATE); }
+        ScopedState() { state_cache().enable(GL_STATE); }
+        ~ScopedState() { state_cache().disable(GL_STATE); }
     };
 
     using ScopedCullFace = ScopedState<GL_CULL_FACE>;
@@ -16,6 +16,8 @@ namespace Shader
         kAttributeColor,
         kAttributeTexCoord,
         kAttributeNormal,
+        kAttributeTranslation,
+        kAttributeQuad,
         kAttributeNone
     };
 
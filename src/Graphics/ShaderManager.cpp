@@ -131,7 +131,10 @@ namespace
 ShaderManager::~ShaderManager()
 {
     for (const auto& details : programs_)
+    {
+        context_->state_cache.forget_program(details.program);
         glDeleteProgram(details.program);
+    }
     for (const auto shader : shaders_)
         glDeleteShader(shader);
 }
@@ -216,7 +219,7 @@ void ShaderManager::update_viewport()
     {
         current_ = kDefaultProgram;
         const Shader::Details& details = get_program();
-        glUseProgram(details.program);
+        context_->state_cache.use_program(details.program);
         update_projection();
         glUniform1i(glGetUniformLocation(details.program, "texture"), 0);
         return;
@@ -237,7 +240,7 @@ void ShaderManager::use(unsigned int program)
             return;
 
         const Shader::Details& details = get_program();
-        glUseProgram(details.program);
+        context_->state_cache.use_program(details.program);
 
         update_projection();
 
@@ -58,6 +58,18 @@ namespace
                          "* attenuation;\n"
         "}\n";
 
+    constexpr char kDistanceField_frag[] =
+        "uniform float smoothing;\n"
+        "uniform sampler2D texture;\n"
+        "varying lowp vec4 v_color;\n"
+        "varying vec2 v_texcoord;\n"
+        "void main()\n"
+        "{\n"
+            "float distance = texture2D(texture, v_texcoord).a;\n"
+            "float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);\n"
+            "gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);\n"
+        "}\n";
+
     constexpr char kFixed2D_frag[] =
         "uniform sampler2D texture;\n"
         "varying lowp vec4 v_color;\n"
@@ -93,6 +105,28 @@ namespace
         "precision mediump float;\n"
         "#endif\n";
 
+    constexpr char kInstanced2D_vert[] =
+        "uniform mat4 mvp_matrix;\n"
+        "attribute vec2 corner;\n"
+        "attribute vec4 color;\n"
+        "attribute vec4 texcoord;\n"
+        "attribute vec3 translation;\n"
+        "attribute vec4 quad;\n"
+        "varying lowp vec4 v_color;\n"
+        "varying vec2 v_texcoord;\n"
+        "void main()\n"
+        "{\n"
+            "vec2 p = quad.xy + corner * quad.zw;\n"
+            "float s = sin(-translation.z);\n"
+            "float c = cos(-translation.z);\n"
+            "v_color = color;\n"
+            "v_texcoord = mix(texcoord.xy, texcoord.zw, corner);\n"
+            "gl_Position = mvp_matrix * vec4(c * p.x - s * p.y + translation.x,\n"
+                                            "s * p.x + c * p.y + translation.y,\n"
+                                            "0.0,\n"
+                                            "1.0);\n"
+        "}\n";
+
     constexpr char kNormalMapped_vert[] =
         "uniform mat4 mvp_matrix;\n"
         "attribute vec4 color;\n"
@@ -127,6 +161,16 @@ namespace
             "v_color = color;\n"
             "gl_Position = mvp_matrix * vec4(vertex, 0.0, 1.0);\n"
         "}\n";
+
+    constexpr char kText_frag[] =
+        "uniform sampler2D texture;\n"
+        "varying lowp vec4 v_color;\n"
+        "varying vec2 v_texcoord;\n"
+        "void main()\n"
+        "{\n"
+            "float alpha = texture2D(texture, v_texcoord).a;\n"
+            "gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);\n"
+        "}\n";
 }  // namespace
 
 auto gl::DiffuseLight2D_frag() -> Shader::Params
@@ -139,6 +183,11 @@ auto gl::DiffuseLightNormal_frag() -> Shader::Params
     return {Shader::kTypeFragment, 0, "Shaders/DiffuseLightNormal.frag", kDiffuseLightNormal_frag};
 }
 
+auto gl::DistanceField_frag() -> Shader::Params
+{
+    return {Shader::kTypeFragment, 0, "Shaders/DistanceField.frag", kDistanceField_frag};
+}
+
 auto gl::Fixed2D_frag() -> Shader::Params
 {
     return {Shader::kTypeFragment, 0, "Shaders/Fixed2D.frag", kFixed2D_frag};
@@ -159,6 +208,11 @@ auto gl::GLES2_header_glsl() -> rainbow::czstring
     return kGLES2_header_glsl;
 }
 
+auto gl::Instanced2D_vert() -> Shader::Params
+{
+    return {Shader::kTypeVertex, 0, "Shaders/Instanced2D.vert", kInstanced2D_vert};
+}
+
 auto gl::NormalMapped_vert() -> Shader::Params
 {
     return {Shader::kTypeVertex, 0, "Shaders/NormalMapped.vert", kNormalMapped_vert};
@@ -174,4 +228,9 @@ auto gl::Simple2D_vert() -> Shader::Params
     return {Shader::kTypeVertex, 0, "Shaders/Simple2D.vert", kSimple2D_vert};
 }
 
+auto gl::Text_frag() -> Shader::Params
+{
+    return {Shader::kTypeFragment, 0, "Shaders/Text.frag", kText_frag};
+}
+
 // clang-format on
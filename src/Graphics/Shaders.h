@@ -11,11 +11,14 @@ namespace rainbow::graphics::gl
 {
     auto DiffuseLight2D_frag() -> Shader::Params;
     auto DiffuseLightNormal_frag() -> Shader::Params;
+    auto DistanceField_frag() -> Shader::Params;
     auto Fixed2D_frag() -> Shader::Params;
     auto Fixed2D_vert() -> Shader::Params;
     auto GL2_1_header_glsl() -> czstring;
     auto GLES2_header_glsl() -> czstring;
+    auto Instanced2D_vert() -> Shader::Params;
     auto NormalMapped_vert() -> Shader::Params;
     auto Simple_frag() -> Shader::Params;
     auto Simple2D_vert() -> Shader::Params;
+    auto Text_frag() -> Shader::Params;
 }  // namespace rainbow::graphics::gl
@@ -0,0 +1,17 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+uniform float smoothing;  ///< Half-width of anti-aliased edges.
+uniform sampler2D texture;
+
+varying lowp vec4 v_color;
+varying vec2 v_texcoord;
+
+void main()
+{
+    // Outlines lie at 0.5; greater values are inside the glyph.
+    float distance = texture2D(texture, v_texcoord).a;
+    float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+    gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);
+}
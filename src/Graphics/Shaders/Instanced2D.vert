@@ -0,0 +1,27 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+uniform mat4 mvp_matrix;
+
+attribute vec2 corner;
+attribute vec4 color;
+attribute vec4 texcoord;
+attribute vec3 translation;
+attribute vec4 quad;
+
+varying lowp vec4 v_color;
+varying vec2 v_texcoord;
+
+void main()
+{
+    vec2 p = quad.xy + corner * quad.zw;
+    float s = sin(-translation.z);
+    float c = cos(-translation.z);
+    v_color = color;
+    v_texcoord = mix(texcoord.xy, texcoord.zw, corner);
+    gl_Position = mvp_matrix * vec4(c * p.x - s * p.y + translation.x,
+                                    s * p.x + c * p.y + translation.y,
+                                    0.0,
+                                    1.0);
+}
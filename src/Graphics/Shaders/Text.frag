@@ -0,0 +1,15 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+uniform sampler2D texture;
+
+varying lowp vec4 v_color;
+varying vec2 v_texcoord;
+
+void main()
+{
+    // Glyphs are stored as coverage only.
+    float alpha = texture2D(texture, v_texcoord).a;
+    gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);
+}
@@ -4,16 +4,23 @@
 
 #include "Graphics/Sprite.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "Graphics/SpriteBatch.h"
+#include "Graphics/StaleSprites.h"
 #include "Graphics/Texture.h"
 #include "Math/Transform.h"
+#include "Math/TransformBatch.h"
 
 // TODO: As of iOS 13.2, `using rainbow::Rect` clashes with another definition
 // in `MacTypes.h`.
 using rainbow::Color;
 using rainbow::Sprite;
+using rainbow::SpriteInstance;
 using rainbow::SpriteRef;
 using rainbow::SpriteVertex;
+using rainbow::TransformBatch;
 using rainbow::Vec2f;
 using rainbow::graphics::TextureData;
 
@@ -51,10 +58,17 @@ namespace
     auto normalized_coordinates(const TextureData& texture,
                                 const rainbow::Rect& rect)
     {
-        const auto left = rect.left / texture.width;
-        const auto bottom = rect.bottom / texture.height;
-        const auto right = (rect.left + rect.width) / texture.width;
-        const auto top = (rect.bottom + rect.height) / texture.height;
+        // Areas of packed textures are relative to their atlas page.
+        const auto width = texture.page == 0 ? texture.width
+                                             : texture.page_width;
+        const auto height = texture.page == 0 ? texture.height
+                                              : texture.page_height;
+        const auto x = rect.left + texture.offset_x;
+        const auto y = rect.bottom + texture.offset_y;
+        const auto left = x / width;
+        const auto bottom = y / height;
+        const auto right = (x + rect.width) / width;
+        const auto top = (y + rect.height) / height;
         return std::array<Vec2f, 4>{
             Vec2f{left, top},
             Vec2f{right, top},
@@ -62,6 +76,12 @@ namespace
             Vec2f{left, bottom},
         };
     }
+
+    auto to_unorm16(float v) -> uint16_t
+    {
+        return static_cast<uint16_t>(
+            std::lround(std::clamp(v, 0.0F, 1.0F) * 65535.0F));
+    }
 }  // namespace
 
 auto SpriteRef::get() const -> Sprite&
@@ -80,14 +100,14 @@ Sprite::Sprite(Sprite&& s) noexcept
 
 auto Sprite::angle(float r) -> Sprite&
 {
-    state_ |= kStaleBuffer;
+    mark_stale(kStaleBuffer);
     angle_ = r;
     return *this;
 }
 
 auto Sprite::color(Color c) -> Sprite&
 {
-    state_ |= kStaleTexture;
+    mark_stale(kStaleTexture);
     color_ = c;
     return *this;
 }
@@ -95,7 +115,7 @@ auto Sprite::color(Color c) -> Sprite&
 auto Sprite::flip() -> Sprite&
 {
     state_ ^= kIsFlipped;
-    state_ |= kStaleTexture;
+    mark_stale(kStaleTexture);
     return *this;
 }
 
@@ -104,10 +124,16 @@ auto Sprite::hide() -> Sprite&
     if (is_hidden())
         return *this;
 
-    state_ |= kIsHidden | kStaleMask;
+    state_ |= kIsHidden;
+    mark_stale(kStaleMask);
     return *this;
 }
 
+void Sprite::invalidate_texture()
+{
+    mark_stale(kStaleTexture);
+}
+
 auto Sprite::is_flipped() const -> bool
 {
     return (state_ & kIsFlipped) == kIsFlipped;
@@ -126,20 +152,20 @@ auto Sprite::is_mirrored() const -> bool
 auto Sprite::mirror() -> Sprite&
 {
     state_ ^= kIsMirrored;
-    state_ |= kStaleTexture;
+    mark_stale(kStaleTexture);
     return *this;
 }
 
 auto Sprite::move(Vec2f delta) -> Sprite&
 {
-    state_ |= kStalePosition;
+    mark_stale(kStalePosition);
     position_ += delta;
     return *this;
 }
 
 auto Sprite::normal(const rainbow::Rect& area) -> Sprite&
 {
-    state_ |= kStaleNormalMap;
+    mark_stale(kStaleNormalMap);
     normal_map_ = area;
     return *this;
 }
@@ -164,14 +190,14 @@ auto Sprite::pivot(Vec2f pivot) -> Sprite&
 
 auto Sprite::position(Vec2f position) -> Sprite&
 {
-    state_ |= kStalePosition;
+    mark_stale(kStalePosition);
     position_ = position;
     return *this;
 }
 
 auto Sprite::rotate(float r) -> Sprite&
 {
-    state_ |= kStaleBuffer;
+    mark_stale(kStaleBuffer);
     angle_ += r;
     return *this;
 }
@@ -181,30 +207,51 @@ auto Sprite::scale(Vec2f f) -> Sprite&
     R_ASSERT(f.x > 0.0F && f.y > 0.0F,  //
              "Can't scale with a factor of zero or less");
 
-    state_ |= kStaleBuffer;
+    mark_stale(kStaleBuffer);
     scale_ = f;
     return *this;
 }
 
+void Sprite::set_stale_list(rainbow::graphics::StaleSprites* list)
+{
+    stale_list_ = list;
+    if (list != nullptr && (state_ & kStaleMask) != 0)
+        list->add(*this);
+}
+
 auto Sprite::show() -> Sprite&
 {
     if (!is_hidden())
         return *this;
 
     state_ &= ~kIsHidden;
-    state_ |= kStaleMask;
+    mark_stale(kStaleMask);
     return *this;
 }
 
 auto Sprite::texture(const rainbow::Rect& area) -> Sprite&
 {
-    state_ |= kStaleTexture;
+    mark_stale(kStaleTexture);
     texture_area_ = area;
     return *this;
 }
 
 auto Sprite::update(ArraySpan<SpriteVertex> vertex_array,
                     const TextureData& texture) -> bool
+{
+    return update_internal(vertex_array, texture, nullptr);
+}
+
+auto Sprite::update(ArraySpan<SpriteVertex> vertex_array,
+                    const TextureData& texture,
+                    TransformBatch& batch) -> bool
+{
+    return update_internal(vertex_array, texture, &batch);
+}
+
+auto Sprite::update_internal(ArraySpan<SpriteVertex> vertex_array,
+                             const TextureData& texture,
+                             TransformBatch* batch) -> bool
 {
     if ((state_ & kStaleMask) == 0)
         return false;
@@ -224,7 +271,10 @@ auto Sprite::update(ArraySpan<SpriteVertex> vertex_array,
         if ((state_ & kStalePosition) != 0)
             center_ = position_;
 
-        rainbow::transform(*this, vertex_array);
+        if (batch != nullptr)
+            batch->add(*this, vertex_array.data());
+        else
+            rainbow::transform(*this, vertex_array);
     }
     else if ((state_ & kStalePosition) != 0)
     {
@@ -253,6 +303,49 @@ auto Sprite::update(ArraySpan<SpriteVertex> vertex_array,
     return true;
 }
 
+auto Sprite::update(SpriteInstance& instance, const TextureData& texture)
+    -> bool
+{
+    if ((state_ & kStaleMask) == 0)
+        return false;
+
+    if (is_hidden())
+    {
+        instance.origin = Vec2f::Zero;
+        instance.extent = Vec2f::Zero;
+        state_ &= ~kStaleMask;
+        return true;
+    }
+
+    if ((state_ & (kStaleBuffer | kStalePosition)) != 0)
+    {
+        center_ = position_;
+        instance.position = position_;
+        instance.angle = angle_;
+        instance.origin = {width_ * -pivot_.x * scale_.x,
+                           height_ * (pivot_.y - 1) * scale_.y};
+        instance.extent = {width_ * scale_.x, height_ * scale_.y};
+    }
+
+    if ((state_ & kStaleTexture) != 0)
+    {
+        // The quad is axis-aligned in texture space, so the UVs of vertices 0
+        // and 2 are enough to reconstruct the rest.
+        auto coords = normalized_coordinates(texture, texture_area_);
+        const uint32_t f = flip_index(state_);
+        const auto& uv0 = coords[kFlipTable[f + 0]];
+        const auto& uv2 = coords[kFlipTable[f + 2]];
+        instance.color = color_;
+        instance.texcoords[0] = to_unorm16(uv0.x);
+        instance.texcoords[1] = to_unorm16(uv0.y);
+        instance.texcoords[2] = to_unorm16(uv2.x);
+        instance.texcoords[3] = to_unorm16(uv2.y);
+    }
+
+    state_ &= ~kStaleMask;
+    return true;
+}
+
 auto Sprite::update(ArraySpan<Vec2f> normal_array, const TextureData& normal)
     -> bool
 {
@@ -270,6 +363,8 @@ auto Sprite::update(ArraySpan<Vec2f> normal_array, const TextureData& normal)
 
 auto Sprite::operator=(Sprite&& s) noexcept -> Sprite&
 {
+    // The stale list belongs to the slot in the batch, and is not moved.
+    mark_stale(kStaleMask);
     state_ = s.state_ | kStaleMask;
     center_ = s.center_;
     position_ = s.position_;
@@ -287,3 +382,11 @@ auto Sprite::operator=(Sprite&& s) noexcept -> Sprite&
 
     return *this;
 }
+
+void Sprite::mark_stale(uint32_t flags)
+{
+    if ((state_ & kStaleMask) == 0 && stale_list_ != nullptr)
+        stale_list_->add(*this);
+
+    state_ |= flags;
+}
@@ -12,6 +12,7 @@
 
 namespace rainbow::graphics
 {
+    class StaleSprites;
     struct TextureData;
 }  // namespace rainbow::graphics
 
@@ -19,6 +20,7 @@ namespace rainbow
 {
     class Sprite;
     class SpriteBatch;
+    class TransformBatch;
 
     class SpriteRef
     {
@@ -127,6 +129,12 @@ namespace rainbow
             return *this;
         }
 
+        /// <summary>
+        ///   Forces texture coordinates to be recalculated on next update,
+        ///   e.g. after the texture's image was replaced.
+        /// </summary>
+        void invalidate_texture();
+
         /// <summary>Mirrors sprite.</summary>
         auto mirror() -> Sprite&;
 
@@ -161,6 +169,13 @@ namespace rainbow
         /// <param name="f">Scaling factors for x- and y-axis.</param>
         auto scale(Vec2f f) -> Sprite&;
 
+        /// <summary>
+        ///   Sets the list that this sprite adds itself to whenever it is
+        ///   marked stale. Used by sprite batches to only update sprites that
+        ///   changed.
+        /// </summary>
+        void set_stale_list(graphics::StaleSprites* list);
+
         /// <summary>Shows sprite if it is currently hidden.</summary>
         auto show() -> Sprite&;
 
@@ -175,6 +190,25 @@ namespace rainbow
         auto update(ArraySpan<SpriteVertex> vertex_array,
                     const graphics::TextureData&) -> bool;
 
+        /// <summary>
+        ///   Updates the vertex buffer, deferring transformation to
+        ///   <paramref name="batch"/>. Vertex positions are only valid after
+        ///   <paramref name="batch"/> has been flushed.
+        /// </summary>
+        /// <returns>
+        ///   <c>true</c> if the buffer has changed; <c>false</c> otherwise.
+        /// </returns>
+        auto update(ArraySpan<SpriteVertex> vertex_array,
+                    const graphics::TextureData&,
+                    TransformBatch& batch) -> bool;
+
+        /// <summary>Updates the instance data.</summary>
+        /// <returns>
+        ///   <c>true</c> if the instance has changed; <c>false</c> otherwise.
+        /// </returns>
+        auto update(SpriteInstance& instance, const graphics::TextureData&)
+            -> bool;
+
         /// <summary>Updates the normal buffer.</summary>
         /// <returns>
         ///   <c>true</c> if the buffer has changed; <c>false</c> otherwise.
@@ -224,6 +258,19 @@ namespace rainbow
 
         /// <summary>User defined identifier.</summary>
         int id_ = kNoId;
+
+        /// <summary>Stale sprites of the owning batch, if any.</summary>
+        graphics::StaleSprites* stale_list_ = nullptr;
+
+        /// <summary>
+        ///   Sets <paramref name="flags"/>, and adds the sprite to its batch's
+        ///   stale list if it was clean.
+        /// </summary>
+        void mark_stale(uint32_t flags);
+
+        auto update_internal(ArraySpan<SpriteVertex> vertex_array,
+                             const graphics::TextureData&,
+                             TransformBatch* batch) -> bool;
     };
 }  // namespace rainbow
 
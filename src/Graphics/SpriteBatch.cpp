@@ -4,14 +4,23 @@
 
 #include "Graphics/SpriteBatch.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "Graphics/SpriteGrid.h"
+#include "Math/TransformBatch.h"
 #include "Script/GameBase.h"
 
 using rainbow::GameBase;
 using rainbow::SpriteBatch;
 using rainbow::SpriteRef;
 using rainbow::SpriteVertex;
+using rainbow::TransformBatch;
 using rainbow::Vec2f;
+using rainbow::graphics::ElementBuffer;
+using rainbow::graphics::SpriteGrid;
 using rainbow::graphics::Texture;
+using rainbow::graphics::TextureData;
 
 namespace
 {
@@ -19,34 +28,128 @@ namespace
     {
         return u;
     }
+
+    template <typename T>
+    void upload_indices(const std::vector<uint32_t>& sprites,
+                        std::vector<T>& indices)
+    {
+        indices.resize(sprites.size() * 6);
+        auto index = indices.data();
+        for (auto sprite : sprites)
+        {
+            const auto vertex = static_cast<T>(sprite * 4);
+            index[0] = vertex;
+            index[1] = vertex + 1;
+            index[2] = vertex + 2;
+            index[3] = vertex + 2;
+            index[4] = vertex + 3;
+            index[5] = vertex;
+            index += 6;
+        }
+
+        const auto size = indices.size() * sizeof(T);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        glBufferData(
+            GL_ELEMENT_ARRAY_BUFFER, size, indices.data(), GL_STREAM_DRAW);
+
+        IF_DEBUG(rainbow::graphics::increment_bytes_uploaded(size));
+    }
 }  // namespace
 
-SpriteBatch::SpriteBatch(uint32_t count)
-    : sprites_(count), vertices_(std::make_unique<SpriteVertex[]>(count * 4_z))
+struct SpriteBatch::Culling
+{
+    SpriteGrid grid;
+
+    /// <summary>Sprites that intersected the viewport last frame.</summary>
+    std::vector<uint32_t> visible;
+
+    /// <summary>Client index buffers; only one is used.</summary>
+    std::vector<uint16_t> indices16;
+    std::vector<uint32_t> indices32;
+
+    /// <summary>Element buffer holding indices of visible sprites.</summary>
+    GLuint elements = 0;
+
+    /// <summary>Number of sprites drawn last frame.</summary>
+    uint32_t drawn = 0;
+
+    Culling() { glGenBuffers(1, &elements); }
+
+    ~Culling()
+    {
+        if (elements == 0)
+            return;
+
+        graphics::delete_buffer(elements);
+    }
+};
+
+SpriteBatch::SpriteBatch(uint32_t count) : SpriteBatch(count, true) {}
+
+SpriteBatch::SpriteBatch(uint32_t count, bool vertices)
+    : sprites_(count), stale_sprites_(sprites_.data())
 {
-    R_ASSERT(count <= graphics::kMaxSprites, "Hard-coded limit reached");
+    if (!vertices)
+        return;
 
+    vertices_ = std::make_unique<SpriteVertex[]>(count * 4_z);
     array_.reconfigure([this] { bind_arrays(); });
 }
 
 SpriteBatch::SpriteBatch(SpriteBatch&& batch) noexcept
     : sprites_(std::move(batch.sprites_)),
+      stale_sprites_(std::move(batch.stale_sprites_)),
       vertices_(std::move(batch.vertices_)),
-      normals_(std::move(batch.normals_)), count_(batch.count_),
+      normals_(std::move(batch.normals_)),
+      dirty_ranges_(std::move(batch.dirty_ranges_)), count_(batch.count_),
       vertex_buffer_(std::move(batch.vertex_buffer_)),
       normal_buffer_(std::move(batch.normal_buffer_)),
       array_(std::move(batch.array_)), texture_(batch.texture_),
-      normal_(batch.normal_), visible_(batch.visible_)
+      normal_(batch.normal_), texture_revision_(batch.texture_revision_),
+      culling_(std::move(batch.culling_)),
+      visible_(batch.visible_), needs_allocation_(batch.needs_allocation_)
 {
+    for (auto&& sprite : *this)
+        sprite.set_stale_list(&stale_sprites_);
+
     batch.clear();
 }
 
+auto SpriteBatch::drawn_count() const -> uint32_t
+{
+    if (!visible_)
+        return 0;
+
+    return culling_ ? culling_->drawn : count_;
+}
+
+void SpriteBatch::set_culling(bool enable)
+{
+    if (!enable)
+    {
+        culling_.reset();
+        return;
+    }
+
+    if (culling_ || !vertices_)
+        return;
+
+    culling_ = std::make_unique<Culling>();
+    culling_->drawn = count_;
+
+    // Sprites that are stale will be updated on the next frame.
+    auto& grid = culling_->grid;
+    for (uint32_t i = 0; i < count_; ++i)
+        grid.update(i, vertices_.get() + i * 4_z);
+}
+
 void SpriteBatch::set_normal(const Texture& texture)
 {
     if (!normals_)
     {
         normals_ = std::make_unique<Vec2f[]>(sprites_.size() * 4_z);
         array_.reconfigure([this] { bind_arrays(); });
+        needs_allocation_ = true;
     }
 
     normal_ = &texture;
@@ -75,9 +178,11 @@ auto SpriteBatch::create_sprite(uint32_t width, uint32_t height) -> SpriteRef
         return {};
     }
 
-    new (sprites_.data() + count_) Sprite(width, height);
+    auto sprite = new (sprites_.data() + count_) Sprite(width, height);
+    sprite->set_stale_list(&stale_sprites_);
     const uint32_t offset = count_ * 4;
-    std::fill_n(vertices_.get() + offset, 4, SpriteVertex{});
+    if (vertices_)
+        std::fill_n(vertices_.get() + offset, 4, SpriteVertex{});
     if (normals_)
         std::fill_n(normals_.get() + offset, 4, Vec2f::Zero);
     return {*this, sprites_.find_iterator(count_++)};
@@ -123,44 +228,155 @@ void SpriteBatch::swap(uint32_t i, uint32_t j)
 
 void SpriteBatch::update(GameBase& context)
 {
-    bool needs_update = false;
+    update_vertices(context);
+    upload();
+}
+
+void SpriteBatch::update_vertices(GameBase& context)
+{
     auto sprites = sprites_.data();
     auto texture = context.texture_provider().raw_get(*texture_);
+    invalidate_stale_texture(texture);
 
+    dirty_ranges_.clear();
+    TransformBatch transforms;
+    const auto& stale = stale_sprites_.sorted(count_);
     if (normals_)
     {
         auto normal = context.texture_provider().raw_get(*normal_);
-        for (uint32_t i = 0; i < count_; ++i)
+        for (auto i : stale)
         {
             ArraySpan<Vec2f> normal_buffer{normals_.get() + i * 4, 4};
             ArraySpan<SpriteVertex> vertex_buffer{vertices_.get() + i * 4, 4};
-            needs_update |= sprites[i].update(normal_buffer, normal) |
-                            sprites[i].update(vertex_buffer, texture);
+            if (sprites[i].update(normal_buffer, normal) |
+                sprites[i].update(vertex_buffer, texture, transforms))
+            {
+                dirty_ranges_.add(i);
+            }
         }
     }
     else
     {
-        for (uint32_t i = 0; i < count_; ++i)
+        for (auto i : stale)
         {
             ArraySpan<SpriteVertex> buffer{vertices_.get() + i * 4, 4};
-            needs_update |= sprites[i].update(buffer, texture);
+            if (sprites[i].update(buffer, texture, transforms))
+                dirty_ranges_.add(i);
         }
     }
+    stale_sprites_.clear();
+    transforms.flush();
 
-    if (needs_update)
+    if (culling_)
     {
-        const uint32_t count = count_ * 4;
-        vertex_buffer_.upload(vertices_.get(), count * sizeof(SpriteVertex));
-        if (normals_)
-            normal_buffer_.upload(normals_.get(), count * sizeof(Vec2f));
+        auto& grid = culling_->grid;
+        grid.resize(count_);
+        for (auto&& range : dirty_ranges_)
+        {
+            for (auto i = range.first; i < range.last; ++i)
+                grid.update(i, vertices_.get() + i * 4_z);
+        }
     }
 }
 
-void SpriteBatch::bind_arrays() const
+void SpriteBatch::invalidate_stale_texture(const TextureData& texture)
 {
-    vertex_buffer_.bind();
+    if (texture.revision == texture_revision_)
+        return;
+
+    texture_revision_ = texture.revision;
+    auto sprites = sprites_.data();
+    for (uint32_t i = 0; i < count_; ++i)
+        sprites[i].invalidate_texture();
+}
+
+auto SpriteBatch::draw_culled(const Rect& viewport) const -> bool
+{
+    R_ASSERT(culling_, "Culling is not enabled for this batch");
+
+    if (!visible_)
+        return true;
+
+    auto& culling = *culling_;
+    auto& visible = culling.visible;
+    culling.grid.query(viewport, visible);
+
+    // Sprites may have been erased since the last update.
+    visible.erase(std::lower_bound(visible.begin(), visible.end(), count_),
+                  visible.end());
+
+    culling.drawn = static_cast<uint32_t>(visible.size());
+    if (culling.drawn == count_)
+        return false;
+
+    if (culling.drawn == 0)
+        return true;
+
+    const auto index_type = graphics::element_buffer().index_type();
+    if (index_type != GL_UNSIGNED_INT &&
+        count_ > ElementBuffer::kMaxShortIndexedSprites)
+    {
+        culling.drawn = count_;
+        return false;
+    }
+
+    array_.bind();
+    graphics::state_cache().bind_element_buffer(culling.elements);
+    if (index_type == GL_UNSIGNED_INT)
+        upload_indices(visible, culling.indices32);
+    else
+        upload_indices(visible, culling.indices16);
+
+    glDrawElements(GL_TRIANGLES,
+                   narrow_cast<GLsizei>(culling.drawn * 6),
+                   index_type,
+                   nullptr);
+
+    IF_DEBUG(graphics::increment_draw_count());
+
+    // The vertex array object must keep referring to the shared indices.
+    graphics::bind_element_array();
+    return true;
+}
+
+void SpriteBatch::bind_arrays(uint32_t first) const
+{
+    vertex_buffer_.bind_at(first);
     if (normals_)
-        normal_buffer_.bind(Shader::kAttributeNormal);
+        normal_buffer_.bind_at(Shader::kAttributeNormal, first);
+}
+
+void SpriteBatch::upload()
+{
+    if (dirty_ranges_.empty())
+        return;
+
+    if (needs_allocation_)
+    {
+        // Allocate for the full capacity so that subsequent updates only need
+        // to touch the stale ranges.
+        const auto count = sprites_.size() * 4_z;
+        vertex_buffer_.upload(vertices_.get(), count * sizeof(SpriteVertex));
+        if (normals_)
+            normal_buffer_.upload(normals_.get(), count * sizeof(Vec2f));
+        needs_allocation_ = false;
+        return;
+    }
+
+    for (auto&& range : dirty_ranges_)
+    {
+        const auto offset = range.first * 4_z;
+        const auto count = range.size() * 4_z;
+        vertex_buffer_.update(vertices_.get() + offset,
+                              count * sizeof(SpriteVertex),
+                              offset * sizeof(SpriteVertex));
+        if (normals_)
+        {
+            normal_buffer_.update(normals_.get() + offset,
+                                  count * sizeof(Vec2f),
+                                  offset * sizeof(Vec2f));
+        }
+    }
 }
 
 void rainbow::graphics::draw(Context& context, const SpriteBatch& batch)
@@ -176,20 +392,50 @@ void rainbow::graphics::draw(Context& context, const SpriteBatch& batch)
         bind(context, *batch.normal(), 1);
 
     bind(context, *batch.texture());
-    draw(batch.vertex_array(), batch.vertex_count());
+
+    if (batch.is_culling() && batch.draw_culled(context.projection))
+        return;
+
+    const auto max_sprites = element_buffer().max_sprites();
+    if (batch.vertex_count() <= max_sprites * 6)
+    {
+        draw(batch.vertex_array(), batch.vertex_count());
+        return;
+    }
+
+    // 16-bit indices cannot address the whole batch. Draw it in chunks,
+    // moving the attribute pointers to the start of each chunk.
+    const auto index_type = element_buffer().index_type();
+    element_buffer().reserve(max_sprites);
+    batch.vertex_array().bind();
+    for (uint32_t first = 0; first < batch.size(); first += max_sprites)
+    {
+        const auto count = std::min(max_sprites, batch.size() - first);
+        batch.bind_arrays(first * 4);
+        glDrawElements(GL_TRIANGLES,
+                       narrow_cast<GLsizei>(count * 6),
+                       index_type,
+                       nullptr);
+
+        IF_DEBUG(increment_draw_count());
+    }
+
+    // Restore the vertex array object's state.
+    batch.bind_arrays();
 }
 
-#ifndef NDEBUG
 SpriteBatch::~SpriteBatch()
 {
+#ifndef NDEBUG
     Director::assert_unused(
         this, "SpriteBatch deleted but is still in the render queue.");
-}
 #endif
+}
 
 #ifdef RAINBOW_TEST
 SpriteBatch::SpriteBatch(const rainbow::ISolemnlySwearThatIAmOnlyTesting& test)
-    : sprites_(4), vertices_(std::make_unique<SpriteVertex[]>(4 * 4)),
+    : sprites_(4), stale_sprites_(sprites_.data()),
+      vertices_(std::make_unique<SpriteVertex[]>(4 * 4)),
       vertex_buffer_(test), normal_buffer_(test)
 {
 }
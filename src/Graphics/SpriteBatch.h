@@ -8,7 +8,9 @@
 #include <type_traits>
 
 #include "Graphics/Buffer.h"
+#include "Graphics/DirtyRanges.h"
 #include "Graphics/Sprite.h"
+#include "Graphics/StaleSprites.h"
 #include "Graphics/Texture.h"
 #include "Graphics/VertexArray.h"
 #include "Memory/StableArray.h"
@@ -21,8 +23,8 @@ namespace rainbow
     /// <summary>A drawable batch of sprites.</summary>
     /// <remarks>
     ///   All sprites share a common vertex buffer object (at different offsets)
-    ///   and are drawn with a single glDraw call. The sprites must use the same
-    ///   texture atlas.
+    ///   and are drawn with a single glDraw call, or in chunks where 32-bit
+    ///   indices are unsupported. The sprites must use the same texture atlas.
     /// </remarks>
     class SpriteBatch : private NonCopyable<SpriteBatch>
     {
@@ -49,6 +51,23 @@ namespace rainbow
         [[nodiscard]] auto end() { return begin() + count_; }
         [[nodiscard]] auto end() const { return begin() + count_; }
 
+        /// <summary>Returns the number of sprites drawn last frame.</summary>
+        [[nodiscard]] auto drawn_count() const -> uint32_t;
+
+        /// <summary>
+        ///   Returns whether sprites outside the viewport are culled.
+        /// </summary>
+        [[nodiscard]] auto is_culling() const
+        {
+            return static_cast<bool>(culling_);
+        }
+
+        /// <summary>
+        ///   Returns whether the last call to <see cref="update_vertices"/>
+        ///   found any stale sprites.
+        /// </summary>
+        [[nodiscard]] auto is_stale() const { return !dirty_ranges_.empty(); }
+
         /// <summary>Returns whether the batch is visible.</summary>
         [[nodiscard]] auto is_visible() const { return visible_; }
 
@@ -67,12 +86,23 @@ namespace rainbow
             return array_;
         }
 
+        /// <summary>Returns the client vertex buffer.</summary>
+        [[nodiscard]] auto vertices() const { return vertices_.get(); }
+
         /// <summary>Returns vertex count.</summary>
         [[nodiscard]] auto vertex_count() const
         {
             return !visible_ ? 0 : count_ * 6;
         }
 
+        /// <summary>
+        ///   Sets whether to skip drawing sprites outside the viewport. Sprite
+        ///   bounds are kept in a uniform grid that is updated as sprites
+        ///   change. Worthwhile for large batches that are mostly off-screen,
+        ///   e.g. in scrolling levels.
+        /// </summary>
+        void set_culling(bool enable);
+
         /// <summary>Assigns a normal map.</summary>
         void set_normal(const graphics::Texture&);
         void set_normal(NotNull<const graphics::Texture*> texture)
@@ -87,6 +117,12 @@ namespace rainbow
             set_texture(*texture.get());
         }
 
+        /// <summary>
+        ///   Sets the maximum number of unchanged sprites allowed between two
+        ///   stale ranges before they are uploaded separately.
+        /// </summary>
+        void set_upload_gap(uint32_t gap) { dirty_ranges_.set_gap(gap); }
+
         /// <summary>Sets batch visibility.</summary>
         void set_visible(bool visible) { visible_ = visible; }
 
@@ -97,6 +133,12 @@ namespace rainbow
             return (*this)[i];
         }
 
+        /// <summary>
+        ///   Sets the array state for this batch, starting at vertex
+        ///   <paramref name="first"/>.
+        /// </summary>
+        void bind_arrays(uint32_t first = 0) const;
+
         /// <summary>Brings sprite to front.</summary>
         void bring_to_front(uint32_t i);
 
@@ -110,7 +152,21 @@ namespace rainbow
         }
 
         /// <summary>Clears all sprites.</summary>
-        void clear() { count_ = 0; }
+        void clear()
+        {
+            count_ = 0;
+            stale_sprites_.clear();
+        }
+
+        /// <summary>
+        ///   Draws only sprites that intersect <paramref name="viewport"/>.
+        ///   Used by <c>graphics::draw</c> when culling is enabled.
+        /// </summary>
+        /// <returns>
+        ///   <c>true</c> if drawn; <c>false</c> if the batch must be drawn in
+        ///   full instead.
+        /// </returns>
+        auto draw_culled(const Rect& viewport) const -> bool;
 
         /// <summary>Creates a sprite.</summary>
         /// <param name="width">Width of the sprite.</param>
@@ -152,6 +208,18 @@ namespace rainbow
         /// <summary>Updates the batch of sprites.</summary>
         void update(GameBase&);
 
+        /// <summary>
+        ///   Updates the client buffers of stale sprites. Does not make any GL
+        ///   calls and may be called from a worker thread.
+        /// </summary>
+        void update_vertices(GameBase&);
+
+        /// <summary>
+        ///   Uploads sprites found stale by the last call to
+        ///   <see cref="update_vertices"/>.
+        /// </summary>
+        void upload();
+
         [[nodiscard]] auto operator[](uint32_t i) -> Sprite&
         {
             return sprites_[i];
@@ -162,9 +230,7 @@ namespace rainbow
             return sprites_[i];
         }
 
-#ifndef NDEBUG
         ~SpriteBatch();
-#endif
 
 #ifdef RAINBOW_TEST
         explicit SpriteBatch(const ISolemnlySwearThatIAmOnlyTesting&);
@@ -172,18 +238,48 @@ namespace rainbow
         [[nodiscard]] auto capacity() const { return sprites_.size(); }
         [[nodiscard]] auto sprites() { return sprites_.data(); }
         [[nodiscard]] auto sprites() const { return sprites_.data(); }
-        [[nodiscard]] auto vertices() const { return vertices_.get(); }
 #endif
 
+    protected:
+        /// <summary>
+        ///   Creates a batch of sprites, optionally without client vertex
+        ///   buffer for batches that store sprites in a different format.
+        /// </summary>
+        SpriteBatch(uint32_t count, bool vertices);
+
+        /// <summary>
+        ///   Marks texture coordinates of all sprites as stale if the image
+        ///   of <paramref name="texture"/> was replaced since last call, e.g.
+        ///   when it finished loading asynchronously.
+        /// </summary>
+        void invalidate_stale_texture(const graphics::TextureData& texture);
+
+        /// <summary>
+        ///   Returns sprites marked stale since last update. Must be cleared
+        ///   once they have been updated.
+        /// </summary>
+        [[nodiscard]] auto stale_sprites() -> graphics::StaleSprites&
+        {
+            return stale_sprites_;
+        }
+
     private:
+        struct Culling;
+
         StableArray<Sprite> sprites_;
 
+        /// <summary>Sprites marked stale since last update.</summary>
+        graphics::StaleSprites stale_sprites_;
+
         /// <summary>Client vertex buffer.</summary>
         std::unique_ptr<SpriteVertex[]> vertices_;
 
         /// <summary>Client normal buffer.</summary>
         std::unique_ptr<Vec2f[]> normals_;
 
+        /// <summary>Stale sprites found during last update.</summary>
+        graphics::DirtyRanges dirty_ranges_;
+
         /// <summary>Number of sprites.</summary>
         uint32_t count_ = 0;
 
@@ -202,9 +298,23 @@ namespace rainbow
         /// <summary>Normal map used by all sprites in the batch.</summary>
         const graphics::Texture* normal_ = nullptr;
 
+        /// <summary>
+        ///   Revision of the texture that texture coordinates were last
+        ///   calculated for.
+        /// </summary>
+        uint32_t texture_revision_ = 0;
+
+        /// <summary>Culling state; only allocated when enabled.</summary>
+        std::unique_ptr<Culling> culling_;
+
         /// <summary>Whether the batch is visible.</summary>
         bool visible_ = true;
 
+        /// <summary>
+        ///   Whether GPU buffers must be (re)allocated on next upload.
+        /// </summary>
+        bool needs_allocation_ = true;
+
         void add() {}
 
         template <typename T, typename... Args>
@@ -218,8 +328,6 @@ namespace rainbow
             add(std::forward<Args>(sprites)...);
         }
 
-        /// <summary>Sets the array state for this batch.</summary>
-        void bind_arrays() const;
     };
 }  // namespace rainbow
 
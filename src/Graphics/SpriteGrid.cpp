@@ -0,0 +1,158 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/SpriteGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Graphics/SpriteVertex.h"
+
+using rainbow::SpriteVertex;
+using rainbow::graphics::SpriteGrid;
+
+namespace
+{
+    auto cell_key(int32_t x, int32_t y) -> uint64_t
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+               static_cast<uint32_t>(y);
+    }
+
+    auto to_cell(float v, float cell_size)
+    {
+        return static_cast<int32_t>(std::floor(v / cell_size));
+    }
+}  // namespace
+
+void SpriteGrid::clear()
+{
+    ranges_.clear();
+    cells_.clear();
+}
+
+void SpriteGrid::query(const Rect& area, std::vector<uint32_t>& result) const
+{
+    result.clear();
+
+    const auto range = cell_range(area.left,
+                                  area.bottom,
+                                  area.left + area.width,
+                                  area.bottom + area.height);
+    const auto columns = int64_t{range.x1} - range.x0 + 1;
+    const auto rows = int64_t{range.y1} - range.y0 + 1;
+    if (columns * rows > static_cast<int64_t>(cells_.size()))
+    {
+        // The area covers more cells than are occupied, e.g. when zoomed out.
+        for (auto&& [key, sprites] : cells_)
+        {
+            const auto x = static_cast<int32_t>(key >> 32);
+            const auto y = static_cast<int32_t>(key & 0xffffffffU);
+            if (x < range.x0 || x > range.x1 || y < range.y0 || y > range.y1)
+                continue;
+
+            result.insert(result.end(), sprites.begin(), sprites.end());
+        }
+    }
+    else
+    {
+        for (auto y = range.y0; y <= range.y1; ++y)
+        {
+            for (auto x = range.x0; x <= range.x1; ++x)
+            {
+                auto cell = cells_.find(cell_key(x, y));
+                if (cell == cells_.end())
+                    continue;
+
+                const auto& sprites = cell->second;
+                result.insert(result.end(), sprites.begin(), sprites.end());
+            }
+        }
+    }
+
+    // Sprites spanning several cells are found more than once, and cells are
+    // unordered. Draw order must be preserved.
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+void SpriteGrid::resize(uint32_t count)
+{
+    for (auto i = count; i < size(); ++i)
+        remove(i, ranges_[i]);
+
+    ranges_.resize(count);
+}
+
+void SpriteGrid::update(uint32_t i, const SpriteVertex* quad)
+{
+    if (i >= size())
+        ranges_.resize(i + 1);
+
+    auto left = quad[0].position.x;
+    auto bottom = quad[0].position.y;
+    auto right = left;
+    auto top = bottom;
+    for (int j = 1; j < 4; ++j)
+    {
+        const auto& p = quad[j].position;
+        left = std::min(left, p.x);
+        bottom = std::min(bottom, p.y);
+        right = std::max(right, p.x);
+        top = std::max(top, p.y);
+    }
+
+    const auto range = left == right && bottom == top
+                           ? CellRange{}
+                           : cell_range(left, bottom, right, top);
+
+    auto& current = ranges_[i];
+    if (range == current)
+        return;
+
+    remove(i, current);
+    insert(i, range);
+    current = range;
+}
+
+auto SpriteGrid::cell_range(float left, float bottom, float right, float top)
+    const -> CellRange
+{
+    return {to_cell(left, cell_size_),
+            to_cell(bottom, cell_size_),
+            to_cell(right, cell_size_),
+            to_cell(top, cell_size_)};
+}
+
+void SpriteGrid::insert(uint32_t i, const CellRange& range)
+{
+    for (auto y = range.y0; y <= range.y1; ++y)
+    {
+        for (auto x = range.x0; x <= range.x1; ++x)
+            cells_[cell_key(x, y)].push_back(i);
+    }
+}
+
+void SpriteGrid::remove(uint32_t i, const CellRange& range)
+{
+    for (auto y = range.y0; y <= range.y1; ++y)
+    {
+        for (auto x = range.x0; x <= range.x1; ++x)
+        {
+            auto cell = cells_.find(cell_key(x, y));
+            if (cell == cells_.end())
+                continue;
+
+            auto& sprites = cell->second;
+            auto sprite = std::find(sprites.begin(), sprites.end(), i);
+            if (sprite == sprites.end())
+                continue;
+
+            *sprite = sprites.back();
+            sprites.pop_back();
+            if (sprites.empty())
+                cells_.erase(cell);
+        }
+    }
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_SPRITEGRID_H_
+#define GRAPHICS_SPRITEGRID_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/NonCopyable.h"
+#include "Math/Geometry.h"
+
+namespace rainbow
+{
+    struct SpriteVertex;
+}  // namespace rainbow
+
+namespace rainbow::graphics
+{
+    /// <summary>Uniform grid of sprite bounds used for culling.</summary>
+    /// <remarks>
+    ///   Sprites are identified by their index in the batch. Each sprite is
+    ///   registered in every cell its axis-aligned bounds overlap, and is only
+    ///   moved between cells when those change.
+    /// </remarks>
+    class SpriteGrid : private NonCopyable<SpriteGrid>
+    {
+    public:
+        static constexpr float kDefaultCellSize = 256.0F;
+
+        explicit SpriteGrid(float cell_size = kDefaultCellSize)
+            : cell_size_(cell_size)
+        {
+        }
+
+        /// <summary>Returns the width and height of a cell.</summary>
+        [[nodiscard]] auto cell_size() const { return cell_size_; }
+
+        /// <summary>Returns the number of tracked sprites.</summary>
+        [[nodiscard]] auto size() const
+        {
+            return static_cast<uint32_t>(ranges_.size());
+        }
+
+        /// <summary>Removes all sprites.</summary>
+        void clear();
+
+        /// <summary>
+        ///   Returns indices of sprites whose bounds intersect
+        ///   <paramref name="area"/>, in ascending order.
+        /// </summary>
+        void query(const Rect& area, std::vector<uint32_t>& result) const;
+
+        /// <summary>
+        ///   Sets the number of tracked sprites. Sprites at index
+        ///   <paramref name="count"/> and above are removed.
+        /// </summary>
+        void resize(uint32_t count);
+
+        /// <summary>
+        ///   Updates the bounds of sprite <paramref name="i"/> from its
+        ///   transformed <paramref name="quad"/>. Degenerate quads, e.g. of
+        ///   hidden sprites, are removed from the grid.
+        /// </summary>
+        void update(uint32_t i, const SpriteVertex* quad);
+
+    private:
+        /// <summary>Inclusive range of cells covered by a sprite.</summary>
+        struct CellRange
+        {
+            int32_t x0 = 0;
+            int32_t y0 = 0;
+            int32_t x1 = -1;
+            int32_t y1 = -1;
+
+            [[nodiscard]] auto is_empty() const { return x1 < x0; }
+
+            friend auto operator==(const CellRange& lhs, const CellRange& rhs)
+            {
+                return lhs.x0 == rhs.x0 && lhs.y0 == rhs.y0 &&
+                       lhs.x1 == rhs.x1 && lhs.y1 == rhs.y1;
+            }
+        };
+
+        float cell_size_;
+        std::vector<CellRange> ranges_;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+
+        [[nodiscard]] auto cell_range(float left,
+                                      float bottom,
+                                      float right,
+                                      float top) const -> CellRange;
+
+        void insert(uint32_t i, const CellRange& range);
+        void remove(uint32_t i, const CellRange& range);
+    };
+}  // namespace rainbow::graphics
+
+#endif
@@ -20,6 +20,22 @@ namespace rainbow
         Vec2f texcoord;  ///< Texture coordinates.
         Vec2f position;  ///< Position of vertex.
     };
+
+    /// <summary>
+    ///   Per-instance sprite data. Quads are expanded from this in the vertex
+    ///   shader.
+    /// </summary>
+    struct SpriteInstance
+    {
+        Vec2f position;           ///< Position of the pivot.
+        float angle = 0.0F;       ///< Angle of rotation.
+        Vec2f origin;             ///< Scaled offset of vertex 0 from pivot.
+        Vec2f extent;             ///< Scaled width and height.
+        Color color;              ///< Texture colour; white by default.
+        uint16_t texcoords[4]{};  ///< Normalised UVs of vertex 0 and 2.
+    };
+
+    static_assert(sizeof(SpriteInstance) == 40);
 }  // namespace rainbow
 
 #endif
@@ -0,0 +1,64 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_STALESPRITES_H_
+#define GRAPHICS_STALESPRITES_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/Sprite.h"
+
+namespace rainbow::graphics
+{
+    /// <summary>
+    ///   Indices of sprites in a batch that were marked stale since the batch
+    ///   was last updated, so that updates only need to visit those.
+    /// </summary>
+    /// <remarks>
+    ///   Sprites add themselves when they go from clean to stale. An index may
+    ///   appear more than once, e.g. after a sprite was updated outside of its
+    ///   batch, or be out of range after sprites were erased.
+    /// </remarks>
+    class StaleSprites
+    {
+    public:
+        explicit StaleSprites(const Sprite* first) : first_(first) {}
+
+        [[nodiscard]] auto empty() const { return indices_.empty(); }
+
+        /// <summary>
+        ///   Adds <paramref name="sprite"/>, which must belong to this batch.
+        /// </summary>
+        void add(const Sprite& sprite)
+        {
+            indices_.push_back(static_cast<uint32_t>(&sprite - first_));
+        }
+
+        void clear() { indices_.clear(); }
+
+        /// <summary>
+        ///   Returns unique indices less than <paramref name="count"/>, in
+        ///   ascending order.
+        /// </summary>
+        [[nodiscard]] auto sorted(uint32_t count)
+            -> const std::vector<uint32_t>&
+        {
+            std::sort(indices_.begin(), indices_.end());
+            indices_.erase(
+                std::unique(indices_.begin(), indices_.end()), indices_.end());
+            indices_.erase(
+                std::lower_bound(indices_.begin(), indices_.end(), count),
+                indices_.end());
+            return indices_;
+        }
+
+    private:
+        const Sprite* first_;
+        std::vector<uint32_t> indices_;
+    };
+}  // namespace rainbow::graphics
+
+#endif
@@ -0,0 +1,186 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/StateCache.h"
+
+#include <limits>
+
+#include "Common/Logging.h"
+
+using rainbow::graphics::StateCache;
+
+void StateCache::active_texture(uint32_t unit)
+{
+    R_ASSERT(unit < kMaxTextureUnits, "Texture unit out of range");
+
+    if (update(active_texture_, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void StateCache::bind_array_buffer(GLuint buffer)
+{
+    if (update(array_buffer_, buffer))
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+void StateCache::bind_element_buffer(GLuint buffer)
+{
+    if (update(element_buffer_, buffer))
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+}
+
+void StateCache::bind_pixel_unpack_buffer([[maybe_unused]] GLuint buffer)
+{
+#ifdef USE_PIXEL_UNPACK_BUFFER
+    if (update(pixel_unpack_buffer_, buffer))
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+#endif
+}
+
+void StateCache::bind_texture(uint32_t unit, GLuint texture)
+{
+    active_texture(unit);
+    if (update(textures_[unit], texture))
+        glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void StateCache::bind_vertex_array([[maybe_unused]] GLuint array)
+{
+#ifdef USE_VERTEX_ARRAY_OBJECT
+    if (update(vertex_array_, array))
+    {
+        glBindVertexArray(array);
+        element_buffer_ = kUnknown;
+    }
+#endif
+}
+
+void StateCache::blend_func(GLenum src, GLenum dst)
+{
+    if (update(blend_func_, {src, dst, src, dst}))
+        glBlendFunc(src, dst);
+}
+
+void StateCache::blend_func_separate(GLenum src_rgb,
+                                     GLenum dst_rgb,
+                                     GLenum src_alpha,
+                                     GLenum dst_alpha)
+{
+    if (update(blend_func_, {src_rgb, dst_rgb, src_alpha, dst_alpha}))
+        glBlendFuncSeparate(src_rgb, dst_rgb, src_alpha, dst_alpha);
+}
+
+void StateCache::disable(GLenum cap)
+{
+    set_enabled(cap, false);
+}
+
+void StateCache::enable(GLenum cap)
+{
+    set_enabled(cap, true);
+}
+
+void StateCache::delete_buffer(GLuint buffer)
+{
+    // Deleted objects are unbound by the driver, and their names may be
+    // handed out again.
+    if (array_buffer_ == buffer)
+        array_buffer_ = 0;
+    if (element_buffer_ == buffer)
+        element_buffer_ = 0;
+    if (pixel_unpack_buffer_ == buffer)
+        pixel_unpack_buffer_ = 0;
+
+    glDeleteBuffers(1, &buffer);
+}
+
+void StateCache::delete_texture(GLuint texture)
+{
+    for (auto&& bound : textures_)
+    {
+        if (bound == texture)
+            bound = 0;
+    }
+
+    glDeleteTextures(1, &texture);
+}
+
+void StateCache::delete_vertex_array([[maybe_unused]] GLuint array)
+{
+#ifdef USE_VERTEX_ARRAY_OBJECT
+    if (vertex_array_ == array)
+    {
+        vertex_array_ = 0;
+        element_buffer_ = kUnknown;
+    }
+
+    glDeleteVertexArrays(1, &array);
+#endif
+}
+
+void StateCache::forget_program(GLuint program)
+{
+    // A program in use is only flagged for deletion; make sure the next use
+    // of its name is issued.
+    if (program_ == program)
+        program_ = kUnknown;
+}
+
+void StateCache::invalidate()
+{
+    program_ = kUnknown;
+    vertex_array_ = kUnknown;
+    array_buffer_ = kUnknown;
+    element_buffer_ = kUnknown;
+    pixel_unpack_buffer_ = kUnknown;
+    active_texture_ = kUnknown;
+    textures_.fill(kUnknown);
+    blend_func_.fill(kUnknown);
+    scissor_.fill(std::numeric_limits<GLint>::min());
+    blend_ = Toggle::Unknown;
+    scissor_test_ = Toggle::Unknown;
+}
+
+void StateCache::next_frame()
+{
+    count_ = accumulator_;
+    accumulator_ = {};
+}
+
+void StateCache::scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (update(scissor_, {x, y, width, height}))
+        glScissor(x, y, width, height);
+}
+
+void StateCache::use_program(GLuint program)
+{
+    if (update(program_, program))
+        glUseProgram(program);
+}
+
+void StateCache::set_enabled(GLenum cap, bool enable)
+{
+    const auto toggle = enable ? Toggle::Enabled : Toggle::Disabled;
+    switch (cap)
+    {
+        case GL_BLEND:
+            if (!update(blend_, toggle))
+                return;
+            break;
+        case GL_SCISSOR_TEST:
+            if (!update(scissor_test_, toggle))
+                return;
+            break;
+        default:
+            // Other capabilities are rarely toggled and are not tracked.
+            ++accumulator_.issued;
+            break;
+    }
+
+    if (enable)
+        glEnable(cap);
+    else
+        glDisable(cap);
+}
@@ -0,0 +1,161 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_STATECACHE_H_
+#define GRAPHICS_STATECACHE_H_
+
+#include <array>
+#include <cstdint>
+
+#include "Common/NonCopyable.h"
+#include "Graphics/OpenGL.h"
+
+namespace rainbow::graphics
+{
+    struct StateChangeCount
+    {
+        /// <summary>Number of state changes passed on to the driver.</summary>
+        unsigned int issued;
+
+        /// <summary>Number of redundant state changes dropped.</summary>
+        unsigned int elided;
+    };
+
+    /// <summary>
+    ///   Shadows bound objects and fixed-function state of the GL context, and
+    ///   drops calls that would not change anything.
+    /// </summary>
+    /// <remarks>
+    ///   The cache only works if every bind and state change goes through it.
+    ///   State is unknown until first set, and after
+    ///   <see cref="invalidate"/>, in which case the call is always issued.
+    /// </remarks>
+    class StateCache : private NonCopyable<StateCache>
+    {
+    public:
+        static constexpr uint32_t kMaxTextureUnits = 32;
+
+        StateCache() { invalidate(); }
+
+        /// <summary>
+        ///   Returns the number of state changes issued and elided last frame.
+        /// </summary>
+        [[nodiscard]] auto count() const { return count_; }
+
+        void active_texture(uint32_t unit);
+        void bind_array_buffer(GLuint buffer);
+
+        /// <summary>
+        ///   Binds <paramref name="buffer"/> to the element array of the bound
+        ///   vertex array object.
+        /// </summary>
+        void bind_element_buffer(GLuint buffer);
+
+        /// <summary>
+        ///   Binds <paramref name="buffer"/> as the source of texture uploads.
+        ///   Unbind it before uploading from client memory.
+        /// </summary>
+        void bind_pixel_unpack_buffer(GLuint buffer);
+
+        void bind_texture(uint32_t unit, GLuint texture);
+
+        /// <summary>
+        ///   Binds vertex array object <paramref name="array"/>. Since the
+        ///   element array binding is part of its state, it becomes unknown.
+        /// </summary>
+        void bind_vertex_array(GLuint array);
+
+        void blend_func(GLenum src, GLenum dst);
+
+        /// <summary>
+        ///   Sets separate blend functions for colour and alpha channels.
+        /// </summary>
+        void blend_func_separate(GLenum src_rgb,
+                                 GLenum dst_rgb,
+                                 GLenum src_alpha,
+                                 GLenum dst_alpha);
+
+        void disable(GLenum cap);
+        void enable(GLenum cap);
+
+        /// <summary>
+        ///   Deletes the buffer object and resets any binding to it.
+        /// </summary>
+        void delete_buffer(GLuint buffer);
+
+        /// <summary>Deletes the texture and resets any binding to it.</summary>
+        void delete_texture(GLuint texture);
+
+        /// <summary>
+        ///   Deletes the vertex array object and resets any binding to it.
+        /// </summary>
+        void delete_vertex_array(GLuint array);
+
+        /// <summary>
+        ///   Forgets <paramref name="program"/> before it is deleted.
+        /// </summary>
+        void forget_program(GLuint program);
+
+        /// <summary>
+        ///   Marks all state as unknown, e.g. after third-party code has made
+        ///   GL calls directly.
+        /// </summary>
+        void invalidate();
+
+        /// <summary>
+        ///   Publishes this frame's counts for <see cref="count"/> and resets
+        ///   them.
+        /// </summary>
+        void next_frame();
+
+        void scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+        void use_program(GLuint program);
+
+    private:
+        static constexpr GLuint kUnknown = ~GLuint{0};
+
+        enum class Toggle : uint8_t
+        {
+            Unknown,
+            Disabled,
+            Enabled,
+        };
+
+        GLuint program_;
+        GLuint vertex_array_;
+        GLuint array_buffer_;
+        GLuint element_buffer_;
+        GLuint pixel_unpack_buffer_;
+        uint32_t active_texture_;
+        std::array<GLuint, kMaxTextureUnits> textures_;
+        std::array<GLenum, 4> blend_func_;
+        std::array<GLint, 4> scissor_;
+        Toggle blend_;
+        Toggle scissor_test_;
+        StateChangeCount count_{};
+        StateChangeCount accumulator_{};
+
+        void set_enabled(GLenum cap, bool enable);
+
+        /// <summary>
+        ///   Stores <paramref name="value"/> and returns whether it differs
+        ///   from the cached state, i.e. whether the call must be issued.
+        /// </summary>
+        template <typename T>
+        auto update(T& cached, const T& value) -> bool
+        {
+            if (cached == value)
+            {
+                ++accumulator_.elided;
+                return false;
+            }
+
+            cached = value;
+            ++accumulator_.issued;
+            return true;
+        }
+    };
+}  // namespace rainbow::graphics
+
+#endif
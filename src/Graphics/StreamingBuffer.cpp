@@ -0,0 +1,156 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/StreamingBuffer.h"
+
+#include "Common/Logging.h"
+#include "Graphics/Renderer.h"
+
+using rainbow::graphics::StreamingBuffer;
+
+namespace
+{
+    constexpr size_t kBufferSize =
+        StreamingBuffer::kFrameCount * StreamingBuffer::kFrameSize;
+
+#ifdef USE_STREAMING_BUFFER
+    /// <summary>Time to wait for a fence per try, in nanoseconds.</summary>
+    constexpr GLuint64 kFenceTimeout = 1000000;
+
+    void wait(GLsync& fence)
+    {
+        if (fence == nullptr)
+            return;
+
+        GLenum result = GL_TIMEOUT_EXPIRED;
+        while (result == GL_TIMEOUT_EXPIRED)
+        {
+            result = glClientWaitSync(
+                fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeout);
+        }
+
+        R_ASSERT(result != GL_WAIT_FAILED, "Failed to wait for fence");
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+#endif  // USE_STREAMING_BUFFER
+}  // namespace
+
+StreamingBuffer::~StreamingBuffer()
+{
+#ifdef USE_STREAMING_BUFFER
+    if (buffer_ == 0)
+        return;
+
+    for (auto&& fence : fences_)
+    {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+    }
+
+    // The state cache is torn down with the context that owns this buffer.
+    if (data_ != nullptr)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    glDeleteBuffers(1, &buffer_);
+#endif  // USE_STREAMING_BUFFER
+}
+
+void StreamingBuffer::initialize()
+{
+#ifdef USE_STREAMING_BUFFER
+    if (!has_gl_version(3, 2) && !(has_extension("GL_ARB_map_buffer_range") &&
+                                   has_extension("GL_ARB_sync")))
+    {
+        LOGI("Streaming buffer is not supported");
+        return;
+    }
+
+    auto& state = state_cache();
+    glGenBuffers(1, &buffer_);
+    state.bind_array_buffer(buffer_);
+
+    if (has_gl_version(4, 4) || has_extension("GL_ARB_buffer_storage"))
+    {
+        constexpr GLbitfield kFlags =
+            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, kBufferSize, nullptr, kFlags);
+        data_ = static_cast<uint8_t*>(
+            glMapBufferRange(GL_ARRAY_BUFFER, 0, kBufferSize, kFlags));
+        mode_ = Mode::Persistent;
+    }
+
+    if (data_ == nullptr)
+    {
+        glBufferData(GL_ARRAY_BUFFER, kBufferSize, nullptr, GL_STREAM_DRAW);
+        mode_ = Mode::Unsynchronized;
+    }
+
+    if (glGetError() != GL_NO_ERROR)
+    {
+        LOGW("Failed to create streaming buffer");
+        state.delete_buffer(buffer_);
+        buffer_ = 0;
+        data_ = nullptr;
+        mode_ = Mode::Disabled;
+    }
+#endif  // USE_STREAMING_BUFFER
+}
+
+auto StreamingBuffer::map([[maybe_unused]] size_t size,
+                          [[maybe_unused]] size_t alignment) -> Allocation
+{
+#ifdef USE_STREAMING_BUFFER
+    if (mode_ == Mode::Disabled || size == 0)
+        return {};
+
+    const auto padding = (alignment - head_ % alignment) % alignment;
+    if (head_ + padding + size > kFrameSize)
+        return {};
+
+    const auto offset = frame_ * kFrameSize + head_ + padding;
+    head_ += padding + size;
+
+    if (mode_ == Mode::Persistent)
+        return {data_ + offset, offset, size};
+
+    constexpr GLbitfield kFlags = GL_MAP_WRITE_BIT |
+                                  GL_MAP_INVALIDATE_RANGE_BIT |
+                                  GL_MAP_UNSYNCHRONIZED_BIT;
+    state_cache().bind_array_buffer(buffer_);
+    auto data = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, kFlags);
+    return {data, offset, size};
+#else
+    return {};
+#endif  // USE_STREAMING_BUFFER
+}
+
+void StreamingBuffer::unmap(const Allocation&)
+{
+#ifdef USE_STREAMING_BUFFER
+    if (mode_ != Mode::Unsynchronized)
+        return;
+
+    state_cache().bind_array_buffer(buffer_);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+#endif  // USE_STREAMING_BUFFER
+}
+
+void StreamingBuffer::next_frame()
+{
+#ifdef USE_STREAMING_BUFFER
+    if (mode_ == Mode::Disabled)
+        return;
+
+    fences_[frame_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame_ = (frame_ + 1) % kFrameCount;
+    head_ = 0;
+    wait(fences_[frame_]);
+#endif  // USE_STREAMING_BUFFER
+}
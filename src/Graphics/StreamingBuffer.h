@@ -0,0 +1,106 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_STREAMINGBUFFER_H_
+#define GRAPHICS_STREAMINGBUFFER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "Common/NonCopyable.h"
+#include "Graphics/OpenGL.h"
+
+namespace rainbow::graphics
+{
+    /// <summary>
+    ///   Triple-buffered ring of vertex memory for data that is re-uploaded
+    ///   every frame.
+    /// </summary>
+    /// <remarks>
+    ///   The ring is split into one segment per frame in flight. Where GL 4.4
+    ///   or <c>GL_ARB_buffer_storage</c> is available, the whole buffer is
+    ///   persistently mapped. Otherwise, each allocation is mapped with
+    ///   <c>GL_MAP_UNSYNCHRONIZED_BIT</c>. In both cases, a fence is inserted
+    ///   at the end of every frame so that a segment is not overwritten while
+    ///   the GPU is still reading from it. On platforms where neither is
+    ///   supported, the ring is disabled and callers must fall back to regular
+    ///   buffer uploads.
+    /// </remarks>
+    class StreamingBuffer : NonCopyable<StreamingBuffer>
+    {
+    public:
+        /// <summary>Number of frames in flight.</summary>
+        static constexpr size_t kFrameCount = 3;
+
+        /// <summary>Size of each frame's segment, in bytes.</summary>
+        static constexpr size_t kFrameSize = 2 * 1024 * 1024;
+
+        enum class Mode
+        {
+            Disabled,
+            Unsynchronized,
+            Persistent,
+        };
+
+        struct Allocation
+        {
+            void* data = nullptr;
+            size_t offset = 0;
+            size_t size = 0;
+
+            explicit operator bool() const { return data != nullptr; }
+        };
+
+        StreamingBuffer() = default;
+        ~StreamingBuffer();
+
+        /// <summary>Returns the name of the underlying buffer object.</summary>
+        [[nodiscard]] auto id() const { return buffer_; }
+
+        [[nodiscard]] auto is_enabled() const
+        {
+            return mode_ != Mode::Disabled;
+        }
+
+        [[nodiscard]] auto mode() const { return mode_; }
+
+        /// <summary>
+        ///   Creates the buffer object using the best method the driver
+        ///   supports.
+        /// </summary>
+        void initialize();
+
+        /// <summary>
+        ///   Reserves <paramref name="size"/> bytes in the current frame's
+        ///   segment and maps it for writing.
+        /// </summary>
+        /// <returns>
+        ///   The mapped allocation, or an empty allocation if the ring is
+        ///   disabled or the segment is full.
+        /// </returns>
+        auto map(size_t size, size_t alignment) -> Allocation;
+
+        /// <summary>Finishes writing to an allocation.</summary>
+        void unmap(const Allocation&);
+
+        /// <summary>
+        ///   Fences the current segment and moves on to the next one, waiting
+        ///   for the GPU to finish with it if necessary.
+        /// </summary>
+        void next_frame();
+
+    private:
+        Mode mode_ = Mode::Disabled;
+        unsigned int buffer_ = 0;
+        uint8_t* data_ = nullptr;
+        size_t frame_ = 0;
+        size_t head_ = 0;
+#ifdef USE_STREAMING_BUFFER
+        std::array<GLsync, kFrameCount> fences_{};
+#endif
+    };
+}  // namespace rainbow::graphics
+
+#endif
@@ -4,14 +4,26 @@
 
 #include "Graphics/Texture.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+#include <imgui/imstb_rectpack.h>
+
 #include "Common/Logging.h"
+#include "Common/TypeCast.h"
 #include "FileSystem/File.h"
+#include "FileSystem/FileSystem.h"
 #include "Graphics/Image.h"
+#include "Threading/JobPool.h"
 
 using rainbow::Data;
 using rainbow::File;
 using rainbow::FileType;
 using rainbow::Image;
+using rainbow::JobPool;
 using rainbow::Passkey;
 using rainbow::graphics::Filter;
 using rainbow::graphics::ITextureAllocator;
@@ -19,8 +31,215 @@ using rainbow::graphics::Texture;
 using rainbow::graphics::TextureData;
 using rainbow::graphics::TextureProvider;
 
+namespace
+{
+    /// <summary>
+    ///   Border around packed images, filled with their edge pixels so that
+    ///   filtering does not sample neighbours.
+    /// </summary>
+    constexpr uint32_t kAtlasPadding = 1;
+
+    constexpr uint32_t kBytesPerPixel = 4;
+
+    constexpr uint8_t kTransparentPixel[kBytesPerPixel]{};
+
+    auto transparent_image()
+    {
+        return Image{Image::Format::RGBA,
+                     1U,
+                     1U,
+                     32U,
+                     4U,
+                     sizeof(kTransparentPixel),
+                     kTransparentPixel};
+    }
+
+    auto can_pack(const Image& image)
+    {
+        switch (image.format)
+        {
+            case Image::Format::PNG:
+            case Image::Format::RGBA:
+            case Image::Format::SVG:
+                return image.channels == 4 && image.depth == 32 &&
+                       image.mip_levels == 1 && image.data != nullptr &&
+                       image.width > 0 && image.height > 0 &&
+                       image.width <= TextureProvider::kMaxAtlasImageSize &&
+                       image.height <= TextureProvider::kMaxAtlasImageSize;
+            default:
+                return false;
+        }
+    }
+
+    /// <summary>
+    ///   Returns whether the image described by <paramref name="header"/> can
+    ///   be uploaded as is, i.e. decoded straight into a staging buffer.
+    /// </summary>
+    auto can_stage(const Image& header, bool packable)
+    {
+        return header.format != Image::Format::Unknown &&
+               !(packable &&
+                 header.width <= TextureProvider::kMaxAtlasImageSize &&
+                 header.height <= TextureProvider::kMaxAtlasImageSize);
+    }
+
+    /// <summary>
+    ///   Returns <paramref name="image"/> with the requested mip levels,
+    ///   unless it is going to be packed into an atlas page.
+    /// </summary>
+    auto prepare(Image&& image, uint32_t skip_levels, bool chain, bool packable)
+    {
+        if ((skip_levels == 0 && !chain && image.mip_levels == 1) ||
+            (packable && can_pack(image)))
+        {
+            return std::move(image);
+        }
+
+        return Image::with_mipmaps(std::move(image), skip_levels, chain);
+    }
+
+    struct PaddedImage
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+        std::unique_ptr<uint8_t[]> pixels;
+        uint32_t width;
+        uint32_t height;
+
+        [[nodiscard]] auto image() const
+        {
+            return Image{Image::Format::RGBA,
+                         width,
+                         height,
+                         32U,
+                         4U,
+                         size_t{width} * height * kBytesPerPixel,
+                         pixels.get()};
+        }
+    };
+
+    /// <summary>
+    ///   Returns a copy of <paramref name="image"/> with its edges extruded by
+    ///   <c>kAtlasPadding</c> pixels.
+    /// </summary>
+    auto extrude(const Image& image) -> PaddedImage
+    {
+        const auto width = image.width + kAtlasPadding * 2;
+        const auto height = image.height + kAtlasPadding * 2;
+        const auto row_size = image.width * kBytesPerPixel;
+        const auto padded_row_size = width * kBytesPerPixel;
+
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+        auto pixels = std::make_unique<uint8_t[]>(padded_row_size * height);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const auto src_y =
+                std::clamp(y, kAtlasPadding, image.height + kAtlasPadding - 1) -
+                kAtlasPadding;
+            const auto src = image.data + src_y * row_size;
+            auto dst = pixels.get() + y * padded_row_size;
+            for (uint32_t x = 0; x < kAtlasPadding; ++x)
+            {
+                std::memcpy(dst + x * kBytesPerPixel, src, kBytesPerPixel);
+                std::memcpy(dst + (width - 1 - x) * kBytesPerPixel,
+                            src + row_size - kBytesPerPixel,
+                            kBytesPerPixel);
+            }
+            std::memcpy(dst + kAtlasPadding * kBytesPerPixel, src, row_size);
+        }
+
+        return {std::move(pixels), width, height};
+    }
+}  // namespace
+
+struct TextureProvider::AtlasPage
+{
+    std::string key;
+    TextureHandle data{};
+    Filter mag_filter = Filter::Linear;
+    Filter min_filter = Filter::Linear;
+
+    /// <summary>Number of textures packed into this page.</summary>
+    uint32_t use_count = 0;
+
+    stbrp_context packer{};
+    std::vector<stbrp_node> nodes;
+
+    explicit AtlasPage(uint32_t index)
+        : key("rainbow://atlas/" + std::to_string(index)),
+          nodes(kAtlasPageSize)
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        stbrp_init_target(&packer,
+                          kAtlasPageSize,
+                          kAtlasPageSize,
+                          nodes.data(),
+                          narrow_cast<int>(nodes.size()));
+    }
+};
+
+struct TextureProvider::AsyncLoad
+{
+    std::string path;
+    std::string source;
+    float scale;
+    Filter mag_filter;
+    Filter min_filter;
+    uint32_t skip_levels;
+    bool mipmaps;
+    bool packable;
+    std::vector<Callback> callbacks;
+    JobPool* job_pool;
+
+    /// <summary>
+    ///   Whether the worker may stop after reading the image header, to have
+    ///   it decoded into a staging buffer.
+    /// </summary>
+    bool stage;
+
+    /// <summary>Size of the staging buffer requested by the worker.</summary>
+    size_t staging_size = 0;
+
+    /// <summary>
+    ///   Staging buffer to decode into. Set on the main thread.
+    /// </summary>
+    uint8_t* staging = nullptr;
+
+    /// <summary>
+    ///   File contents; compressed images point into it. Set by the worker.
+    /// </summary>
+    std::optional<Data> file;
+
+    /// <summary>Logical size of the image. Set by the worker.</summary>
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    /// <summary>
+    ///   Decoded image; set by the worker while holding the queue's mutex.
+    /// </summary>
+    std::optional<Image> image;
+
+    /// <summary>
+    ///   Returns whether the worker is waiting for a staging buffer. Must be
+    ///   called while holding the queue's mutex.
+    /// </summary>
+    [[nodiscard]] auto needs_staging() const
+    {
+        return staging_size > 0 && staging == nullptr;
+    }
+};
+
+struct TextureProvider::AsyncQueue
+{
+    std::mutex mutex;
+    std::condition_variable decoded;
+};
+
 TextureProvider::TextureProvider(ITextureAllocator& allocator)
-    : allocator_(allocator)
+    : allocator_(allocator), async_queue_(std::make_shared<AsyncQueue>())
 {
     R_ASSERT(Texture::s_texture_provider == nullptr,  //
              "An instance already exists");
@@ -34,8 +253,39 @@ TextureProvider::~TextureProvider()
 
     Texture::s_texture_provider = nullptr;
 
+    // Workers may still be decoding; they only hold on to shared state, save
+    // for staging buffers which must outlive them.
+    for (auto* loads : {&pending_, &cancelled_})
+    {
+        for (auto&& load : *loads)
+        {
+            if (load->staging == nullptr)
+                continue;
+
+            {
+                std::unique_lock<std::mutex> lock(async_queue_->mutex);
+                async_queue_->decoded.wait(
+                    lock, [&load] { return load->image.has_value(); });
+            }
+            allocator_.discard_staging(load->staging);
+        }
+    }
+
     for (auto&& texture : texture_map_)
-        allocator_.destroy(texture.second.data);
+    {
+        auto& data = texture.second;
+        if (data.page == 0 && data.revision > 0 && !data.evicted)
+            allocator_.destroy(data.data);
+    }
+
+    for (auto&& page : atlas_pages_)
+    {
+        if (page->use_count > 0)
+            allocator_.destroy(page->data);
+    }
+
+    if (placeholder_ != TextureHandle{})
+        allocator_.destroy(placeholder_);
 }
 
 template <typename T>
@@ -46,16 +296,37 @@ auto TextureProvider::get(std::string_view path,
                           Filter min_filter) -> Texture
 {
     auto [iter, inserted] = texture_map_.emplace(path, TextureData{});
+    if (!inserted && iter->second.revision == 0)
+    {
+        // Already being loaded asynchronously; callers expect it to be
+        // usable immediately.
+        Texture texture{path, Passkey<TextureProvider>{}};
+        wait(texture);
+        iter = texture_map_.find(path);
+        ++iter->second.use_count;
+        return texture;
+    }
+
     if (inserted)
     {
         if constexpr (std::is_same_v<T, std::nullptr_t>)
         {
-            auto file = File::read(path.data(), FileType::Asset);
-            load(iter, Image::decode(file, scale), mag_filter, min_filter);
+            auto file = File::read(resolve(path).c_str(), FileType::Asset);
+            auto staged = decode_staged(file, atlas_enabled_);
+            auto image = staged.format != Image::Format::Unknown
+                             ? std::move(staged)
+                             : Image::decode(file, scale, job_pool_);
+            const bool decoded = image.format != Image::Format::Unknown;
+            load_decoded(iter, std::move(image), mag_filter, min_filter);
+            if (decoded)
+                set_reloadable(iter->second, scale, mag_filter, min_filter);
         }
         else if constexpr (std::is_same_v<T, const Data&>)
         {
-            load(iter, Image::decode(data, scale), mag_filter, min_filter);
+            load_decoded(iter,
+                         Image::decode(data, scale, job_pool_),
+                         mag_filter,
+                         min_filter);
         }
         else if constexpr (std::is_same_v<T, const Image&>)
         {
@@ -91,6 +362,114 @@ auto TextureProvider::get(std::string_view path,
     return get<const Image&>(path, image, 1.0F, mag_filter, min_filter);
 }
 
+auto TextureProvider::get_async(JobPool& job_pool,
+                                std::string_view path,
+                                Callback callback,
+                                float scale,
+                                Filter mag_filter,
+                                Filter min_filter) -> Texture
+{
+    auto [iter, inserted] = texture_map_.emplace(path, TextureData{});
+    ++iter->second.use_count;
+
+    if (!inserted)
+    {
+        if (callback)
+        {
+            auto load = std::find_if(
+                pending_.begin(), pending_.end(), [path](auto&& load) {
+                    return load->path == path;
+                });
+            if (load != pending_.end())
+                (*load)->callbacks.push_back(std::move(callback));
+            else
+                deferred_callbacks_.emplace_back(path, std::move(callback));
+        }
+        return Texture{path, Passkey<TextureProvider>{}};
+    }
+
+    if (placeholder_ == TextureHandle{})
+    {
+        allocator_.construct(placeholder_,
+                             transparent_image(),
+                             Filter::Nearest,
+                             Filter::Nearest);
+    }
+
+    auto& texture = iter->second;
+    texture.data = placeholder_;
+    texture.width = 1;
+    texture.height = 1;
+
+    auto load = std::make_shared<AsyncLoad>();
+    load->path = path;
+    load->source = resolve(path);
+    load->scale = scale;
+    load->mag_filter = mag_filter;
+    load->min_filter = min_filter;
+    load->skip_levels = skipped_mip_levels_;
+    load->mipmaps = mipmaps_enabled_;
+    load->packable = atlas_enabled_;
+    load->job_pool = &job_pool;
+    load->stage = allocator_.has_staging() && !mipmaps_enabled_ &&
+                  skipped_mip_levels_ == 0;
+    if (callback)
+        load->callbacks.push_back(std::move(callback));
+    pending_.push_back(load);
+    submit(load);
+
+    return Texture{path, Passkey<TextureProvider>{}};
+}
+
+auto TextureProvider::evict(size_t bytes) -> size_t
+{
+    std::vector<TextureData*> candidates;
+    for (auto&& texture : texture_map_)
+    {
+        auto& data = texture.second;
+        if (data.reloadable && !data.evicted && data.page == 0 &&
+            frame_ - data.last_used >= eviction_age_)
+        {
+            candidates.push_back(&data);
+        }
+    }
+
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [](const TextureData* a, const TextureData* b) {
+                  return a->last_used < b->last_used;
+              });
+
+    size_t freed = 0;
+    for (auto&& texture : candidates)
+    {
+        if (freed >= bytes)
+            break;
+
+        allocator_.destroy(texture->data);
+        texture->data = {};
+        texture->evicted = true;
+        freed += texture->size;
+    }
+
+    mem_used_ -= freed;
+    mem_evicted_ += freed;
+    return freed;
+}
+
+auto TextureProvider::is_loaded(const Texture& texture) const -> bool
+{
+    auto iter = texture_map_.find(texture.key());
+    return iter != texture_map_.end() && iter->second.revision > 0;
+}
+
+void TextureProvider::next_frame()
+{
+    ++frame_;
+    if (memory_budget_ > 0 && mem_used_ > memory_budget_)
+        evict(mem_used_ - memory_budget_);
+}
+
 auto TextureProvider::raw_get(const Texture& texture) const -> TextureData
 {
     auto iter = texture_map_.find(texture.key());
@@ -106,12 +485,49 @@ void TextureProvider::release(const Texture& texture)
     auto& texture_data = iter->second;
     if (--texture_data.use_count == 0)
     {
-        IF_DEVMODE(mem_used_ -= texture_data.size);
-        allocator_.destroy(texture_data.data);
+        if (texture_data.revision == 0)
+        {
+            // Still loading; the worker's result will simply be discarded.
+            auto load = std::find_if(pending_.begin(),
+                                     pending_.end(),
+                                     [key = texture.key()](auto&& load) {
+                                         return load->path == key;
+                                     });
+            if (load != pending_.end())
+            {
+                // The worker may still be writing to its staging buffer.
+                if ((*load)->staging != nullptr)
+                    cancelled_.push_back(*load);
+                pending_.erase(load);
+            }
+        }
+        else if (texture_data.evicted)
+        {
+            mem_evicted_ -= texture_data.size;
+        }
+        else if (texture_data.page == 0)
+        {
+            mem_used_ -= texture_data.size;
+            allocator_.destroy(texture_data.data);
+        }
+        else
+        {
+            release_page(texture_data.page);
+        }
         texture_map_.erase(iter);
     }
 }
 
+auto TextureProvider::storage_key(const Texture& texture) const
+    -> std::string_view
+{
+    auto iter = texture_map_.find(texture.key());
+    if (iter == texture_map_.end() || iter->second.page == 0)
+        return texture.key();
+
+    return atlas_pages_[iter->second.page - 1]->key;
+}
+
 auto TextureProvider::try_get(const Texture& texture)
     -> std::optional<TextureData>
 {
@@ -128,24 +544,489 @@ void TextureProvider::update(const Texture& texture,
                              Filter mag_filter,
                              Filter min_filter)
 {
-    allocator_.update(raw_get(texture).data, image, mag_filter, min_filter);
+    auto iter = texture_map_.find(texture.key());
+    R_ASSERT(iter->second.revision > 0, "Texture is still being loaded");
+
+    if (iter->second.evicted)
+        reload(iter);
+
+    // Contents no longer match the file.
+    iter->second.reloadable = false;
+
+    const auto& texture_data = iter->second;
+    if (texture_data.page == 0)
+    {
+        allocator_.update(texture_data.data, image, mag_filter, min_filter);
+        return;
+    }
+
+    R_ASSERT(image.width == texture_data.width &&
+                 image.height == texture_data.height && can_pack(image),
+             "Packed textures can only be updated with same-sized RGBA images");
+
+    allocator_.update_region(texture_data.data,
+                             texture_data.offset_x - kAtlasPadding,
+                             texture_data.offset_y - kAtlasPadding,
+                             extrude(image).image());
+}
+
+void TextureProvider::update_region(const Texture& texture,
+                                    uint32_t x,
+                                    uint32_t y,
+                                    const Image& image)
+{
+    auto iter = texture_map_.find(texture.key());
+    R_ASSERT(iter->second.revision > 0, "Texture is still being loaded");
+
+    if (iter->second.evicted)
+        reload(iter);
+
+    // Contents no longer match the file.
+    iter->second.reloadable = false;
+
+    const auto& texture_data = iter->second;
+    R_ASSERT(x + image.width <= texture_data.width &&
+                 y + image.height <= texture_data.height,
+             "Region is out of bounds");
+
+    allocator_.update_region(texture_data.data,
+                             texture_data.offset_x + x,
+                             texture_data.offset_y + y,
+                             image);
+}
+
+void TextureProvider::upload_pending()
+{
+    // Workers that have read an image header need somewhere to decode to.
+    std::vector<std::shared_ptr<AsyncLoad>> staging;
+    {
+        std::lock_guard<std::mutex> lock(async_queue_->mutex);
+        for (auto&& load : pending_)
+        {
+            if (load->needs_staging())
+                staging.push_back(load);
+        }
+
+        auto discarded = std::partition(
+            cancelled_.begin(), cancelled_.end(), [](auto&& load) {
+                return !load->image.has_value();
+            });
+        for (auto i = discarded; i != cancelled_.end(); ++i)
+            allocator_.discard_staging((*i)->staging);
+        cancelled_.erase(discarded, cancelled_.end());
+    }
+
+    for (auto&& load : staging)
+        stage(load);
+
+    std::vector<std::shared_ptr<AsyncLoad>> ready;
+    {
+        std::lock_guard<std::mutex> lock(async_queue_->mutex);
+        auto budget = upload_budget_ == 0 ? std::numeric_limits<size_t>::max()
+                                          : upload_budget_;
+        for (auto&& load : pending_)
+        {
+            // Preserve request order so that e.g. a loading screen's own
+            // textures appear before the level's.
+            if (!load->image.has_value())
+                break;
+
+            const auto size = load->image->size;
+            if (!ready.empty() && size > budget)
+                break;
+
+            budget -= std::min(size, budget);
+            ready.push_back(load);
+        }
+    }
+
+    pending_.erase(pending_.begin(), pending_.begin() + ready.size());
+    for (auto&& load : ready)
+        finish(*load);
+
+    // Callbacks may request or release textures, so run them last.
+    auto callbacks = std::move(deferred_callbacks_);
+    deferred_callbacks_.clear();
+    for (auto&& load : ready)
+    {
+        for (auto&& callback : load->callbacks)
+            callbacks.emplace_back(load->path, std::move(callback));
+    }
+
+    for (auto&& [path, callback] : callbacks)
+    {
+        auto iter = texture_map_.find(path);
+        if (iter == texture_map_.end())
+            continue;
+
+        callback(path, !iter->second.failed);
+    }
+}
+
+auto TextureProvider::use(const Texture& texture) -> const TextureData&
+{
+    auto iter = texture_map_.find(texture.key());
+    if (iter->second.evicted)
+        reload(iter);
+
+    iter->second.last_used = frame_;
+    return iter->second;
+}
+
+void TextureProvider::wait(const Texture& texture)
+{
+    auto load = std::find_if(
+        pending_.begin(), pending_.end(), [&texture](auto&& load) {
+            return load->path == texture.key();
+        });
+    if (load == pending_.end())
+        return;
+
+    auto request = *load;
+    for (bool decoded = false; !decoded;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(async_queue_->mutex);
+            async_queue_->decoded.wait(lock, [&request] {
+                return request->image.has_value() || request->needs_staging();
+            });
+            decoded = request->image.has_value();
+        }
+
+        if (!decoded)
+            stage(request);
+    }
+
+    pending_.erase(load);
+    finish(*request);
+
+    for (auto&& callback : request->callbacks)
+        deferred_callbacks_.emplace_back(request->path, std::move(callback));
+}
+
+void TextureProvider::wait(ArrayView<Texture> textures)
+{
+    for (auto&& texture : textures)
+        wait(texture);
+}
+
+void TextureProvider::finish(AsyncLoad& request)
+{
+    auto iter = texture_map_.find(request.path);
+    R_ASSERT(iter != texture_map_.end(), "Cancelled loads should be gone");
+
+    const auto& image = *request.image;
+    if (image.format == Image::Format::Unknown)
+    {
+        if (request.staging != nullptr)
+            allocator_.discard_staging(request.staging);
+
+        LOGE("Failed to load texture: %s", request.path.c_str());
+        load(iter, transparent_image(), Filter::Nearest, Filter::Nearest);
+        iter->second.failed = true;
+        return;
+    }
+
+    load(iter,
+         image,
+         request.mag_filter,
+         request.min_filter,
+         request.packable);
+    iter->second.width = request.width;
+    iter->second.height = request.height;
+    set_reloadable(iter->second,
+                   request.scale,
+                   request.mag_filter,
+                   request.min_filter);
+}
+
+auto TextureProvider::decode_staged(const Data& file, bool packable) -> Image
+{
+    if (!file || !allocator_.has_staging() || mipmaps_enabled_ ||
+        skipped_mip_levels_ > 0)
+    {
+        return {};
+    }
+
+    const auto header = Image::probe(file);
+    if (!can_stage(header, packable))
+        return {};
+
+    auto buffer = allocator_.map_staging(header.size);
+    if (buffer == nullptr)
+        return {};
+
+    auto image = Image::decode_into(file, buffer);
+    if (image.format == Image::Format::Unknown)
+        allocator_.discard_staging(buffer);
+    return image;
 }
 
 void TextureProvider::load(TextureMap::iterator i,
                            const Image& image,
                            Filter mag_filter,
-                           Filter min_filter)
+                           Filter min_filter,
+                           bool packable)
 {
     R_ASSERT(allocator_.max_size() <= sizeof(TextureData::data),
              "Texture data size is too small for the current graphics API.");
 
     auto& texture = i->second;
+    ++texture.revision;
+    if (packable && pack(texture, image, mag_filter, min_filter))
+        return;
+
     allocator_.construct(texture.data, image, mag_filter, min_filter);
     texture.width = image.width;
     texture.height = image.height;
 
-    IF_DEVMODE(texture.size = image.size);
-    IF_DEVMODE(record_usage(image.size));
+    texture.size = narrow_cast<uint32_t>(image.size);
+    texture.last_used = frame_;
+    record_usage(image.size);
+}
+
+void TextureProvider::load_decoded(TextureMap::iterator i,
+                                   Image&& image,
+                                   Filter mag_filter,
+                                   Filter min_filter)
+{
+    const auto width = image.width;
+    const auto height = image.height;
+    load(i,
+         prepare(std::move(image),
+                 skipped_mip_levels_,
+                 mipmaps_enabled_,
+                 atlas_enabled_),
+         mag_filter,
+         min_filter,
+         atlas_enabled_);
+    i->second.width = width;
+    i->second.height = height;
+}
+
+auto TextureProvider::pack(TextureData& texture,
+                           const Image& image,
+                           Filter mag_filter,
+                           Filter min_filter) -> bool
+{
+    if (!can_pack(image))
+        return false;
+
+    stbrp_rect rect{0,
+                    narrow_cast<stbrp_coord>(image.width + kAtlasPadding * 2),
+                    narrow_cast<stbrp_coord>(image.height + kAtlasPadding * 2),
+                    0,
+                    0,
+                    0};
+
+    // Look for room on a page with matching filters, or an unused one.
+    uint32_t index = 0;
+    for (; index < atlas_pages_.size(); ++index)
+    {
+        auto& page = *atlas_pages_[index];
+        if (page.use_count > 0 && (page.mag_filter != mag_filter ||
+                                   page.min_filter != min_filter))
+        {
+            continue;
+        }
+
+        if (stbrp_pack_rects(&page.packer, &rect, 1) != 0)
+            break;
+    }
+
+    if (index == atlas_pages_.size())
+    {
+        atlas_pages_.push_back(std::make_unique<AtlasPage>(index));
+        if (stbrp_pack_rects(&atlas_pages_.back()->packer, &rect, 1) == 0)
+            return false;
+    }
+
+    auto& page = *atlas_pages_[index];
+    if (page.use_count == 0)
+    {
+        page.mag_filter = mag_filter;
+        page.min_filter = min_filter;
+        allocator_.construct(page.data,
+                             Image{Image::Format::RGBA,
+                                   kAtlasPageSize,
+                                   kAtlasPageSize,
+                                   32U,
+                                   4U,
+                                   0,
+                                   nullptr},
+                             mag_filter,
+                             min_filter);
+
+        record_usage(size_t{kAtlasPageSize} * kAtlasPageSize *
+                     kBytesPerPixel);
+    }
+    ++page.use_count;
+
+    texture.data = page.data;
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.offset_x = narrow_cast<uint32_t>(rect.x) + kAtlasPadding;
+    texture.offset_y = narrow_cast<uint32_t>(rect.y) + kAtlasPadding;
+    texture.page_width = kAtlasPageSize;
+    texture.page_height = kAtlasPageSize;
+    texture.page = index + 1;
+
+    allocator_.update_region(page.data,
+                             narrow_cast<uint32_t>(rect.x),
+                             narrow_cast<uint32_t>(rect.y),
+                             extrude(image).image());
+    return true;
+}
+
+void TextureProvider::release_page(uint32_t page)
+{
+    auto& atlas = *atlas_pages_[page - 1];
+    if (--atlas.use_count > 0)
+        return;
+
+    mem_used_ -= size_t{kAtlasPageSize} * kAtlasPageSize * kBytesPerPixel;
+    allocator_.destroy(atlas.data);
+    atlas.reset();
+}
+
+void TextureProvider::reload(TextureMap::iterator i)
+{
+    auto& texture = i->second;
+    const auto width = texture.width;
+    const auto height = texture.height;
+    const auto revision = texture.revision;
+
+    mem_evicted_ -= texture.size;
+    texture.evicted = false;
+
+    auto file = File::read(resolve(i->first).c_str(), FileType::Asset);
+    auto staged = decode_staged(file, false);
+    auto image = staged.format != Image::Format::Unknown
+                     ? std::move(staged)
+                     : prepare(Image::decode(file, texture.scale, job_pool_),
+                               skipped_mip_levels_,
+                               mipmaps_enabled_,
+                               false);
+    if (image.format == Image::Format::Unknown)
+    {
+        LOGE("Failed to reload texture: %s", i->first.c_str());
+        load(i, transparent_image(), Filter::Nearest, Filter::Nearest);
+        texture.failed = true;
+        texture.reloadable = false;
+    }
+    else
+    {
+        load(i, image, texture.mag_filter, texture.min_filter);
+    }
+
+    // Sprites only need to be refreshed if the texture changes.
+    texture.width = width;
+    texture.height = height;
+    texture.revision = revision;
+}
+
+auto TextureProvider::resolve(std::string_view path) const -> std::string
+{
+    std::string resolved{path};
+    if (texture_variants_.empty())
+        return resolved;
+
+    const auto dot = path.rfind('.');
+    if (dot == std::string_view::npos)
+        return resolved;
+
+    const auto extension = path.substr(dot);
+    if (extension != ".ktx" && extension != ".ktx2")
+        return resolved;
+
+    const auto stem = path.substr(0, dot + 1);
+    for (auto&& variant : texture_variants_)
+    {
+        resolved.assign(stem).append(variant).append(extension);
+        if (filesystem::exists(resolved.c_str()))
+            return resolved;
+    }
+
+    return std::string{path};
+}
+
+void TextureProvider::set_reloadable(TextureData& texture,
+                                     float scale,
+                                     Filter mag_filter,
+                                     Filter min_filter)
+{
+    // Packed textures share their page with others and are never evicted.
+    if (texture.page != 0)
+        return;
+
+    texture.reloadable = true;
+    texture.scale = scale;
+    texture.mag_filter = mag_filter;
+    texture.min_filter = min_filter;
+}
+
+void TextureProvider::stage(const std::shared_ptr<AsyncLoad>& load)
+{
+    load->staging = allocator_.map_staging(load->staging_size);
+    if (load->staging == nullptr)
+    {
+        // Fall back to decoding into memory of our own.
+        load->stage = false;
+        load->staging_size = 0;
+    }
+
+    submit(load);
+}
+
+void TextureProvider::submit(const std::shared_ptr<AsyncLoad>& load)
+{
+    load->job_pool->submit([queue = async_queue_, load] {
+        if (!load->file.has_value())
+        {
+            load->file.emplace(
+                File::read(load->source.c_str(), FileType::Asset));
+        }
+
+        const auto& file = *load->file;
+        if (load->staging != nullptr)
+        {
+            auto image = Image::decode_into(file, load->staging);
+
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            load->image.emplace(std::move(image));
+            queue->decoded.notify_all();
+            return;
+        }
+
+        if (file && load->stage)
+        {
+            const auto header = Image::probe(file);
+            if (can_stage(header, load->packable))
+            {
+                load->width = header.width;
+                load->height = header.height;
+
+                // Staging buffers can only be mapped on the main thread.
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                load->staging_size = header.size;
+                queue->decoded.notify_all();
+                return;
+            }
+        }
+
+        auto decoded = file ? Image::decode(file, load->scale, load->job_pool)
+                            : Image{};
+        load->width = decoded.width;
+        load->height = decoded.height;
+        auto image = prepare(std::move(decoded),
+                             load->skip_levels,
+                             load->mipmaps,
+                             load->packable);
+
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        load->image.emplace(std::move(image));
+        queue->decoded.notify_all();
+    });
 }
 
 TextureProvider* Texture::s_texture_provider = nullptr;
@@ -158,6 +1039,19 @@ Texture::~Texture()
     s_texture_provider->release(*this);
 }
 
+auto Texture::is_loaded() const -> bool
+{
+    return s_texture_provider != nullptr &&
+           s_texture_provider->is_loaded(*this);
+}
+
+auto Texture::storage_key() const -> std::string_view
+{
+    return s_texture_provider == nullptr
+               ? key()
+               : s_texture_provider->storage_key(*this);
+}
+
 auto Texture::operator=(const Texture& texture) -> Texture&
 {
     if (&texture == this)
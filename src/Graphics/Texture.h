@@ -6,16 +6,22 @@
 #define GRAPHICS_TEXTURE_H_
 
 #include <array>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "Common/NonCopyable.h"
 #include "Common/Passkey.h"
+#include "Memory/Array.h"
 #include "Memory/ArrayMap.h"
 
 namespace rainbow
 {
     class Data;
+    class JobPool;
     struct Image;
     struct ISolemnlySwearThatIAmOnlyTesting;
 }  // namespace rainbow
@@ -41,17 +47,104 @@ namespace rainbow::graphics
         uint32_t width = 0;
         uint32_t height = 0;
         uint32_t use_count = 0;
-#ifdef USE_HEIMDALL
         uint32_t size = 0;
-#endif
+
+        /// <summary>
+        ///   Offset of the image in its atlas page, in pixels.
+        /// </summary>
+        uint32_t offset_x = 0;
+        uint32_t offset_y = 0;
+
+        /// <summary>
+        ///   Size of the atlas page the image is packed into; zero if the image
+        ///   has its own texture object.
+        /// </summary>
+        uint32_t page_width = 0;
+        uint32_t page_height = 0;
+
+        /// <summary>
+        ///   One-based index of the atlas page; zero if unpacked.
+        /// </summary>
+        uint32_t page = 0;
+
+        /// <summary>
+        ///   Incremented every time an image is loaded into the texture; zero
+        ///   while an asynchronous load is pending.
+        /// </summary>
+        uint32_t revision = 0;
+
+        /// <summary>
+        ///   Whether the image could not be loaded asynchronously, in which
+        ///   case the texture is transparent.
+        /// </summary>
+        bool failed = false;
+
+        /// <summary>
+        ///   Whether the texture object was destroyed to free memory. It is
+        ///   reloaded from file the next time it is bound.
+        /// </summary>
+        bool evicted = false;
+
+        /// <summary>
+        ///   Whether the texture can be evicted, i.e. whether it was loaded
+        ///   from file into its own texture object.
+        /// </summary>
+        bool reloadable = false;
+
+        /// <summary>Frame in which the texture was last bound.</summary>
+        uint64_t last_used = 0;
+
+        /// <summary>Parameters for reloading an evicted texture.</summary>
+        float scale = 1.0F;
+        Filter mag_filter = Filter::Linear;
+        Filter min_filter = Filter::Linear;
     };
 
     class TextureProvider : private NonCopyable<TextureProvider>
     {
     public:
+        /// <summary>Width and height of atlas pages, in pixels.</summary>
+        static constexpr uint32_t kAtlasPageSize = 2048;
+
+        /// <summary>
+        ///   Images wider or taller than this are never packed into an atlas.
+        /// </summary>
+        static constexpr uint32_t kMaxAtlasImageSize = 256;
+
+        /// <summary>
+        ///   Default number of bytes of asynchronously loaded images uploaded
+        ///   per frame.
+        /// </summary>
+        static constexpr size_t kDefaultUploadBudget = 4 * 1024 * 1024;
+
+        /// <summary>
+        ///   Default number of frames a texture must go unbound before it may
+        ///   be evicted.
+        /// </summary>
+        static constexpr uint32_t kDefaultEvictionAge = 120;
+
+        /// <summary>
+        ///   Called when an asynchronous load has completed. The second
+        ///   argument is <c>false</c> if the image could not be loaded.
+        /// </summary>
+        using Callback = std::function<void(std::string_view path, bool)>;
+
         explicit TextureProvider(ITextureAllocator&);
         ~TextureProvider();
 
+        /// <summary>
+        ///   Destroys least recently used textures that have not been bound
+        ///   for a while, until at least <paramref name="bytes"/> have been
+        ///   freed or there are no more candidates.
+        /// </summary>
+        /// <returns>Number of bytes freed.</returns>
+        auto evict(size_t bytes) -> size_t;
+
+        /// <summary>
+        ///   Returns whether small images are packed into shared atlas pages.
+        /// </summary>
+        [[nodiscard]] auto is_atlas_enabled() const { return atlas_enabled_; }
+
         [[nodiscard]]
         auto get(std::string_view path,
                  float scale = 1.0F,
@@ -71,11 +164,150 @@ namespace rainbow::graphics
                  Filter mag_filter = Filter::Cubic,
                  Filter min_filter = Filter::Linear) -> Texture;
 
+        /// <summary>
+        ///   Returns a texture that is bound to a transparent placeholder
+        ///   until <paramref name="path"/> has been read and decoded on
+        ///   <paramref name="job_pool"/>, and uploaded by
+        ///   <see cref="upload_pending"/>.
+        /// </summary>
+        /// <remarks>
+        ///   <paramref name="callback"/>, if any, is called from
+        ///   <see cref="upload_pending"/> or <see cref="wait"/> once the
+        ///   texture is ready. It is never called if all references to the
+        ///   texture are released before then. Textures that fail to load are
+        ///   left transparent.
+        /// </remarks>
+        [[nodiscard]]
+        auto get_async(JobPool& job_pool,
+                       std::string_view path,
+                       Callback callback = {},
+                       float scale = 1.0F,
+                       Filter mag_filter = Filter::Cubic,
+                       Filter min_filter = Filter::Linear) -> Texture;
+
+        /// <summary>
+        ///   Returns whether <paramref name="texture"/> has finished loading.
+        /// </summary>
+        [[nodiscard]] auto is_loaded(const Texture& texture) const -> bool;
+
+        /// <summary>
+        ///   Advances the frame counter used to determine which textures are
+        ///   unused, and evicts textures if over the memory budget. Must be
+        ///   called once per frame.
+        /// </summary>
+        void next_frame();
+
+        /// <summary>
+        ///   Returns the number of bytes of texture memory currently in use,
+        ///   and the peak.
+        /// </summary>
+        [[nodiscard]] auto memory_usage() const
+        {
+            return std::make_tuple(mem_used_, mem_peak_);
+        }
+
+        /// <summary>
+        ///   Returns the number of bytes of evicted textures, i.e. what it
+        ///   would take to reload them all.
+        /// </summary>
+        [[nodiscard]] auto memory_evicted() const { return mem_evicted_; }
+
+        /// <summary>Returns the number of pending asynchronous loads.</summary>
+        [[nodiscard]] auto pending_count() const { return pending_.size(); }
+
         [[nodiscard]]
         auto raw_get(const Texture&) const -> TextureData;
 
         void release(const Texture&);
 
+        /// <summary>
+        ///   Enables or disables packing of small images into shared atlas
+        ///   pages. Only affects images subsequently loaded from file.
+        /// </summary>
+        /// <remarks>
+        ///   Packed textures share a texture object with other textures on the
+        ///   same page, which allows their sprite batches to be drawn without
+        ///   rebinding, or even merged. Sprite texture areas are remapped
+        ///   transparently. Space on a page is reclaimed only once all of its
+        ///   textures have been released.
+        /// </remarks>
+        void set_atlas_enabled(bool enabled) { atlas_enabled_ = enabled; }
+
+        /// <summary>
+        ///   Sets the number of frames a texture must go unbound before it
+        ///   may be evicted.
+        /// </summary>
+        void set_eviction_age(uint32_t frames) { eviction_age_ = frames; }
+
+        /// <summary>
+        ///   Sets the pool that vector images loaded synchronously are
+        ///   rasterized on. Asynchronous loads use their own pool.
+        /// </summary>
+        void set_job_pool(JobPool* job_pool) { job_pool_ = job_pool; }
+
+        /// <summary>
+        ///   Sets the maximum number of bytes of texture memory to keep
+        ///   resident. Zero means no limit.
+        /// </summary>
+        /// <remarks>
+        ///   The budget is soft: textures in use are never evicted, nor are
+        ///   textures that cannot be reloaded from file, e.g. those created
+        ///   from memory or packed into an atlas page.
+        /// </remarks>
+        void set_memory_budget(size_t bytes) { memory_budget_ = bytes; }
+
+        /// <summary>
+        ///   Enables or disables mip chains for images subsequently loaded
+        ///   from file. Minifying filters then also blend between levels.
+        /// </summary>
+        /// <remarks>
+        ///   Uncompressed images are box filtered when decoded; compressed
+        ///   images use the levels baked into the file. Images packed into an
+        ///   atlas page do not get a chain. Only <see cref="get_async"/>
+        ///   builds chains on a worker; other loads build them on the calling
+        ///   thread.
+        /// </remarks>
+        void set_mipmaps_enabled(bool enabled) { mipmaps_enabled_ = enabled; }
+
+        /// <summary>
+        ///   Sets the number of top mip levels to drop from images
+        ///   subsequently loaded from file, e.g. to save memory on low-end
+        ///   devices. Textures keep their original logical size.
+        /// </summary>
+        void set_skipped_mip_levels(uint32_t levels)
+        {
+            skipped_mip_levels_ = levels;
+        }
+
+        /// <summary>
+        ///   Sets the compressed texture variants to look for, best first.
+        /// </summary>
+        /// <remarks>
+        ///   When loading e.g. <c>sprites.ktx2</c> from file, the first of
+        ///   <c>sprites.astc.ktx2</c>, <c>sprites.bptc.ktx2</c>, etc. that
+        ///   exists is loaded in its place. The texture is still referred to
+        ///   by the requested path.
+        /// </remarks>
+        void set_texture_variants(std::vector<std::string> variants)
+        {
+            texture_variants_ = std::move(variants);
+        }
+
+        /// <summary>
+        ///   Sets the maximum number of bytes of asynchronously loaded images
+        ///   to upload per frame. At least one image is uploaded every frame
+        ///   regardless. Zero means no limit.
+        /// </summary>
+        void set_upload_budget(size_t bytes) { upload_budget_ = bytes; }
+
+        /// <summary>
+        ///   Returns the key of the texture object backing
+        ///   <paramref name="texture"/>; its atlas page if packed, otherwise
+        ///   its own key.
+        /// </summary>
+        [[nodiscard]]
+        auto storage_key(const Texture& texture) const -> std::string_view;
+
         [[nodiscard]]
         auto try_get(const Texture&) -> std::optional<TextureData>;
 
@@ -84,11 +316,77 @@ namespace rainbow::graphics
                     Filter mag_filter = Filter::Cubic,
                     Filter min_filter = Filter::Linear);
 
+        /// <summary>
+        ///   Replaces the area at (<paramref name="x"/>, <paramref name="y"/>)
+        ///   of <paramref name="texture"/> with <paramref name="image"/>,
+        ///   which must be uncompressed, of the same format, and fit inside
+        ///   the texture.
+        /// </summary>
+        void update_region(const Texture& texture,
+                           uint32_t x,
+                           uint32_t y,
+                           const Image& image);
+
+        /// <summary>
+        ///   Uploads images decoded since last call, in the order they were
+        ///   requested, within the upload budget, then runs their callbacks.
+        ///   Must be called once per frame on the render thread.
+        /// </summary>
+        void upload_pending();
+
+        /// <summary>
+        ///   Marks <paramref name="texture"/> as used this frame, reloading it
+        ///   first if it was evicted. Called when the texture is bound.
+        /// </summary>
+        auto use(const Texture& texture) -> const TextureData&;
+
+        /// <summary>
+        ///   Blocks until <paramref name="texture"/> has been decoded, then
+        ///   uploads it regardless of the upload budget. Its callbacks are
+        ///   run on next <see cref="upload_pending"/>.
+        /// </summary>
+        void wait(const Texture& texture);
+
+        /// <summary>
+        ///   Blocks until all of <paramref name="textures"/> have been decoded,
+        ///   then uploads them regardless of the upload budget.
+        /// </summary>
+        void wait(ArrayView<Texture> textures);
+
     private:
         using TextureMap = ArrayMap<std::string, TextureData>;
 
+        struct AsyncLoad;
+        struct AsyncQueue;
+        struct AtlasPage;
+
         TextureMap texture_map_;
         ITextureAllocator& allocator_;
+        std::vector<std::unique_ptr<AtlasPage>> atlas_pages_;
+        bool atlas_enabled_ = false;
+        bool mipmaps_enabled_ = false;
+        uint32_t skipped_mip_levels_ = 0;
+        std::vector<std::string> texture_variants_;
+        std::shared_ptr<AsyncQueue> async_queue_;
+        std::vector<std::shared_ptr<AsyncLoad>> pending_;
+
+        /// <summary>
+        ///   Released loads that are still decoding into a staging buffer.
+        /// </summary>
+        std::vector<std::shared_ptr<AsyncLoad>> cancelled_;
+
+        std::vector<std::pair<std::string, Callback>> deferred_callbacks_;
+        TextureHandle placeholder_{};
+        JobPool* job_pool_ = nullptr;
+        size_t upload_budget_ = kDefaultUploadBudget;
+        size_t memory_budget_ = 0;
+        uint32_t eviction_age_ = kDefaultEvictionAge;
+        uint64_t frame_ = 0;
+        size_t mem_used_ = 0;
+        size_t mem_peak_ = 0;
+        size_t mem_evicted_ = 0;
+
+        void finish(AsyncLoad&);
 
         template <typename T>
         auto get(std::string_view path,
@@ -100,19 +398,29 @@ namespace rainbow::graphics
         void load(TextureMap::iterator i,
                   const Image&,
                   Filter mag_filter,
-                  Filter min_filter);
-
-#ifdef USE_HEIMDALL
-    public:
-        [[nodiscard]]
-        auto memory_usage() const
-        {
-            return std::make_tuple(mem_used_, mem_peak_);
-        }
-
-    private:
-        size_t mem_used_ = 0;
-        size_t mem_peak_ = 0;
+                  Filter min_filter,
+                  bool packable = false);
+
+        /// <summary>
+        ///   Decodes <paramref name="file"/> straight into a staging buffer if
+        ///   it needs no processing before upload; returns an unknown image
+        ///   otherwise.
+        /// </summary>
+        auto decode_staged(const Data& file, bool packable) -> Image;
+
+        /// <summary>
+        ///   Loads an image decoded from file, applying mip chain settings
+        ///   but keeping its logical size.
+        /// </summary>
+        void load_decoded(TextureMap::iterator i,
+                          Image&&,
+                          Filter mag_filter,
+                          Filter min_filter);
+
+        auto pack(TextureData&,
+                  const Image&,
+                  Filter mag_filter,
+                  Filter min_filter) -> bool;
 
         void record_usage(size_t image_size)
         {
@@ -120,7 +428,35 @@ namespace rainbow::graphics
             if (mem_used_ > mem_peak_)
                 mem_peak_ = mem_used_;
         }
-#endif
+
+        void release_page(uint32_t page);
+
+        /// <summary>Reloads an evicted texture from file.</summary>
+        void reload(TextureMap::iterator i);
+
+        /// <summary>
+        ///   Stores what is needed to reload <paramref name="texture"/> from
+        ///   file, unless it was packed into an atlas page.
+        /// </summary>
+        static void set_reloadable(TextureData& texture,
+                                   float scale,
+                                   Filter mag_filter,
+                                   Filter min_filter);
+
+        /// <summary>
+        ///   Returns the path of the best available compressed variant of
+        ///   <paramref name="path"/>, or the path itself.
+        /// </summary>
+        [[nodiscard]] auto resolve(std::string_view path) const -> std::string;
+
+        /// <summary>
+        ///   Maps a staging buffer for <paramref name="load"/> and submits it
+        ///   for decoding into it.
+        /// </summary>
+        void stage(const std::shared_ptr<AsyncLoad>& load);
+
+        /// <summary>Submits <paramref name="load"/> for decoding.</summary>
+        void submit(const std::shared_ptr<AsyncLoad>& load);
     };
 
     class Texture
@@ -132,8 +468,17 @@ namespace rainbow::graphics
         Texture(std::string_view key, Passkey<TextureProvider>) : key_(key) {}
         ~Texture();
 
+        /// <summary>Returns whether the texture has finished loading.</summary>
+        [[nodiscard]] auto is_loaded() const -> bool;
+
         [[nodiscard]] auto key() const { return std::string_view{key_}; }
 
+        /// <summary>
+        ///   Returns the key of the texture object backing this texture. Two
+        ///   textures with the same storage key are bound as one.
+        /// </summary>
+        [[nodiscard]] auto storage_key() const -> std::string_view;
+
         auto operator=(const Texture&) -> Texture&;
         auto operator=(Texture&&) noexcept -> Texture&;
 
@@ -163,6 +508,29 @@ namespace rainbow::graphics
 
         virtual void destroy(TextureHandle&) = 0;
 
+        /// <summary>Returns an unused staging buffer.</summary>
+        virtual void discard_staging(const uint8_t*) {}
+
+        /// <summary>
+        ///   Returns whether images can be decoded straight into memory owned
+        ///   by the allocator. See <see cref="map_staging"/>.
+        /// </summary>
+        [[nodiscard]] virtual auto has_staging() const -> bool { return false; }
+
+        /// <summary>
+        ///   Returns a write-only buffer of <paramref name="size"/> bytes to
+        ///   decode an image into, or <c>nullptr</c> on failure.
+        /// </summary>
+        /// <remarks>
+        ///   The buffer may be written to from any thread. Passing an image
+        ///   pointing at it to <see cref="construct"/> or
+        ///   <see cref="update"/> uploads it and returns the buffer.
+        /// </remarks>
+        virtual auto map_staging([[maybe_unused]] size_t size) -> uint8_t*
+        {
+            return nullptr;
+        }
+
         [[maybe_unused, nodiscard]]
         virtual auto max_size() const noexcept -> size_t = 0;
 
@@ -170,9 +538,19 @@ namespace rainbow::graphics
                             const Image&,
                             Filter mag_filter,
                             Filter min_filter) = 0;
+
+        /// <summary>
+        ///   Replaces the area at (<paramref name="x"/>, <paramref name="y"/>)
+        ///   with <paramref name="image"/>, which must be uncompressed RGBA or
+        ///   alpha.
+        /// </summary>
+        virtual void update_region(const TextureHandle&,
+                                   uint32_t x,
+                                   uint32_t y,
+                                   const Image& image) = 0;
     };
 
-    void bind(const Context&, const Texture&, uint32_t unit = 0);
+    void bind(Context&, const Texture&, uint32_t unit = 0);
 }  // namespace rainbow::graphics
 
 #endif
@@ -4,6 +4,7 @@
 
 #include "Graphics/TextureAllocator.gl.h"
 
+#include <algorithm>
 #include <tuple>
 
 #include "Common/Logging.h"
@@ -31,6 +32,21 @@
 #ifndef GL_OES_compressed_ETC1_RGB8_texture
 #    define GL_ETC1_RGB8_OES 0x8D64
 #endif
+#ifndef GL_COMPRESSED_RED_RGTC1
+#    define GL_COMPRESSED_RED_RGTC1 0x8DBB
+#    define GL_COMPRESSED_RG_RGTC2 0x8DBD
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#    define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#    define GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT 0x8E8F
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#    define GL_COMPRESSED_RGB8_ETC2 0x9274
+#    define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#    define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
 
 #define kInvalidColorDepth "Invalid colour depth"
 
@@ -41,17 +57,50 @@ using rainbow::graphics::gl::TextureAllocator;
 
 namespace
 {
-    constexpr auto texture_filter(Filter filter) -> int
+    auto astc_format(const Image& image) -> GLenum
+    {
+        // Footprints in the order their formats are enumerated.
+        constexpr uint32_t kFootprints[][2]{{4, 4},
+                                            {5, 4},
+                                            {5, 5},
+                                            {6, 5},
+                                            {6, 6},
+                                            {8, 5},
+                                            {8, 6},
+                                            {8, 8},
+                                            {10, 5},
+                                            {10, 6},
+                                            {10, 8},
+                                            {10, 10},
+                                            {12, 10},
+                                            {12, 12}};
+
+        GLenum format = GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+        for (auto&& [width, height] : kFootprints)
+        {
+            if (width == image.block_width && height == image.block_height)
+                return format;
+            ++format;
+        }
+
+        R_ASSERT(false, "Invalid ASTC block footprint");
+        return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+    }
+
+    constexpr auto texture_filter(Filter filter, bool mipmapped = false)
+        -> int
     {
         switch (filter)
         {
             case Filter::Nearest:
-                return GL_NEAREST;
+                return mipmapped ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
 
             case Filter::Linear:
-                [[fallthrough]];
             case Filter::Cubic:
-                return GL_LINEAR;
+                // Mip chains are always blended between levels (trilinear).
+                // Bicubic sampling would need a shader; in fixed-function,
+                // the best we can do is the same as linear.
+                return mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
         }
 
         std::abort();
@@ -65,6 +114,13 @@ namespace
                 R_ASSERT(false, "Unknown image format");
                 return std::make_tuple(GL_RGBA8, GL_RGBA);
 
+            case Image::Format::Alpha:
+                R_ASSERT(image.depth == 8, kInvalidColorDepth);
+                return std::make_tuple(GL_ALPHA, GL_ALPHA);
+
+            case Image::Format::ASTC:
+                return std::make_tuple(astc_format(image), GL_NONE);
+
             case Image::Format::ATITC:
                 return std::make_tuple(image.channels == 3
                                            ? GL_ATC_RGB_AMD
@@ -85,9 +141,28 @@ namespace
                 return std::make_tuple(
                     GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_NONE);
 
+            case Image::Format::BC4:
+                return std::make_tuple(GL_COMPRESSED_RED_RGTC1, GL_NONE);
+
+            case Image::Format::BC5:
+                return std::make_tuple(GL_COMPRESSED_RG_RGTC2, GL_NONE);
+
+            case Image::Format::BC6H:
+                return std::make_tuple(
+                    GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, GL_NONE);
+
+            case Image::Format::BC7:
+                return std::make_tuple(GL_COMPRESSED_RGBA_BPTC_UNORM, GL_NONE);
+
             case Image::Format::ETC1:
                 return std::make_tuple(GL_ETC1_RGB8_OES, GL_NONE);
 
+            case Image::Format::ETC2:
+                return std::make_tuple(image.channels == 3
+                                           ? GL_COMPRESSED_RGB8_ETC2
+                                           : GL_COMPRESSED_RGBA8_ETC2_EAC,
+                                       GL_NONE);
+
             case Image::Format::PVRTC:
                 R_ASSERT(image.depth == 2 || image.depth == 4,  //
                          kInvalidColorDepth);
@@ -145,26 +220,25 @@ namespace
     {
         return rainbow::narrow_cast<GLuint>(handle[0]);
     }
+}  // namespace
 
-    void bind(const TextureHandle& handle, uint32_t unit)
+TextureAllocator::~TextureAllocator()
+{
+    // Deleting a buffer object also unmaps it.
+    for (auto* buffers : {&staging_, &staging_pool_})
     {
-        static auto bound_unit = 0U;
-        static auto bound_textures = std::array<GLuint, 32>{};
-
-        if (unit != bound_unit)
-        {
-            bound_unit = unit;
-            glActiveTexture(GL_TEXTURE0 + unit);
-        }
-
-        auto id = texture_id(handle);
-        if (id != bound_textures[unit])
+        for (auto&& staging : *buffers)
         {
-            bound_textures[unit] = id;
-            glBindTexture(GL_TEXTURE_2D, id);
+            if (staging.buffer != 0)
+                state_.delete_buffer(staging.buffer);
         }
     }
-}  // namespace
+}
+
+void TextureAllocator::bind(const TextureHandle& handle, uint32_t unit) const
+{
+    state_.bind_texture(unit, texture_id(handle));
+}
 
 void TextureAllocator::construct(TextureHandle& handle,
                                  const Image& image,
@@ -180,8 +254,99 @@ void TextureAllocator::construct(TextureHandle& handle,
 
 void TextureAllocator::destroy(TextureHandle& handle)
 {
-    const auto texture = texture_id(handle);
-    glDeleteTextures(1, &texture);
+    state_.delete_texture(texture_id(handle));
+}
+
+void TextureAllocator::discard_staging(const uint8_t* data)
+{
+    auto staging = std::find_if(
+        staging_.begin(), staging_.end(), [data](auto&& staging) {
+            return staging.data == data;
+        });
+    R_ASSERT(staging != staging_.end(), "Unknown staging buffer");
+
+#ifdef USE_PIXEL_UNPACK_BUFFER
+    if (staging->buffer != 0)
+    {
+        state_.bind_pixel_unpack_buffer(staging->buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        state_.bind_pixel_unpack_buffer(0);
+    }
+#endif
+
+    recycle(staging);
+}
+
+void TextureAllocator::initialize()
+{
+#ifdef USE_PIXEL_UNPACK_BUFFER
+    use_pixel_buffers_ = has_gl_version(3, 0) ||
+                         has_extension("GL_ARB_map_buffer_range");
+#endif
+    LOGI("Texture staging: %s",
+         use_pixel_buffers_ ? "pixel unpack buffers" : "pooled memory");
+}
+
+auto TextureAllocator::map_staging(size_t size) -> uint8_t*
+{
+    StagingBuffer staging;
+    if (use_pixel_buffers_)
+    {
+#ifdef USE_PIXEL_UNPACK_BUFFER
+        if (staging_pool_.empty())
+        {
+            glGenBuffers(1, &staging.buffer);
+        }
+        else
+        {
+            staging = std::move(staging_pool_.back());
+            staging_pool_.pop_back();
+        }
+
+        // Orphan the previous contents so that we never have to wait for an
+        // upload still reading from them.
+        state_.bind_pixel_unpack_buffer(staging.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER,
+                     narrow_cast<GLsizeiptr>(size),
+                     nullptr,
+                     GL_STREAM_DRAW);
+        staging.data = static_cast<uint8_t*>(glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER,
+            0,
+            narrow_cast<GLsizeiptr>(size),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        state_.bind_pixel_unpack_buffer(0);
+
+        if (staging.data == nullptr)
+        {
+            LOGW("Failed to map pixel unpack buffer");
+            state_.delete_buffer(staging.buffer);
+            return nullptr;
+        }
+#endif
+    }
+    else
+    {
+        auto pooled = std::find_if(
+            staging_pool_.begin(), staging_pool_.end(), [size](auto&& s) {
+                return s.size >= size;
+            });
+        if (pooled == staging_pool_.end())
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+            staging.memory = std::make_unique<uint8_t[]>(size);
+            staging.size = size;
+        }
+        else
+        {
+            staging = std::move(*pooled);
+            staging_pool_.erase(pooled);
+        }
+        staging.data = staging.memory.get();
+    }
+
+    staging_.push_back(std::move(staging));
+    return staging_.back().data;
 }
 
 auto TextureAllocator::max_size() const noexcept -> size_t
@@ -194,67 +359,211 @@ void TextureAllocator::update(const TextureHandle& handle,
                               Filter mag_filter,
                               Filter min_filter)
 {
-    ::bind(handle, 0);
-    glTexParameteri(
-        GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture_filter(min_filter));
+    const auto mipmapped = image.mip_levels > 1;
+
+    auto staging = std::find_if(
+        staging_.begin(), staging_.end(), [&image](auto&& staging) {
+            return staging.data == image.data;
+        });
+    const bool from_buffer =
+        staging != staging_.end() && staging->buffer != 0;
+
+#ifdef USE_PIXEL_UNPACK_BUFFER
+    if (from_buffer)
+    {
+        state_.bind_pixel_unpack_buffer(staging->buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+#endif
+
+    bind(handle, 0);
+    glTexParameteri(GL_TEXTURE_2D,
+                    GL_TEXTURE_MIN_FILTER,
+                    texture_filter(min_filter, mipmapped));
     glTexParameteri(
         GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture_filter(mag_filter));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+#ifdef GL_TEXTURE_MAX_LEVEL
+    glTexParameteri(GL_TEXTURE_2D,
+                    GL_TEXTURE_MAX_LEVEL,
+                    narrow_cast<GLint>(image.mip_levels - 1));
+#endif
+
+    // Rows of single-channel images are not necessarily aligned.
+    const bool unaligned = image.format == Image::Format::Alpha;
+    if (unaligned)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
     auto [internal_format, format] = texture_format(image);
-    switch (image.format)
+    for (uint32_t level = 0; level < image.mip_levels; ++level)
     {
-        case Image::Format::Unknown:
-            break;
-
-        case Image::Format::ATITC:
-            [[fallthrough]];
-        case Image::Format::BC1:
-            [[fallthrough]];
-        case Image::Format::BC2:
-            [[fallthrough]];
-        case Image::Format::BC3:
-            [[fallthrough]];
-        case Image::Format::ETC1:
-            [[fallthrough]];
-        case Image::Format::PVRTC:
-            glCompressedTexImage2D(  //
-                GL_TEXTURE_2D,
-                0,
-                internal_format,
-                narrow_cast<GLsizei>(image.width),
-                narrow_cast<GLsizei>(image.height),
-                0,
-                narrow_cast<GLsizei>(image.size),
-                image.data);
-            break;
-
-        case Image::Format::PNG:
-            [[fallthrough]];
-        case Image::Format::RGBA:
-            [[fallthrough]];
-        case Image::Format::SVG:
-            glTexImage2D(  //
-                GL_TEXTURE_2D,
-                0,
-                internal_format,
-                narrow_cast<GLsizei>(image.width),
-                narrow_cast<GLsizei>(image.height),
-                0,
-                format,
-                GL_UNSIGNED_BYTE,
-                image.data);
-            break;
+        const auto width = std::max(image.width >> level, 1U);
+        const auto height = std::max(image.height >> level, 1U);
+        // Data in a pixel unpack buffer is addressed by offset.
+        const auto offset = image.level_offset(level);
+        const void* data =
+            from_buffer
+                ? reinterpret_cast<const void*>(offset)  // NOLINT
+                : image.data + offset;
+        switch (image.format)
+        {
+            case Image::Format::Unknown:
+                break;
+
+            case Image::Format::ASTC:
+                [[fallthrough]];
+            case Image::Format::ATITC:
+                [[fallthrough]];
+            case Image::Format::BC1:
+                [[fallthrough]];
+            case Image::Format::BC2:
+                [[fallthrough]];
+            case Image::Format::BC3:
+                [[fallthrough]];
+            case Image::Format::BC4:
+                [[fallthrough]];
+            case Image::Format::BC5:
+                [[fallthrough]];
+            case Image::Format::BC6H:
+                [[fallthrough]];
+            case Image::Format::BC7:
+                [[fallthrough]];
+            case Image::Format::ETC1:
+                [[fallthrough]];
+            case Image::Format::ETC2:
+                [[fallthrough]];
+            case Image::Format::PVRTC:
+                glCompressedTexImage2D(  //
+                    GL_TEXTURE_2D,
+                    narrow_cast<GLint>(level),
+                    internal_format,
+                    narrow_cast<GLsizei>(width),
+                    narrow_cast<GLsizei>(height),
+                    0,
+                    narrow_cast<GLsizei>(mipmapped ? image.level_size(level)
+                                                   : image.size),
+                    data);
+                break;
+
+            case Image::Format::Alpha:
+                [[fallthrough]];
+            case Image::Format::PNG:
+                [[fallthrough]];
+            case Image::Format::RGBA:
+                [[fallthrough]];
+            case Image::Format::SVG:
+                // Rows of smaller mip levels are not necessarily aligned.
+                if (level == 1)
+                    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+                glTexImage2D(  //
+                    GL_TEXTURE_2D,
+                    narrow_cast<GLint>(level),
+                    internal_format,
+                    narrow_cast<GLsizei>(width),
+                    narrow_cast<GLsizei>(height),
+                    0,
+                    format,
+                    GL_UNSIGNED_BYTE,
+                    data);
+                break;
+        }
+    }
+
+    if (mipmapped || unaligned)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (staging != staging_.end())
+    {
+        if (from_buffer)
+            state_.bind_pixel_unpack_buffer(0);
+        recycle(staging);
     }
 
     R_ASSERT(glGetError() == GL_NO_ERROR, "Failed to upload texture");
 }
 
-void rainbow::graphics::bind(const Context& ctx,
+void TextureAllocator::update_region(const TextureHandle& handle,
+                                     uint32_t x,
+                                     uint32_t y,
+                                     const Image& image)
+{
+    const bool alpha = image.format == Image::Format::Alpha;
+    R_ASSERT((alpha && image.depth == 8) ||
+                 (image.channels == 4 && image.depth == 32),
+             "Only RGBA and alpha images can be copied into a region");
+
+    bind(handle, 0);
+    if (alpha)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glTexSubImage2D(GL_TEXTURE_2D,
+                    0,
+                    narrow_cast<GLint>(x),
+                    narrow_cast<GLint>(y),
+                    narrow_cast<GLsizei>(image.width),
+                    narrow_cast<GLsizei>(image.height),
+                    alpha ? GL_ALPHA : GL_RGBA,
+                    GL_UNSIGNED_BYTE,
+                    image.data);
+
+    if (alpha)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    R_ASSERT(glGetError() == GL_NO_ERROR, "Failed to update texture region");
+}
+
+void TextureAllocator::recycle(std::vector<StagingBuffer>::iterator staging)
+{
+    staging->data = nullptr;
+    staging_pool_.push_back(std::move(*staging));
+    staging_.erase(staging);
+
+    if (staging_pool_.size() > kMaxPooledStagingBuffers)
+    {
+        auto& oldest = staging_pool_.front();
+        if (oldest.buffer != 0)
+            state_.delete_buffer(oldest.buffer);
+        staging_pool_.erase(staging_pool_.begin());
+    }
+}
+
+auto rainbow::graphics::gl::compressed_texture_variants()
+    -> std::vector<std::string>
+{
+#ifdef GL_ES_VERSION_2_0
+    const bool astc = has_gl_version(3, 2) ||
+                      has_extension("GL_KHR_texture_compression_astc_ldr");
+    const bool bptc = has_extension("GL_EXT_texture_compression_bptc");
+    const bool etc2 = has_gl_version(3, 0);
+#else
+    const bool astc = has_extension("GL_KHR_texture_compression_astc_ldr");
+    const bool bptc = has_gl_version(4, 2) ||
+                      has_extension("GL_ARB_texture_compression_bptc");
+    const bool etc2 = has_gl_version(4, 3) ||
+                      has_extension("GL_ARB_ES3_compatibility");
+#endif
+
+    // Best quality per bit first
+    std::vector<std::string> variants;
+    if (astc)
+        variants.emplace_back("astc");
+    if (bptc)
+        variants.emplace_back("bptc");
+    if (etc2)
+        variants.emplace_back("etc2");
+    if (has_extension("GL_EXT_texture_compression_s3tc"))
+        variants.emplace_back("s3tc");
+    if (has_extension("GL_OES_compressed_ETC1_RGB8_texture"))
+        variants.emplace_back("etc1");
+    return variants;
+}
+
+void rainbow::graphics::bind(Context& ctx,
                              const Texture& texture,
                              uint32_t unit)
 {
-    auto texture_data = ctx.texture_provider.raw_get(texture);
-    ::bind(texture_data.data, unit);
+    const auto& texture_data = ctx.texture_provider.use(texture);
+    ctx.texture_allocator.bind(texture_data.data, unit);
 }
@@ -5,12 +5,38 @@
 #ifndef GRAPHICS_TEXTUREALLOCATOR_GL_H_
 #define GRAPHICS_TEXTUREALLOCATOR_GL_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "Graphics/Texture.h"
 
+namespace rainbow::graphics
+{
+    class StateCache;
+}  // namespace rainbow::graphics
+
 namespace rainbow::graphics::gl
 {
+    /// <summary>
+    ///   Creates GL textures. Images decoded into staging buffers are uploaded
+    ///   from pixel unpack buffers where available, letting the driver copy
+    ///   them asynchronously; elsewhere, staging memory is pooled.
+    /// </summary>
     struct TextureAllocator final : public ITextureAllocator
     {
+        /// <summary>Maximum number of unused staging buffers to keep.</summary>
+        static constexpr size_t kMaxPooledStagingBuffers = 4;
+
+        explicit TextureAllocator(StateCache& state) : state_(state) {}
+        ~TextureAllocator();
+
+        /// <summary>
+        ///   Binds the texture at <paramref name="handle"/> to texture unit
+        ///   <paramref name="unit"/>.
+        /// </summary>
+        void bind(const TextureHandle& handle, uint32_t unit) const;
+
         void construct(TextureHandle&,
                        const Image&,
                        Filter mag_filter,
@@ -18,6 +44,21 @@ namespace rainbow::graphics::gl
 
         void destroy(TextureHandle&) override;
 
+        void discard_staging(const uint8_t* data) override;
+
+        [[nodiscard]] auto has_staging() const -> bool override
+        {
+            return true;
+        }
+
+        /// <summary>
+        ///   Determines how staging buffers are backed. Must be called with
+        ///   the context current.
+        /// </summary>
+        void initialize();
+
+        auto map_staging(size_t size) -> uint8_t* override;
+
         [[maybe_unused, nodiscard]]
         auto max_size() const noexcept -> size_t override;
 
@@ -25,7 +66,38 @@ namespace rainbow::graphics::gl
                     const Image&,
                     Filter mag_filter,
                     Filter min_filter) override;
+
+        void update_region(const TextureHandle&,
+                           uint32_t x,
+                           uint32_t y,
+                           const Image&) override;
+
+    private:
+        struct StagingBuffer
+        {
+            unsigned int buffer = 0;
+
+            // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+            std::unique_ptr<uint8_t[]> memory;
+
+            uint8_t* data = nullptr;
+            size_t size = 0;
+        };
+
+        StateCache& state_;
+        std::vector<StagingBuffer> staging_;
+        std::vector<StagingBuffer> staging_pool_;
+        bool use_pixel_buffers_ = false;
+
+        /// <summary>Returns a mapped staging buffer to the pool.</summary>
+        void recycle(std::vector<StagingBuffer>::iterator staging);
     };
+
+    /// <summary>
+    ///   Returns the compressed texture variants that the driver supports,
+    ///   best first. See <see cref="TextureProvider::set_texture_variants"/>.
+    /// </summary>
+    auto compressed_texture_variants() -> std::vector<std::string>;
 }  // namespace rainbow::graphics::gl
 
 #endif
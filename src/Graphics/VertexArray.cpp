@@ -4,16 +4,30 @@
 
 #include "Graphics/VertexArray.h"
 
+#include "Graphics/Buffer.h"
 #include "Graphics/Renderer.h"
 
 using rainbow::graphics::VertexArray;
 
+namespace
+{
+    auto reserve_elements(uint32_t count) -> GLenum
+    {
+        auto& elements = rainbow::graphics::element_buffer();
+        R_ASSERT(count / 6 <= elements.max_sprites(),
+                 "Too many quads for a single draw call");
+
+        elements.reserve(count / 6);
+        return elements.index_type();
+    }
+}  // namespace
+
 void VertexArray::unbind()
 {
 #ifdef USE_VERTEX_ARRAY_OBJECT
-    glBindVertexArray(0);
+    state_cache().bind_vertex_array(0);
 #else
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    state_cache().bind_array_buffer(0);
 #endif
 }
 
@@ -30,14 +44,14 @@ VertexArray::~VertexArray()
     if (array_ == 0)
         return;
 
-    glDeleteVertexArrays(1, &array_);
+    delete_vertex_array(array_);
 #endif
 }
 
 void VertexArray::bind() const
 {
 #ifdef USE_VERTEX_ARRAY_OBJECT
-    glBindVertexArray(array_);
+    state_cache().bind_vertex_array(array_);
 #else
     array_();
 #endif
@@ -48,7 +62,7 @@ auto VertexArray::init_state() const -> GLuint
 #ifdef USE_VERTEX_ARRAY_OBJECT
     GLuint array;
     glGenVertexArrays(1, &array);
-    glBindVertexArray(array);
+    state_cache().bind_vertex_array(array);
     graphics::bind_element_array();
     return array;
 #else
@@ -56,11 +70,52 @@ auto VertexArray::init_state() const -> GLuint
 #endif
 }
 
+void VertexArray::finish_state([[maybe_unused]] GLuint array)
+{
+#ifdef USE_VERTEX_ARRAY_OBJECT
+    state_cache().bind_vertex_array(0);
+    if (array_ != 0)
+        delete_vertex_array(array_);
+    array_ = array;
+#endif
+}
+
 void rainbow::graphics::draw(const VertexArray& array, uint32_t count)
 {
+    const auto index_type = reserve_elements(count);
     array.bind();
     glDrawElements(
-        GL_TRIANGLES, narrow_cast<GLsizei>(count), GL_UNSIGNED_SHORT, nullptr);
+        GL_TRIANGLES, narrow_cast<GLsizei>(count), index_type, nullptr);
+
+    IF_DEBUG(increment_draw_count());
+}
+
+void rainbow::graphics::draw(const VertexArray& array,
+                             const Buffer& buffer,
+                             uint32_t count)
+{
+    draw(array, buffer, 0, count);
+}
+
+void rainbow::graphics::draw(const VertexArray& array,
+                             const Buffer& buffer,
+                             uint32_t first,
+                             uint32_t count)
+{
+    const auto index_type = reserve_elements(first + count);
+    array.bind();
+
+    // Streamed data may have moved since the vertex array was configured.
+    if (buffer.is_streaming())
+        buffer.bind();
+
+    const auto offset = first * (index_type == GL_UNSIGNED_INT
+                                     ? sizeof(GLuint)
+                                     : sizeof(GLushort));
+    glDrawElements(GL_TRIANGLES,
+                   narrow_cast<GLsizei>(count),
+                   index_type,
+                   reinterpret_cast<const void*>(offset));  // NOLINT
 
     IF_DEBUG(increment_draw_count());
 }
@@ -75,3 +130,20 @@ void rainbow::graphics::draw(const VertexArray& array,
 
     IF_DEBUG(increment_draw_count());
 }
+
+#ifdef USE_INSTANCED_ARRAYS
+void rainbow::graphics::draw_instanced(const VertexArray& array,
+                                       uint32_t count,
+                                       uint32_t instances)
+{
+    const auto index_type = reserve_elements(count);
+    array.bind();
+    glDrawElementsInstanced(GL_TRIANGLES,
+                            narrow_cast<GLsizei>(count),
+                            index_type,
+                            nullptr,
+                            narrow_cast<GLsizei>(instances));
+
+    IF_DEBUG(increment_draw_count());
+}
+#endif  // USE_INSTANCED_ARRAYS
@@ -12,6 +12,8 @@
 
 namespace rainbow::graphics
 {
+    class Buffer;
+
     /// <summary>
     ///   Manages a vertex array object for any drawable type. On Android,
     ///   vertex array objects are emulated.
@@ -38,10 +40,7 @@ namespace rainbow::graphics
 #ifdef USE_VERTEX_ARRAY_OBJECT
             GLuint array = init_state();
             array_state();
-            glBindVertexArray(0);
-            if (array_ != 0)
-                glDeleteVertexArrays(1, &array_);
-            array_ = array;
+            finish_state(array);
 #else
             array_ = std::forward<F>(array_state);
 #endif
@@ -63,10 +62,27 @@ namespace rainbow::graphics
 #endif
 
         auto init_state() const -> GLuint;
+        void finish_state(GLuint array);
     };
 
     void draw(const VertexArray& array, uint32_t count);
+    void draw(const VertexArray& array, const Buffer& buffer, uint32_t count);
+
+    /// <summary>
+    ///   Draws <paramref name="count"/> indices, starting at index
+    ///   <paramref name="first"/> of the shared element buffer.
+    /// </summary>
+    void draw(const VertexArray& array,
+              const Buffer& buffer,
+              uint32_t first,
+              uint32_t count);
     void draw(const VertexArray& array, uint32_t first, uint32_t count);
+
+#ifdef USE_INSTANCED_ARRAYS
+    void draw_instanced(const VertexArray& array,
+                        uint32_t count,
+                        uint32_t instances);
+#endif
 }  // namespace rainbow::graphics
 
 #endif
@@ -10,7 +10,9 @@
 
 #include "Common/TypeCast.h"
 #include "Graphics/Animation.h"
+#include "Graphics/InstancedSpriteBatch.h"
 #include "Graphics/Label.h"
+#include "Graphics/RenderLayer.h"
 #include "Graphics/SpriteBatch.h"
 #include "Script/GameBase.h"
 #include "ThirdParty/ImGui/ImGuiHelper.h"
@@ -25,6 +27,7 @@ using rainbow::Animation;
 using rainbow::Color;
 using rainbow::czstring;
 using rainbow::GameBase;
+using rainbow::InstancedSpriteBatch;
 using rainbow::KeyStroke;
 using rainbow::Label;
 using rainbow::Pointer;
@@ -33,6 +36,7 @@ using rainbow::SpriteBatch;
 using rainbow::Vec2f;
 using rainbow::Vec2i;
 using rainbow::graphics::Context;
+using rainbow::graphics::RenderLayer;
 using rainbow::graphics::Texture;
 
 namespace
@@ -177,6 +181,25 @@ namespace
             }
         }
 
+        void operator()(InstancedSpriteBatch* batch) const
+        {
+            if (ImGui::TreeNode(batch,
+                                WITH_TAG(InstancedSpriteBatch, "size=%u"),
+                                batch->size(),
+                                tag))
+            {
+                write_address(batch);
+                WRITE_PROP(*batch, texture);
+                WRITE_PROP(*batch, is_instanced);
+                WRITE_PROP(*batch, is_visible);
+
+                for (auto&& sprite : *batch)
+                    create_node(sprite);
+
+                ImGui::TreePop();
+            }
+        }
+
         void operator()(Label* label) const
         {
             if (ImGui::TreeNode(
@@ -191,17 +214,43 @@ namespace
             }
         }
 
+        void operator()(RenderLayer* layer) const
+        {
+            if (ImGui::TreeNode(layer,
+                                WITH_TAG(RenderLayer, "size=%zu redraws=%u"),
+                                layer->queue().size(),
+                                layer->redraw_count(),
+                                tag))
+            {
+                write_address(layer);
+                WRITE_PROP(*layer, is_stale);
+
+                for (auto&& unit : layer->queue())
+                {
+                    rainbow::visit(CreateNode{unit.tag().data()},
+                                   unit.object());
+                }
+
+                ImGui::TreePop();
+            }
+        }
+
         void operator()(SpriteBatch* batch) const
         {
+            const auto drawn = batch->drawn_count();
             if (ImGui::TreeNode(batch,
-                                WITH_TAG(SpriteBatch, "size=%u"),
+                                WITH_TAG(SpriteBatch, "size=%u drawn=%u"),
                                 batch->size(),
+                                drawn,
                                 tag))
             {
                 write_address(batch);
                 WRITE_PROP(*batch, texture);
                 WRITE_PROP(*batch, normal);
                 WRITE_PROP(*batch, is_visible);
+                WRITE_PROP(*batch, is_culling);
+                write_prop("drawn", drawn);
+                write_prop("culled", batch->size() - drawn);
 
                 for (auto&& sprite : *batch)
                     create_node(sprite);
@@ -269,7 +318,17 @@ void Overlay::draw_performance(float scale)
     const ImVec2 graph_size{
         kStyleWindowWidth * scale, kStylePlotHeight * scale};
 
-    ImGui::TextWrapped("Draw count: %u", graphics::draw_count());
+    const auto draw_count = graphics::draw_count();
+    ImGui::TextWrapped("Draw count: %u (%u before merging)",
+                       draw_count.issued,
+                       draw_count.requested);
+    ImGui::TextWrapped(
+        "Buffer uploads: %.2f kB/frame", graphics::bytes_uploaded() / 1024.0);
+
+    const auto state_changes = graphics::state_cache().count();
+    ImGui::TextWrapped("GL state changes: %u (%u elided)",
+                       state_changes.issued,
+                       state_changes.elided);
 
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
     std::array<char, 128> buffer;
@@ -307,6 +366,37 @@ void Overlay::draw_performance(float scale)
         graph_size);
 
     ImGui::TextWrapped("OpenGL %s", graphics::gl_version());
+    ImGui::TextWrapped("Streaming buffer: %s", [this] {
+        switch (director_.graphics_context().streaming_buffer.mode())
+        {
+            case graphics::StreamingBuffer::Mode::Disabled:
+                return "disabled";
+            case graphics::StreamingBuffer::Mode::Unsynchronized:
+                return "unsynchronized";
+            case graphics::StreamingBuffer::Mode::Persistent:
+                return "persistent";
+        }
+        return "unknown";
+    }());
+    {
+        const auto& texture_provider =
+            director_.graphics_context().texture_provider;
+        auto [resident, peak] = texture_provider.memory_usage();
+        ImGui::TextWrapped(  //
+            "Textures: %.2f MBs resident (%.2f MBs peak), %.2f MBs evicted",
+            resident * 1e-6,
+            peak * 1e-6,
+            texture_provider.memory_evicted() * 1e-6);
+    }
+    {
+        const auto [hits, misses] = director_.typesetter().shaping_stats();
+        const auto lookups = hits + misses;
+        ImGui::TextWrapped(  //
+            "Text shaping: %u hits, %u misses (%.1f%% hit rate)",
+            hits,
+            misses,
+            lookups == 0 ? 0.0 : hits * 100.0 / lookups);
+    }
     ImGui::TextWrapped("Vendor: %s", graphics::vendor());
     ImGui::TextWrapped("Renderer: %s", graphics::renderer());
 
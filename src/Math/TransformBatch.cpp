@@ -0,0 +1,320 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Math/TransformBatch.h"
+
+#include <cmath>
+#include <limits>
+
+#if defined(RAINBOW_SIMD_AVX2)
+#    include <immintrin.h>
+#elif defined(RAINBOW_SIMD_SSE2)
+#    include <emmintrin.h>
+#elif defined(RAINBOW_SIMD_NEON)
+#    include <arm_neon.h>
+#endif
+
+#include "Graphics/SpriteVertex.h"
+
+using rainbow::TransformBatch;
+
+namespace
+{
+    // Must match |rainbow::is_almost_zero|.
+    constexpr float kAlmostZero =
+        std::numeric_limits<float>::epsilon() * 10.0F;
+
+    namespace simd
+    {
+#if defined(RAINBOW_SIMD_AVX2)
+        using vfloat = __m256;
+        using vint = __m256i;
+        using vmask = __m256;
+
+        auto load(const float* p) { return _mm256_load_ps(p); }
+        void store(float* p, vfloat v) { _mm256_store_ps(p, v); }
+        auto set1(float f) { return _mm256_set1_ps(f); }
+        auto add(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+        auto sub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+        auto mul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+
+        auto abs(vfloat v)
+        {
+            return _mm256_andnot_ps(_mm256_set1_ps(-0.0F), v);
+        }
+
+        auto less(vfloat a, vfloat b)
+        {
+            return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+        }
+
+        auto select(vmask mask, vfloat a, vfloat b)
+        {
+            return _mm256_blendv_ps(b, a, mask);
+        }
+
+        auto round_to_int(vfloat v) { return _mm256_cvtps_epi32(v); }
+        auto to_float(vint v) { return _mm256_cvtepi32_ps(v); }
+
+        auto increment(vint v)
+        {
+            return _mm256_add_epi32(v, _mm256_set1_epi32(1));
+        }
+
+        auto has_bit(vint v, int bit)
+        {
+            const auto b = _mm256_set1_epi32(bit);
+            return _mm256_castsi256_ps(
+                _mm256_cmpeq_epi32(_mm256_and_si256(v, b), b));
+        }
+#elif defined(RAINBOW_SIMD_SSE2)
+        using vfloat = __m128;
+        using vint = __m128i;
+        using vmask = __m128;
+
+        auto load(const float* p) { return _mm_load_ps(p); }
+        void store(float* p, vfloat v) { _mm_store_ps(p, v); }
+        auto set1(float f) { return _mm_set1_ps(f); }
+        auto add(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+        auto sub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+        auto mul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+
+        auto abs(vfloat v) { return _mm_andnot_ps(_mm_set1_ps(-0.0F), v); }
+
+        auto less(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+
+        auto select(vmask mask, vfloat a, vfloat b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        auto round_to_int(vfloat v) { return _mm_cvtps_epi32(v); }
+        auto to_float(vint v) { return _mm_cvtepi32_ps(v); }
+
+        auto increment(vint v) { return _mm_add_epi32(v, _mm_set1_epi32(1)); }
+
+        auto has_bit(vint v, int bit)
+        {
+            const auto b = _mm_set1_epi32(bit);
+            return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(v, b), b));
+        }
+#elif defined(RAINBOW_SIMD_NEON)
+        using vfloat = float32x4_t;
+        using vint = int32x4_t;
+        using vmask = uint32x4_t;
+
+        auto load(const float* p) { return vld1q_f32(p); }
+        void store(float* p, vfloat v) { vst1q_f32(p, v); }
+        auto set1(float f) { return vdupq_n_f32(f); }
+        auto add(vfloat a, vfloat b) { return vaddq_f32(a, b); }
+        auto sub(vfloat a, vfloat b) { return vsubq_f32(a, b); }
+        auto mul(vfloat a, vfloat b) { return vmulq_f32(a, b); }
+
+        auto abs(vfloat v) { return vabsq_f32(v); }
+
+        auto less(vfloat a, vfloat b) { return vcltq_f32(a, b); }
+
+        auto select(vmask mask, vfloat a, vfloat b)
+        {
+            return vbslq_f32(mask, a, b);
+        }
+
+        auto round_to_int(vfloat v)
+        {
+            // Round half away from zero; ARMv7 has no round-to-nearest.
+            const auto half =
+                vbslq_f32(vcltq_f32(v, vdupq_n_f32(0.0F)),
+                          set1(-0.5F),
+                          set1(0.5F));
+            return vcvtq_s32_f32(vaddq_f32(v, half));
+        }
+
+        auto to_float(vint v) { return vcvtq_f32_s32(v); }
+
+        auto increment(vint v) { return vaddq_s32(v, vdupq_n_s32(1)); }
+
+        auto has_bit(vint v, int bit)
+        {
+            const auto b = vdupq_n_s32(bit);
+            return vceqq_s32(vandq_s32(v, b), b);
+        }
+#else
+        using vfloat = float;
+        using vint = int32_t;
+        using vmask = bool;
+
+        auto load(const float* p) { return *p; }
+        void store(float* p, vfloat v) { *p = v; }
+        auto set1(float f) { return f; }
+        auto add(vfloat a, vfloat b) { return a + b; }
+        auto sub(vfloat a, vfloat b) { return a - b; }
+        auto mul(vfloat a, vfloat b) { return a * b; }
+
+        auto abs(vfloat v) { return std::abs(v); }
+
+        auto less(vfloat a, vfloat b) { return a < b; }
+
+        auto select(vmask mask, vfloat a, vfloat b) { return mask ? a : b; }
+
+        auto round_to_int(vfloat v)
+        {
+            return static_cast<int32_t>(std::nearbyint(v));
+        }
+
+        auto to_float(vint v) { return static_cast<float>(v); }
+
+        auto increment(vint v) { return v + 1; }
+
+        auto has_bit(vint v, int bit) { return (v & bit) != 0; }
+#endif
+
+        /// <summary>
+        ///   Computes sine and cosine of <paramref name="x"/>. Based on Cephes'
+        ///   <c>sinf</c> and <c>cosf</c>, with reduction to [-pi/4, pi/4] by
+        ///   quadrant.
+        /// </summary>
+        void sincos(vfloat x, vfloat& s, vfloat& c)
+        {
+            // Extended precision modular arithmetic; pi/2 = kPiO2_1 + kPiO2_2 +
+            // kPiO2_3.
+            constexpr float kPiO2_1 = 1.5703125F;
+            constexpr float kPiO2_2 = 4.837512969970703125e-4F;
+            constexpr float kPiO2_3 = 7.54978995489188216e-8F;
+            constexpr float kTwoOverPi = 0.636619772367581343F;
+
+            const vint quadrant = round_to_int(mul(x, set1(kTwoOverPi)));
+            const vfloat j = to_float(quadrant);
+            vfloat r = sub(x, mul(j, set1(kPiO2_1)));
+            r = sub(r, mul(j, set1(kPiO2_2)));
+            r = sub(r, mul(j, set1(kPiO2_3)));
+
+            const vfloat z = mul(r, r);
+
+            vfloat sin_r = add(mul(set1(-1.9515295891e-4F), z),
+                               set1(8.3321608736e-3F));
+            sin_r = sub(mul(sin_r, z), set1(1.6666654611e-1F));
+            sin_r = add(mul(mul(sin_r, z), r), r);
+
+            vfloat cos_r = sub(mul(set1(2.443315711809948e-5F), z),
+                               set1(1.388731625493765e-3F));
+            cos_r = add(mul(cos_r, z), set1(4.166664568298827e-2F));
+            cos_r = mul(mul(cos_r, z), z);
+            cos_r = add(sub(cos_r, mul(set1(0.5F), z)), set1(1.0F));
+
+            // sin(x) = [s, c, -s, -c] and cos(x) = [c, -s, -c, s] by quadrant.
+            const vmask swap = has_bit(quadrant, 1);
+            const vfloat sin_x = select(swap, cos_r, sin_r);
+            const vfloat cos_x = select(swap, sin_r, cos_r);
+
+            const vfloat zero = set1(0.0F);
+            const vmask negate_sin = has_bit(quadrant, 2);
+            s = select(negate_sin, sub(zero, sin_x), sin_x);
+
+            const vmask negate_cos = has_bit(increment(quadrant), 2);
+            c = select(negate_cos, sub(zero, cos_x), cos_x);
+        }
+    }  // namespace simd
+
+    using simd::vfloat;
+    using simd::vmask;
+}  // namespace
+
+void TransformBatch::flush()
+{
+    if (size_ == 0)
+        return;
+
+    // Pad the last vector with no-op quads.
+    const uint32_t count = (size_ + kLanes - 1) / kLanes * kLanes;
+    for (auto i = size_; i < count; ++i)
+    {
+        x0_[i] = 0.0F;
+        y0_[i] = 0.0F;
+        width_[i] = 0.0F;
+        height_[i] = 0.0F;
+        position_x_[i] = 0.0F;
+        position_y_[i] = 0.0F;
+        angle_[i] = 0.0F;
+        scale_x_[i] = 0.0F;
+        scale_y_[i] = 0.0F;
+    }
+
+    if (precision_ == Precision::Exact)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            sin_[i] = std::sin(-angle_[i]);
+            cos_[i] = std::cos(-angle_[i]);
+        }
+    }
+
+    const vfloat zero = simd::set1(0.0F);
+    const vfloat one = simd::set1(1.0F);
+    const vfloat almost_zero = simd::set1(kAlmostZero);
+    for (uint32_t i = 0; i < count; i += kLanes)
+    {
+        const vfloat angle = simd::load(angle_ + i);
+
+        vfloat sin_r;
+        vfloat cos_r;
+        if (precision_ == Precision::Exact)
+        {
+            sin_r = simd::load(sin_ + i);
+            cos_r = simd::load(cos_ + i);
+        }
+        else
+        {
+            simd::sincos(simd::sub(zero, angle), sin_r, cos_r);
+        }
+
+        // Unrotated quads are only scaled and translated, as in
+        // |transform_st|.
+        const vmask no_rotation = simd::less(simd::abs(angle), almost_zero);
+        sin_r = simd::select(no_rotation, zero, sin_r);
+        cos_r = simd::select(no_rotation, one, cos_r);
+
+        const vfloat scale_x = simd::load(scale_x_ + i);
+        const vfloat scale_y = simd::load(scale_y_ + i);
+        const vfloat s_sin_r_x = simd::mul(sin_r, scale_x);
+        const vfloat s_sin_r_y = simd::mul(sin_r, scale_y);
+        const vfloat s_cos_r_x = simd::mul(cos_r, scale_x);
+        const vfloat s_cos_r_y = simd::mul(cos_r, scale_y);
+
+        const vfloat position_x = simd::load(position_x_ + i);
+        const vfloat position_y = simd::load(position_y_ + i);
+
+        const vfloat x0 = simd::load(x0_ + i);
+        const vfloat y0 = simd::load(y0_ + i);
+        const vfloat x1 = simd::add(x0, simd::load(width_ + i));
+        const vfloat y1 = simd::add(y0, simd::load(height_ + i));
+        const vfloat xs[4]{x0, x1, x1, x0};
+        const vfloat ys[4]{y0, y0, y1, y1};
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            const vfloat& x = xs[corner];  // NOLINT
+            const vfloat& y = ys[corner];  // NOLINT
+            const vfloat x_cos = simd::mul(s_cos_r_x, x);
+            const vfloat y_sin = simd::mul(s_sin_r_y, y);
+            simd::store(out_x_[corner] + i,
+                        simd::add(simd::sub(x_cos, y_sin), position_x));
+
+            const vfloat x_sin = simd::mul(s_sin_r_x, x);
+            const vfloat y_cos = simd::mul(s_cos_r_y, y);
+            simd::store(out_y_[corner] + i,
+                        simd::add(simd::add(x_sin, y_cos), position_y));
+        }
+    }
+
+    for (uint32_t i = 0; i < size_; ++i)
+    {
+        auto vertices = vertices_[i];
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            vertices[corner].position.x = out_x_[corner][i];
+            vertices[corner].position.y = out_y_[corner][i];
+        }
+    }
+
+    size_ = 0;
+}
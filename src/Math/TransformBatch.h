@@ -0,0 +1,143 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef MATH_TRANSFORMBATCH_H_
+#define MATH_TRANSFORMBATCH_H_
+
+#include <cstdint>
+
+#include "Common/NonCopyable.h"
+#include "Math/Vec2.h"
+
+#if defined(__AVX2__)
+#    define RAINBOW_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define RAINBOW_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    define RAINBOW_SIMD_NEON
+#endif
+
+namespace rainbow
+{
+    struct SpriteVertex;
+
+    /// <summary>Transforms sprite quads in batches.</summary>
+    /// <remarks>
+    ///   <para>
+    ///     Quads are gathered into structure-of-arrays form, then transformed
+    ///     <c>kLanes</c> at a time using AVX2, SSE2 or NEON, whichever is
+    ///     available at compile time. Results are scattered back into the
+    ///     vertex arrays when the batch is full or flushed.
+    ///   </para>
+    ///   <para>
+    ///     With <c>Precision::Exact</c>, results match
+    ///     <see cref="transform"/> up to rounding. With
+    ///     <c>Precision::Fast</c>, sine and cosine are approximated with
+    ///     polynomials accurate to a few ulps.
+    ///   </para>
+    /// </remarks>
+    class TransformBatch : private NonCopyable<TransformBatch>
+    {
+    public:
+        enum class Precision
+        {
+            /// <summary>Use <c>std::sin</c> and <c>std::cos</c>.</summary>
+            Exact,
+
+            /// <summary>Use vectorised polynomial approximations.</summary>
+            Fast,
+        };
+
+#if defined(RAINBOW_SIMD_AVX2)
+        static constexpr uint32_t kLanes = 8;
+#elif defined(RAINBOW_SIMD_SSE2) || defined(RAINBOW_SIMD_NEON)
+        static constexpr uint32_t kLanes = 4;
+#else
+        static constexpr uint32_t kLanes = 1;
+#endif
+
+        /// <summary>Number of quads queued before flushing.</summary>
+        static constexpr uint32_t kCapacity = 64;
+
+        explicit TransformBatch(Precision precision = Precision::Fast)
+            : precision_(precision)
+        {
+        }
+
+        ~TransformBatch() { flush(); }
+
+        [[nodiscard]] auto precision() const { return precision_; }
+
+        /// <summary>Returns the number of queued quads.</summary>
+        [[nodiscard]] auto size() const { return size_; }
+
+        /// <summary>
+        ///   Queues <paramref name="sprite"/> for transformation into
+        ///   <paramref name="vertices"/>.
+        /// </summary>
+        template <typename T>
+        void add(const T& sprite, SpriteVertex* vertices)
+        {
+            add(sprite.width() * -sprite.pivot().x,
+                sprite.height() * (sprite.pivot().y - 1),
+                static_cast<float>(sprite.width()),
+                static_cast<float>(sprite.height()),
+                sprite.position(),
+                sprite.angle(),
+                sprite.scale(),
+                vertices);
+        }
+
+        /// <summary>
+        ///   Queues the quad at (<paramref name="x0"/>, <paramref name="y0"/>)
+        ///   for transformation into <paramref name="vertices"/>.
+        /// </summary>
+        void add(float x0,
+                 float y0,
+                 float width,
+                 float height,
+                 const Vec2f& position,
+                 float angle,
+                 const Vec2f& scale,
+                 SpriteVertex* vertices)
+        {
+            x0_[size_] = x0;
+            y0_[size_] = y0;
+            width_[size_] = width;
+            height_[size_] = height;
+            position_x_[size_] = position.x;
+            position_y_[size_] = position.y;
+            angle_[size_] = angle;
+            scale_x_[size_] = scale.x;
+            scale_y_[size_] = scale.y;
+            vertices_[size_] = vertices;
+            if (++size_ == kCapacity)
+                flush();
+        }
+
+        /// <summary>Transforms all queued quads.</summary>
+        void flush();
+
+    private:
+        alignas(32) float x0_[kCapacity];
+        alignas(32) float y0_[kCapacity];
+        alignas(32) float width_[kCapacity];
+        alignas(32) float height_[kCapacity];
+        alignas(32) float position_x_[kCapacity];
+        alignas(32) float position_y_[kCapacity];
+        alignas(32) float angle_[kCapacity];
+        alignas(32) float scale_x_[kCapacity];
+        alignas(32) float scale_y_[kCapacity];
+        alignas(32) float sin_[kCapacity];
+        alignas(32) float cos_[kCapacity];
+        alignas(32) float out_x_[4][kCapacity];
+        alignas(32) float out_y_[4][kCapacity];
+        SpriteVertex* vertices_[kCapacity];
+        uint32_t size_ = 0;
+        Precision precision_;
+    };
+}  // namespace rainbow
+
+#endif
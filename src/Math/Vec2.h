@@ -163,6 +163,11 @@ namespace rainbow
         {
             return a.x == b.x && a.y == b.y;
         }
+
+        friend auto operator!=(const Vec2& a, const Vec2& b) -> bool
+        {
+            return !(a == b);
+        }
     };
 
     template <typename T>
@@ -18,8 +18,18 @@ namespace rainbow
         GameBase(GameBase&&) noexcept = default;
         virtual ~GameBase() = default;
 
+        [[nodiscard]] auto font_cache() -> FontCache&
+        {
+            return director_.font_cache();
+        }
+
         [[nodiscard]] auto input() -> Input& { return director_.input(); }
 
+        [[nodiscard]] auto job_pool() -> JobPool&
+        {
+            return director_.job_pool();
+        }
+
         [[nodiscard]] auto render_queue() -> graphics::RenderQueue&
         {
             return director_.render_queue();
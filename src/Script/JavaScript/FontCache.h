@@ -0,0 +1,32 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef SCRIPT_JAVASCRIPT_FONTCACHE_H_
+#define SCRIPT_JAVASCRIPT_FONTCACHE_H_
+
+#include "Script/GameBase.h"
+#include "Script/JavaScript/Helper.h"
+
+namespace rainbow::duk
+{
+    void initialize_font_cache(duk_context* ctx, GameBase& engine)
+    {
+        duk::put_instance(ctx, duk_get_top(ctx) - 1, &engine);
+        duk_push_c_function(  //
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto args = duk::get_args<czstring, int, czstring>(ctx);
+                auto engine = duk::push_this<GameBase>(ctx);
+                engine->font_cache().prewarm(engine->job_pool(),
+                                             std::get<0>(args),
+                                             std::get<1>(args),
+                                             std::get<2>(args));
+                return 0;
+            },
+            3);
+        duk::put_prop_literal(ctx, -2, "prewarm");
+    }
+}  // namespace rainbow::duk
+
+#endif
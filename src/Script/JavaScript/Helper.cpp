@@ -234,5 +234,41 @@ void rainbow::duk::get_texture(duk_context* ctx,
                                graphics::Texture& texture)
 {
     new (&texture) graphics::Texture();
-    texture = get_engine(ctx).texture_provider().get(path);
+
+    auto& engine = get_engine(ctx);
+    if (!duk_is_function(ctx, 1))
+    {
+        texture = engine.texture_provider().get(path);
+        return;
+    }
+
+    // Keep both the texture and the callback alive until loaded.
+    duk_push_heap_stash(ctx);
+    duk_push_sprintf(ctx, "texture:%p", static_cast<void*>(&texture));
+    duk_push_array(ctx);
+    duk_push_this(ctx);
+    duk_put_prop_index(ctx, -2, 0);
+    duk_dup(ctx, 1);
+    duk_put_prop_index(ctx, -2, 1);
+    duk_put_prop(ctx, -3);
+    duk_pop(ctx);
+
+    auto on_load = [ctx, ptr = &texture](std::string_view, bool loaded) {
+        duk_push_heap_stash(ctx);
+        duk_push_sprintf(ctx, "texture:%p", static_cast<void*>(ptr));
+        duk_dup_top(ctx);
+        duk_get_prop(ctx, -3);
+        // => [ stash key [ texture callback ] ]
+        duk_swap_top(ctx, -2);
+        duk_del_prop(ctx, -3);
+        // => [ stash [ texture callback ] ]
+        duk_get_prop_index(ctx, -1, 1);
+        duk_get_prop_index(ctx, -2, 0);
+        duk_push_boolean(ctx, loaded);
+        // => [ stash [ texture callback ] callback texture loaded ]
+        duk_pcall(ctx, 2);
+        duk_pop_3(ctx);
+    };
+    texture = engine.texture_provider().get_async(
+        engine.job_pool(), path, std::move(on_load));
 }
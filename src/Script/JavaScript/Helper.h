@@ -17,6 +17,13 @@
 #include "Common/TypeInfo.h"
 #include "Graphics/Sprite.h"
 
+#define dukr_range_error(ctx, ...)                                             \
+    duk_error_raw((ctx),                                                       \
+                  DUK_ERR_RANGE_ERROR,                                         \
+                  DUK_FILE_MACRO,                                              \
+                  DUK_LINE_MACRO,                                              \
+                  __VA_ARGS__)
+
 #define dukr_type_error(ctx, ...)                                              \
     duk_error_raw((ctx),                                                       \
                   DUK_ERR_TYPE_ERROR,                                          \
@@ -9,6 +9,7 @@
 #include "FileSystem/FileSystem.h"
 #include "Script/JavaScript/Audio.h"
 #include "Script/JavaScript/Console.h"
+#include "Script/JavaScript/FontCache.h"
 #include "Script/JavaScript/Helper.h"
 #include "Script/JavaScript/Input.h"
 #include "Script/JavaScript/Module.h"
@@ -64,6 +65,10 @@ JavaScript::JavaScript(Director& director) : GameBase(director), context_(this)
 
     const auto rainbow = duk_push_bare_object(context_);
     duk::register_module(context_, rainbow, "Audio", &duk::initialize_audio);
+    duk::register_module(
+        context_, rainbow, "FontCache", [this](duk_context* ctx) {
+            duk::initialize_font_cache(ctx, *this);
+        });
     duk::register_module(context_, rainbow, "Input", [this](duk_context* ctx) {
         duk::initialize_input(ctx, input());
     });
@@ -13,6 +13,7 @@
 #include "Common/TypeCast.h"
 #include "Common/TypeInfo.h"
 #include "Graphics/Animation.h"
+#include "Graphics/InstancedSpriteBatch.h"
 #include "Graphics/Label.h"
 #include "Graphics/RenderQueue.h"
 #include "Graphics/Sprite.h"
@@ -22,6 +23,7 @@
 #include "Input/Input.h"
 #include "Input/VirtualKey.h"
 #include "Script/JavaScript/Helper.h"
+#include "Text/FontCache.h"
 
 #ifdef __GNUC__
 #    pragma GCC diagnostic push
@@ -241,6 +243,109 @@ void rainbow::duk::register_module<rainbow::ControllerButton>(duk_context* ctx,
     duk::put_prop_literal(ctx, rainbow, "ControllerButton");
 }
 
+template <>
+void rainbow::duk::register_module<rainbow::InstancedSpriteBatch>(duk_context* ctx, duk_idx_t rainbow)
+{
+    duk::push_constructor<InstancedSpriteBatch, uint32_t>(ctx);
+    duk::put_prototype<InstancedSpriteBatch, Allocation::HeapAllocated>(ctx, [](duk_context* ctx) {
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<InstancedSpriteBatch>(ctx);
+                auto result = obj->is_instanced();
+                duk::push(ctx, result);
+                return 1;
+            },
+            0);
+        duk::put_prop_literal(ctx, -2, "isInstanced");
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<InstancedSpriteBatch>(ctx);
+                auto result = obj->is_visible();
+                duk::push(ctx, result);
+                return 1;
+            },
+            0);
+        duk::put_prop_literal(ctx, -2, "isVisible");
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<InstancedSpriteBatch>(ctx);
+                auto args = duk::get_args<graphics::Texture*>(ctx);
+                obj->set_texture(std::get<0>(args));
+                return 0;
+            },
+            1);
+        duk::put_prop_literal(ctx, -2, "setTexture");
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<InstancedSpriteBatch>(ctx);
+                auto args = duk::get_args<bool>(ctx);
+                obj->set_visible(std::get<0>(args));
+                return 0;
+            },
+            1);
+        duk::put_prop_literal(ctx, -2, "setVisible");
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<InstancedSpriteBatch>(ctx);
+                obj->clear();
+                return 0;
+            },
+            0);
+        duk::put_prop_literal(ctx, -2, "clear");
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<InstancedSpriteBatch>(ctx);
+                auto args = duk::get_args<uint32_t, uint32_t>(ctx);
+                auto result = obj->create_sprite(std::get<0>(args), std::get<1>(args));
+                duk::push(ctx, result);
+                return 1;
+            },
+            2);
+        duk::put_prop_literal(ctx, -2, "createSprite");
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<InstancedSpriteBatch>(ctx);
+                auto args = duk::get_args<uint32_t>(ctx);
+                obj->erase(std::get<0>(args));
+                return 0;
+            },
+            1);
+        duk::put_prop_literal(ctx, -2, "erase");
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<InstancedSpriteBatch>(ctx);
+                auto args = duk::get_args<int>(ctx);
+                auto result = obj->find_sprite_by_id(std::get<0>(args));
+                duk::push(ctx, result);
+                return 1;
+            },
+            1);
+        duk::put_prop_literal(ctx, -2, "findSpriteById");
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<InstancedSpriteBatch>(ctx);
+                auto args = duk::get_args<SpriteRef, SpriteRef>(ctx);
+                obj->swap(std::get<0>(args), std::get<1>(args));
+                return 0;
+            },
+            2);
+        duk::put_prop_literal(ctx, -2, "swap");
+        duk::push_literal(ctx, "Rainbow.InstancedSpriteBatch");
+        duk::put_prop_literal(ctx, -2, DUKR_WELLKNOWN_SYMBOL_TOSTRINGTAG);
+    });
+    duk_freeze(ctx, -1);
+    duk::put_prop_literal(ctx, rainbow, "InstancedSpriteBatch");
+}
+
 template <>
 void rainbow::duk::register_module<rainbow::Label>(duk_context* ctx, duk_idx_t rainbow)
 {
@@ -744,6 +849,16 @@ void rainbow::duk::register_module<rainbow::SpriteBatch>(duk_context* ctx, duk_i
 {
     duk::push_constructor<SpriteBatch, uint32_t>(ctx);
     duk::put_prototype<SpriteBatch, Allocation::HeapAllocated>(ctx, [](duk_context* ctx) {
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<SpriteBatch>(ctx);
+                auto result = obj->is_culling();
+                duk::push(ctx, result);
+                return 1;
+            },
+            0);
+        duk::put_prop_literal(ctx, -2, "isCulling");
         duk_push_c_function(
             ctx,
             [](duk_context* ctx) -> duk_ret_t {
@@ -754,6 +869,16 @@ void rainbow::duk::register_module<rainbow::SpriteBatch>(duk_context* ctx, duk_i
             },
             0);
         duk::put_prop_literal(ctx, -2, "isVisible");
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<SpriteBatch>(ctx);
+                auto args = duk::get_args<bool>(ctx);
+                obj->set_culling(std::get<0>(args));
+                return 0;
+            },
+            1);
+        duk::put_prop_literal(ctx, -2, "setCulling");
         duk_push_c_function(
             ctx,
             [](duk_context* ctx) -> duk_ret_t {
@@ -859,8 +984,18 @@ void rainbow::duk::register_module<rainbow::TextAlignment>(duk_context* ctx, duk
 template <>
 void rainbow::duk::register_module<rainbow::graphics::Texture>(duk_context* ctx, duk_idx_t rainbow)
 {
-    duk::push_constructor<graphics::Texture, czstring>(ctx);
+    duk::push_constructor<graphics::Texture, czstring, graphics::TextureProvider::Callback>(ctx);
     duk::put_prototype<graphics::Texture, Allocation::HeapAllocated>(ctx, [](duk_context* ctx) {
+        duk_push_c_function(
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto obj = duk::push_this<graphics::Texture>(ctx);
+                auto result = obj->is_loaded();
+                duk::push(ctx, result);
+                return 1;
+            },
+            0);
+        duk::put_prop_literal(ctx, -2, "isLoaded");
         duk::push_literal(ctx, "Rainbow.Texture");
         duk::put_prop_literal(ctx, -2, DUKR_WELLKNOWN_SYMBOL_TOSTRINGTAG);
     });
@@ -1128,6 +1263,7 @@ namespace rainbow::duk
         duk::register_module<AnimationEvent>(ctx, obj_idx);
         duk::register_module<ControllerAxis>(ctx, obj_idx);
         duk::register_module<ControllerButton>(ctx, obj_idx);
+        duk::register_module<InstancedSpriteBatch>(ctx, obj_idx);
         duk::register_module<Label>(ctx, obj_idx);
         duk::register_module<SpriteRef>(ctx, obj_idx);
         duk::register_module<SpriteBatch>(ctx, obj_idx);
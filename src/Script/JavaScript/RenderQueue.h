@@ -5,6 +5,8 @@
 #ifndef SCRIPT_JAVASCRIPT_RENDERQUEUE_H_
 #define SCRIPT_JAVASCRIPT_RENDERQUEUE_H_
 
+#include <limits>
+
 #include "Graphics/RenderQueue.h"
 #include "Script/JavaScript/Helper.h"
 
@@ -75,11 +77,13 @@ namespace rainbow::duk
         auto render_queue_apply(duk_context* ctx,
                                 duk_idx_t obj_idx,
                                 ApplyFunction<Animation> fa,
+                                ApplyFunction<InstancedSpriteBatch> fi,
                                 ApplyFunction<Label> fl,
                                 ApplyFunction<SpriteBatch> fs) -> duk_ret_t
         {
             constexpr char kIncompatibleTypeForRenderUnit[] =
-                "Expected Animation, Label, SpriteBatch, or a drawable";
+                "Expected Animation, InstancedSpriteBatch, Label, SpriteBatch, "
+                "or a drawable";
 
             duk_require_type_mask(ctx, obj_idx, DUK_TYPE_MASK_OBJECT);
 
@@ -92,6 +96,8 @@ namespace rainbow::duk
             auto ptr = duk::push_instance<void*>(ctx, obj_idx);
             if (type == type_id<Animation>().value())
                 fa(ctx, q, *static_cast<Animation*>(ptr));
+            else if (type == type_id<InstancedSpriteBatch>().value())
+                fi(ctx, q, *static_cast<InstancedSpriteBatch*>(ptr));
             else if (type == type_id<Label>().value())
                 fl(ctx, q, *static_cast<Label*>(ptr));
             else if (type == type_id<SpriteBatch>().value())
@@ -102,6 +108,24 @@ namespace rainbow::duk
             return 0;
         }
 
+        /// <summary>
+        ///   Throws a range error unless the number at
+        ///   <paramref name="idx"/> fits in <typeparamref name="T"/>.
+        /// </summary>
+        template <typename T>
+        void require_range(duk_context* ctx, duk_idx_t idx, czstring name)
+        {
+            constexpr auto kMax = std::numeric_limits<T>::max();
+            const auto value = duk_require_number(ctx, idx);
+            if (!(value >= 0 && value < kMax + 1.0))
+            {
+                dukr_range_error(ctx,
+                                 "Expected '%s' to be between 0 and %u",
+                                 name,
+                                 static_cast<unsigned int>(kMax));
+            }
+        }
+
         template <typename T>
         void render_queue_insert(duk_context* ctx,
                                  graphics::RenderQueue& q,
@@ -123,6 +147,7 @@ namespace rainbow::duk
                     ctx,
                     0,
                     &render_queue_add<Animation>,
+                    &render_queue_add<InstancedSpriteBatch>,
                     &render_queue_add<Label>,
                     &render_queue_add<SpriteBatch>);
             },
@@ -179,12 +204,64 @@ namespace rainbow::duk
                 return render_queue_apply(ctx,
                                           1,
                                           &render_queue_insert<Animation>,
+                                          &render_queue_insert<
+                                              InstancedSpriteBatch>,
                                           &render_queue_insert<Label>,
                                           &render_queue_insert<SpriteBatch>);
             },
             2);
         duk::put_prop_literal(ctx, -2, "insert");
 
+        duk_push_c_function(  //
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                if (!duk_check_type(ctx, 1, DUK_TYPE_NUMBER))
+                    dukr_type_error(ctx, "Expected 'depth' to be a number");
+                require_range<uint8_t>(ctx, 1, "depth");
+
+                return render_queue_apply(
+                    ctx,
+                    0,
+                    [](duk_context* ctx,
+                       RenderQueue&,
+                       RenderQueue::iterator i) {
+                        i->set_depth(
+                            narrow_cast<uint8_t>(duk_require_uint(ctx, 1)));
+                    });
+            },
+            2);
+        duk::put_prop_literal(ctx, -2, "setDepth");
+
+        duk_push_c_function(  //
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                if (!duk_check_type(ctx, 1, DUK_TYPE_NUMBER))
+                    dukr_type_error(ctx, "Expected 'layer' to be a number");
+                require_range<uint16_t>(ctx, 1, "layer");
+
+                return render_queue_apply(
+                    ctx,
+                    0,
+                    [](duk_context* ctx,
+                       RenderQueue&,
+                       RenderQueue::iterator i) {
+                        i->set_layer(
+                            narrow_cast<uint16_t>(duk_require_uint(ctx, 1)));
+                    });
+            },
+            2);
+        duk::put_prop_literal(ctx, -2, "setLayer");
+
+        duk_push_c_function(  //
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto& q = *duk::push_this<RenderQueue>(ctx);
+                q.set_sorted(duk_require_boolean(ctx, 0));
+                return 0;
+            },
+            1);
+        duk::put_prop_literal(ctx, -2, "setSorted");
+
         duk_push_c_function(  //
             ctx,
             [](duk_context* ctx) -> duk_ret_t {
@@ -21,6 +21,12 @@ TEST(ConfigTest, NoConfiguration)
     ASSERT_FALSE(config.is_portrait());
     ASSERT_EQ(config.msaa(), 0u);
     ASSERT_TRUE(config.suspend());
+    ASSERT_EQ(config.worker_threads(), -1);
+    ASSERT_FALSE(config.texture_atlas());
+    ASSERT_EQ(config.texture_upload_budget(), 4096U * 1024);
+    ASSERT_FALSE(config.mipmaps());
+    ASSERT_EQ(config.skip_mip_levels(), 0U);
+    ASSERT_EQ(config.texture_memory_budget(), 0U);
 }
 
 TEST(ConfigTest, EmptyConfiguration)
@@ -61,6 +67,12 @@ TEST(ConfigTest, NormalConfiguration)
     ASSERT_EQ(c.msaa(), 4u);
     ASSERT_FALSE(c.needs_accelerometer());
     ASSERT_FALSE(c.suspend());
+    ASSERT_EQ(c.worker_threads(), 0);
+    ASSERT_FALSE(c.texture_atlas());
+    ASSERT_EQ(c.texture_upload_budget(), 0U);
+    ASSERT_FALSE(c.mipmaps());
+    ASSERT_EQ(c.skip_mip_levels(), 0U);
+    ASSERT_EQ(c.texture_memory_budget(), 0U);
 }
 
 TEST(ConfigTest, AlternateConfiguration)
@@ -75,6 +87,12 @@ TEST(ConfigTest, AlternateConfiguration)
     ASSERT_EQ(c.msaa(), 4u);
     ASSERT_TRUE(c.needs_accelerometer());
     ASSERT_TRUE(c.suspend());
+    ASSERT_EQ(c.worker_threads(), 3);
+    ASSERT_TRUE(c.texture_atlas());
+    ASSERT_EQ(c.texture_upload_budget(), 512U * 1024);
+    ASSERT_TRUE(c.mipmaps());
+    ASSERT_EQ(c.skip_mip_levels(), 2U);
+    ASSERT_EQ(c.texture_memory_budget(), 256U * 1024 * 1024);
 }
 
 TEST(ConfigTest, SparseConfiguration)
@@ -88,6 +106,7 @@ TEST(ConfigTest, SparseConfiguration)
     ASSERT_FALSE(c.is_portrait());
     ASSERT_EQ(c.msaa(), 8u);
     ASSERT_FALSE(c.suspend());
+    ASSERT_EQ(c.worker_threads(), -1);
 }
 
 TEST(ConfigTest, MissingValues)
@@ -101,4 +120,5 @@ TEST(ConfigTest, MissingValues)
     ASSERT_FALSE(config.is_portrait());
     ASSERT_EQ(config.msaa(), 0u);
     ASSERT_TRUE(config.suspend());
+    ASSERT_EQ(config.worker_threads(), -1);
 }
@@ -32,6 +32,27 @@ TEST(DecodersTest, DetectsDDS)
 }
 #endif  // USE_DDS
 
+namespace ktx
+{
+    extern bool check(const Data& data);
+}
+
+TEST(DecodersTest, DetectsKTX)
+{
+    constexpr uint8_t kKTXSignature[]{
+        0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+    constexpr uint8_t kKTX2Signature[]{
+        0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+    constexpr uint8_t kNotKTXSignature[]{
+        0xAB, 'K', 'T', 'X', ' ', '3', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    ASSERT_TRUE(ktx::check(Data::from_bytes(kKTXSignature)));
+    ASSERT_TRUE(ktx::check(Data::from_bytes(kKTX2Signature)));
+    ASSERT_FALSE(ktx::check(Data::from_bytes(kNotKTXSignature)));
+    ASSERT_FALSE(
+        ktx::check(Data{kKTXSignature, 6, Data::Ownership::Reference}));
+}
+
 namespace png
 {
     extern bool check(const Data& data);
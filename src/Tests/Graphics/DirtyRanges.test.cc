@@ -0,0 +1,84 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/DirtyRanges.h"
+
+#include <gtest/gtest.h>
+
+using rainbow::graphics::DirtyRanges;
+
+namespace
+{
+    void assert_range(const DirtyRanges::Range& range,
+                      uint32_t first,
+                      uint32_t last)
+    {
+        ASSERT_EQ(range.first, first);
+        ASSERT_EQ(range.last, last);
+    }
+}  // namespace
+
+TEST(DirtyRangesTest, IsEmptyByDefault)
+{
+    DirtyRanges ranges;
+
+    ASSERT_TRUE(ranges.empty());
+    ASSERT_EQ(ranges.size(), 0U);
+    ASSERT_EQ(ranges.gap(), DirtyRanges::kDefaultGap);
+}
+
+TEST(DirtyRangesTest, MergesConsecutiveElements)
+{
+    DirtyRanges ranges;
+    ranges.set_gap(0);
+    for (uint32_t i = 4; i < 8; ++i)
+        ranges.add(i);
+
+    ASSERT_EQ(ranges.size(), 1U);
+    assert_range(*ranges.begin(), 4, 8);
+    ASSERT_EQ(ranges.begin()->size(), 4U);
+}
+
+TEST(DirtyRangesTest, CoalescesRangesWithinGap)
+{
+    DirtyRanges ranges;
+    ranges.set_gap(2);
+    ranges.add(0);
+    ranges.add(3);  // 2 clean elements in between; coalesced
+    ranges.add(7);  // 3 clean elements in between; kept apart
+    ranges.add(8);
+    ranges.add(20);
+
+    ASSERT_EQ(ranges.size(), 3U);
+
+    auto i = ranges.begin();
+    assert_range(*i++, 0, 4);
+    assert_range(*i++, 7, 9);
+    assert_range(*i++, 20, 21);
+    ASSERT_EQ(i, ranges.end());
+}
+
+TEST(DirtyRangesTest, IgnoresDuplicates)
+{
+    DirtyRanges ranges;
+    ranges.add(5);
+    ranges.add(6);
+    ranges.add(6);
+
+    ASSERT_EQ(ranges.size(), 1U);
+    assert_range(*ranges.begin(), 5, 7);
+}
+
+TEST(DirtyRangesTest, ClearsRanges)
+{
+    DirtyRanges ranges;
+    ranges.add(1);
+    ranges.add(100);
+
+    ASSERT_FALSE(ranges.empty());
+
+    ranges.clear();
+
+    ASSERT_TRUE(ranges.empty());
+}
@@ -0,0 +1,220 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/DrawMerger.h"
+
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "Common/Data.h"
+#include "Graphics/Animation.h"
+#include "Graphics/Drawable.h"
+#include "Graphics/RenderLayer.h"
+#include "Graphics/SpriteBatch.h"
+#include "Tests/TestHelpers.h"
+
+using namespace rainbow::graphics;
+using namespace std::literals::string_view_literals;
+
+using rainbow::Animation;
+using rainbow::Data;
+using rainbow::GameBase;
+using rainbow::IDrawable;
+using rainbow::ISolemnlySwearThatIAmOnlyTesting;
+using rainbow::SpriteBatch;
+using rainbow::SpriteRef;
+
+namespace
+{
+    constexpr const char kMockImageData[] = "RNBWMOCK";  // NOLINT
+
+    struct MockTextureAllocator final : public ITextureAllocator
+    {
+        int current_id = 0;  // NOLINT
+
+        void construct(TextureHandle& handle,
+                       const rainbow::Image&,
+                       Filter,
+                       Filter) override
+        {
+            handle[0] = ++current_id;
+        }
+
+        void destroy(TextureHandle&) override {}
+
+        [[maybe_unused, nodiscard]]
+        auto max_size() const noexcept -> size_t override
+        {
+            return sizeof(current_id);
+        }
+
+        void update(const TextureHandle&,
+                    const rainbow::Image&,
+                    Filter,
+                    Filter) override
+        {
+        }
+
+        void update_region(const TextureHandle&,
+                           uint32_t,
+                           uint32_t,
+                           const rainbow::Image&) override
+        {
+        }
+    };
+
+    class TestDrawable : public IDrawable
+    {
+    private:
+        void draw_impl(Context&) const override {}
+        void update_impl(GameBase&, uint64_t) override {}
+    };
+
+    class DrawMergerTest : public ::testing::Test
+    {
+    protected:
+        MockTextureAllocator allocator_;
+        TextureProvider provider_{allocator_};
+        Texture atlas_;
+        Texture other_atlas_;
+        std::array<SpriteBatch, 4> batches_{
+            SpriteBatch{ISolemnlySwearThatIAmOnlyTesting{}},
+            SpriteBatch{ISolemnlySwearThatIAmOnlyTesting{}},
+            SpriteBatch{ISolemnlySwearThatIAmOnlyTesting{}},
+            SpriteBatch{ISolemnlySwearThatIAmOnlyTesting{}},
+        };
+        std::vector<DrawMerger::Run> runs_;
+
+        void SetUp() override
+        {
+            auto mock_image = Data::from_literal(kMockImageData);
+            atlas_ = provider_.get("atlas"sv, mock_image);
+            other_atlas_ = provider_.get("other_atlas"sv, mock_image);
+
+            for (auto&& batch : batches_)
+            {
+                batch.set_texture(atlas_);
+                batch.create_sprite(1, 1);
+                batch.create_sprite(1, 1);
+            }
+        }
+
+        void TearDown() override
+        {
+            for (auto&& batch : batches_)
+                batch.clear();
+        }
+    };
+}  // namespace
+
+TEST_F(DrawMergerTest, MergesConsecutiveUnitsWithSameTexture)
+{
+    RenderQueue queue{batches_[0], batches_[1], batches_[2]};
+    DrawMerger::compile(queue, 4096, runs_);
+
+    ASSERT_EQ(runs_.size(), 1U);
+    ASSERT_EQ(runs_[0].first, 0U);
+    ASSERT_EQ(runs_[0].last, 3U);
+    ASSERT_EQ(runs_[0].units, 3U);
+    ASSERT_EQ(runs_[0].sprites, 6U);
+    ASSERT_EQ(runs_[0].texture, &atlas_);
+}
+
+TEST_F(DrawMergerTest, DoesNotMergeSingleUnits)
+{
+    RenderQueue queue{batches_[0]};
+    DrawMerger::compile(queue, 4096, runs_);
+
+    ASSERT_TRUE(runs_.empty());
+}
+
+TEST_F(DrawMergerTest, SplitsRunsOnTextureChange)
+{
+    batches_[2].set_texture(other_atlas_);
+
+    RenderQueue queue{batches_[0], batches_[1], batches_[2], batches_[3]};
+    DrawMerger::compile(queue, 4096, runs_);
+
+    ASSERT_EQ(runs_.size(), 1U);
+    ASSERT_EQ(runs_[0].first, 0U);
+    ASSERT_EQ(runs_[0].last, 2U);
+    ASSERT_EQ(runs_[0].units, 2U);
+}
+
+TEST_F(DrawMergerTest, SplitsRunsOnDrawables)
+{
+    TestDrawable drawable;
+    RenderQueue queue{
+        batches_[0], batches_[1], drawable, batches_[2], batches_[3]};
+    DrawMerger::compile(queue, 4096, runs_);
+
+    ASSERT_EQ(runs_.size(), 2U);
+    ASSERT_EQ(runs_[0].first, 0U);
+    ASSERT_EQ(runs_[0].last, 2U);
+    ASSERT_EQ(runs_[1].first, 3U);
+    ASSERT_EQ(runs_[1].last, 5U);
+}
+
+TEST_F(DrawMergerTest, SplitsRunsOnRenderLayers)
+{
+    RenderLayer empty;
+    RenderLayer layer;
+    layer.queue().emplace_back(batches_[3]);
+
+    RenderQueue queue{batches_[0], empty, batches_[1], layer, batches_[2]};
+    DrawMerger::compile(queue, 4096, runs_);
+
+    ASSERT_EQ(runs_.size(), 1U);
+    ASSERT_EQ(runs_[0].first, 0U);
+    ASSERT_EQ(runs_[0].last, 3U);
+    ASSERT_EQ(runs_[0].units, 2U);
+}
+
+TEST_F(DrawMergerTest, SplitsRunsOnCullingBatches)
+{
+    batches_[2].set_culling(true);
+
+    RenderQueue queue{batches_[0], batches_[1], batches_[2], batches_[3]};
+    DrawMerger::compile(queue, 4096, runs_);
+
+    ASSERT_EQ(runs_.size(), 1U);
+    ASSERT_EQ(runs_[0].first, 0U);
+    ASSERT_EQ(runs_[0].last, 2U);
+    ASSERT_EQ(runs_[0].units, 2U);
+}
+
+TEST_F(DrawMergerTest, SkipsUnitsThatDrawNothing)
+{
+    Animation animation(SpriteRef{}, {}, 1);
+    batches_[1].set_visible(false);
+    batches_[3].clear();
+
+    RenderQueue queue{
+        batches_[0], batches_[1], animation, batches_[2], batches_[3]};
+    queue[3].disable();
+    queue.emplace_back(batches_[2]);
+
+    DrawMerger::compile(queue, 4096, runs_);
+
+    ASSERT_EQ(runs_.size(), 1U);
+    ASSERT_EQ(runs_[0].first, 0U);
+    ASSERT_EQ(runs_[0].last, 6U);
+    ASSERT_EQ(runs_[0].units, 2U);
+    ASSERT_EQ(runs_[0].sprites, 4U);
+}
+
+TEST_F(DrawMergerTest, SplitsRunsExceedingMaxSprites)
+{
+    RenderQueue queue{batches_[0], batches_[1], batches_[2], batches_[3]};
+    DrawMerger::compile(queue, 5, runs_);
+
+    ASSERT_EQ(runs_.size(), 2U);
+    ASSERT_EQ(runs_[0].first, 0U);
+    ASSERT_EQ(runs_[0].last, 2U);
+    ASSERT_EQ(runs_[0].sprites, 4U);
+    ASSERT_EQ(runs_[1].first, 2U);
+    ASSERT_EQ(runs_[1].last, 4U);
+    ASSERT_EQ(runs_[1].sprites, 4U);
+}
@@ -4,13 +4,22 @@
 
 #include "Graphics/Image.h"
 
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "Common/Algorithm.h"
 #include "Common/Data.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileSystem.h"
 #include "Graphics/OpenGL.h"
 #include "Resources/Rainbow.svg.h"
+#include "Tests/TestHelpers.h"
 #include "Tests/__fixtures/ImageTest/Images.h"
+#include "Threading/JobPool.h"
 
 using namespace rainbow;
 using namespace rainbow::test;
@@ -92,6 +101,36 @@ TEST(ImageTest, LoadsPNGs_32BitColor)
     ASSERT_EQ(image.size, image.width * image.height * 4U);
 }
 
+TEST(ImageTest, DecodesPNGsIntoBuffers)
+{
+    const Data data{fixtures::basn6a08_png.data(),
+                    fixtures::basn6a08_png.size(),
+                    Data::Ownership::Reference};
+    const auto header = Image::probe(data);
+
+    ASSERT_EQ(header.format, Image::Format::RGBA);
+    ASSERT_EQ(header.width, 32U);
+    ASSERT_EQ(header.height, 32U);
+    ASSERT_EQ(header.size, header.width * header.height * 4U);
+    ASSERT_EQ(header.data, nullptr);
+
+    std::vector<uint8_t> buffer(header.size);
+    const auto image = Image::decode_into(data, buffer.data());
+    const auto decoded = Image::decode(data, 1.0F);
+
+    ASSERT_EQ(image.format, Image::Format::RGBA);
+    ASSERT_EQ(image.data, buffer.data());
+    ASSERT_EQ(image.size, header.size);
+    ASSERT_TRUE(std::equal(buffer.begin(), buffer.end(), decoded.data));
+
+    // Grayscale with alpha would only grow if expanded.
+    const auto gray = Image::probe({fixtures::basn4a08_png.data(),
+                                    fixtures::basn4a08_png.size(),
+                                    Data::Ownership::Reference});
+
+    ASSERT_EQ(gray.format, Image::Format::Unknown);
+}
+
 TEST(ImageTest, LoadsSVGs)
 {
     auto image = Image::decode(
@@ -105,3 +144,317 @@ TEST(ImageTest, LoadsSVGs)
     ASSERT_EQ(image.channels, 4U);
     ASSERT_EQ(image.size, image.width * image.height * 4U);
 }
+
+TEST(ImageTest, RasterizesSVGsInTiles)
+{
+    const Data logo{
+        assets::kLogo, sizeof(assets::kLogo), Data::Ownership::Reference};
+    const auto image = Image::decode(logo, 0.25F);
+
+    JobPool job_pool{3};
+    const auto tiled = Image::decode(logo, 0.25F, &job_pool);
+
+    ASSERT_EQ(tiled.width, image.width);
+    ASSERT_EQ(tiled.height, image.height);
+    ASSERT_EQ(tiled.size, image.size);
+
+    // Tiles are translated separately, and fully transparent pixels take
+    // their colour from neighbours; allow for some rounding.
+    for (size_t i = 0; i < image.size; i += 4)
+    {
+        const auto alpha = image.data[i + 3];
+        ASSERT_NEAR(tiled.data[i + 3], alpha, 2);
+        if (alpha == 0xff)
+        {
+            ASSERT_NEAR(tiled.data[i], image.data[i], 2);
+            ASSERT_NEAR(tiled.data[i + 1], image.data[i + 1], 2);
+            ASSERT_NEAR(tiled.data[i + 2], image.data[i + 2], 2);
+        }
+    }
+}
+
+TEST(ImageTest, CachesRasterizedSVGs)
+{
+    ScopedAssetsDirectory scoped_assets{"ImageTest"};
+
+    const Data logo{
+        assets::kLogo, sizeof(assets::kLogo), Data::Ownership::Reference};
+    const auto image = Image::decode(logo, 0.125F);
+
+    auto files = PHYSFS_enumerateFiles("SVGCache");
+    ASSERT_NE(files, nullptr);
+    ASSERT_NE(files[0], nullptr);
+    ASSERT_EQ(files[1], nullptr);
+
+    const auto path = std::string{"SVGCache/"} + files[0];
+    PHYSFS_freeList(files);
+
+    // Tamper with the cached copy to tell it apart from a new rasterization.
+    auto cached = File::read(path.c_str(), FileType::UserFile);
+    ASSERT_GT(cached.size(), image.size);
+
+    cached.bytes()[cached.size() - 1] ^= 0xff;
+    WriteableFile::write(path.c_str(), cached);
+
+    const auto second = Image::decode(logo, 0.125F);
+    filesystem::remove(path.c_str());
+    filesystem::remove("SVGCache");
+
+    ASSERT_EQ(second.format, Image::Format::SVG);
+    ASSERT_EQ(second.width, image.width);
+    ASSERT_EQ(second.height, image.height);
+    ASSERT_EQ(second.size, image.size);
+    ASSERT_TRUE(
+        std::equal(image.data, image.data + image.size - 1, second.data));
+    ASSERT_NE(second.data[second.size - 1], image.data[image.size - 1]);
+}
+
+TEST(ImageTest, BuildsMipChains)
+{
+    // clang-format off
+    constexpr uint8_t kPixels[]{
+          0,   0,   0, 255,  100, 100, 100, 255,
+         10,  20,  30,  40,   10,  20,  30,  40,
+        200, 200, 200, 255,   80,  80,  80, 255,
+         10,  20,  30,  40,   10,  20,  30,  40,
+    };
+    // clang-format on
+
+    auto image = Image::with_mipmaps(
+        Image{Image::Format::RGBA, 4, 2, 32, 4, sizeof(kPixels), kPixels},
+        0,
+        true);
+
+    ASSERT_EQ(image.format, Image::Format::PNG);
+    ASSERT_EQ(image.width, 4U);
+    ASSERT_EQ(image.height, 2U);
+    ASSERT_EQ(image.mip_levels, 3U);
+    ASSERT_EQ(image.level_offset(1), sizeof(kPixels));
+    ASSERT_EQ(image.level_offset(2), sizeof(kPixels) + 2 * 4);
+    ASSERT_EQ(image.size, sizeof(kPixels) + 2 * 4 + 4);
+    ASSERT_TRUE(std::equal(std::begin(kPixels), std::end(kPixels), image.data));
+
+    const uint8_t* level1 = image.data + image.level_offset(1);
+    const uint8_t kLevel1[]{95, 95, 95, 255, 10, 20, 30, 40};
+    ASSERT_TRUE(std::equal(std::begin(kLevel1), std::end(kLevel1), level1));
+
+    const uint8_t* level2 = image.data + image.level_offset(2);
+    const uint8_t kLevel2[]{53, 58, 63, 148};
+    ASSERT_TRUE(std::equal(std::begin(kLevel2), std::end(kLevel2), level2));
+}
+
+TEST(ImageTest, SkipsTopMipLevels)
+{
+    constexpr uint8_t kPixels[4 * 4 * 4]{};
+
+    auto image = Image::with_mipmaps(
+        Image{Image::Format::RGBA, 4, 4, 32, 4, sizeof(kPixels), kPixels},
+        1,
+        false);
+
+    ASSERT_EQ(image.width, 2U);
+    ASSERT_EQ(image.height, 2U);
+    ASSERT_EQ(image.mip_levels, 1U);
+    ASSERT_EQ(image.size, 2U * 2 * 4);
+
+    auto chain = Image::with_mipmaps(
+        Image{Image::Format::RGBA, 4, 4, 32, 4, sizeof(kPixels), kPixels},
+        5,
+        true);
+
+    ASSERT_EQ(chain.width, 1U);
+    ASSERT_EQ(chain.height, 1U);
+    ASSERT_EQ(chain.mip_levels, 1U);
+    ASSERT_EQ(chain.size, 4U);
+}
+
+TEST(ImageTest, SkipsBakedMipLevelsOfCompressedImages)
+{
+    constexpr uint8_t kBlocks[512 + 128 + 32 + 8 + 8 + 8]{};
+
+    Image compressed{
+        Image::Format::BC1, 32, 32, 1, 3, sizeof(kBlocks), kBlocks};
+    compressed.mip_levels = 6;
+
+    ASSERT_EQ(compressed.level_size(0), 512U);
+    ASSERT_EQ(compressed.level_size(3), 8U);
+    ASSERT_EQ(compressed.level_size(5), 8U);
+    ASSERT_EQ(compressed.level_offset(6), sizeof(kBlocks));
+
+    auto image = Image::with_mipmaps(std::move(compressed), 2, true);
+
+    ASSERT_EQ(image.format, Image::Format::BC1);
+    ASSERT_EQ(image.width, 8U);
+    ASSERT_EQ(image.height, 8U);
+    ASSERT_EQ(image.mip_levels, 4U);
+    ASSERT_EQ(image.data, kBlocks + 512 + 128);
+    ASSERT_EQ(image.size, 32U + 8 + 8 + 8);
+
+    auto single = Image::with_mipmaps(std::move(image), 0, false);
+
+    ASSERT_EQ(single.mip_levels, 1U);
+    ASSERT_EQ(single.size, 32U);
+}
+
+namespace
+{
+    template <typename T>
+    void append(std::vector<uint8_t>& buffer, T value)
+    {
+        auto bytes = reinterpret_cast<const uint8_t*>(&value);  // NOLINT
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+    }
+
+    auto ktx_header(std::string_view version)
+    {
+        std::vector<uint8_t> ktx{0xAB, 'K', 'T', 'X', ' '};
+        ktx.insert(ktx.end(), version.begin(), version.end());
+        ktx.insert(ktx.end(), {0xBB, '\r', '\n', 0x1A, '\n'});
+        return ktx;
+    }
+
+    /// <summary>
+    ///   Returns a KTX file with the specified levels, each filled with its
+    ///   level number.
+    /// </summary>
+    auto make_ktx(uint32_t internal_format,
+                  uint32_t width,
+                  uint32_t height,
+                  const std::vector<uint32_t>& level_sizes)
+    {
+        auto ktx = ktx_header("11");
+        append(ktx, 0x04030201U);  // endianness
+        append(ktx, 0U);           // glType
+        append(ktx, 1U);           // glTypeSize
+        append(ktx, 0U);           // glFormat
+        append(ktx, internal_format);
+        append(ktx, 0U);  // glBaseInternalFormat
+        append(ktx, width);
+        append(ktx, height);
+        append(ktx, 0U);  // pixelDepth
+        append(ktx, 0U);  // numberOfArrayElements
+        append(ktx, 1U);  // numberOfFaces
+        append(ktx, static_cast<uint32_t>(level_sizes.size()));
+        append(ktx, 4U);  // bytesOfKeyValueData
+        append(ktx, 0U);
+        for (size_t i = 0; i < level_sizes.size(); ++i)
+        {
+            append(ktx, level_sizes[i]);
+            ktx.insert(ktx.end(), level_sizes[i], static_cast<uint8_t>(i));
+        }
+        return ktx;
+    }
+
+    /// <summary>
+    ///   Returns a KTX2 file with the specified levels, each filled with its
+    ///   level number and stored smallest first.
+    /// </summary>
+    auto make_ktx2(uint32_t vk_format,
+                   uint32_t width,
+                   uint32_t height,
+                   const std::vector<uint32_t>& level_sizes)
+    {
+        const auto levels = static_cast<uint32_t>(level_sizes.size());
+        auto ktx = ktx_header("20");
+        append(ktx, vk_format);
+        append(ktx, 1U);  // typeSize
+        append(ktx, width);
+        append(ktx, height);
+        append(ktx, 0U);  // pixelDepth
+        append(ktx, 0U);  // layerCount
+        append(ktx, 1U);  // faceCount
+        append(ktx, levels);
+        append(ktx, 0U);  // supercompressionScheme
+        for (int i = 0; i < 4; ++i)
+            append(ktx, 0U);  // DFD and key/value data
+        append(ktx, uint64_t{0});  // sgdByteOffset
+        append(ktx, uint64_t{0});  // sgdByteLength
+
+        uint64_t offset = ktx.size() + levels * sizeof(uint64_t) * 3;
+        std::vector<uint64_t> offsets(levels);
+        for (auto i = levels; i > 0; --i)
+        {
+            offsets[i - 1] = offset;
+            offset += level_sizes[i - 1];
+        }
+
+        for (uint32_t i = 0; i < levels; ++i)
+        {
+            append(ktx, offsets[i]);
+            append(ktx, uint64_t{level_sizes[i]});
+            append(ktx, uint64_t{level_sizes[i]});
+        }
+
+        for (auto i = levels; i > 0; --i)
+        {
+            ktx.insert(
+                ktx.end(), level_sizes[i - 1], static_cast<uint8_t>(i - 1));
+        }
+        return ktx;
+    }
+}  // namespace
+
+TEST(ImageTest, LoadsKTXs)
+{
+    constexpr uint32_t kCompressedRGBA8ETC2 = 0x9278;
+    const auto ktx = make_ktx(kCompressedRGBA8ETC2, 8, 8, {64, 16, 16, 16});
+    auto image = Image::decode(
+        {ktx.data(), ktx.size(), Data::Ownership::Reference}, 1.0F);
+
+    ASSERT_EQ(image.format, Image::Format::ETC2);
+    ASSERT_EQ(image.width, 8U);
+    ASSERT_EQ(image.height, 8U);
+    ASSERT_EQ(image.channels, 4U);
+    ASSERT_EQ(image.mip_levels, 4U);
+    ASSERT_EQ(image.size, 64U + 16 + 16 + 16);
+    ASSERT_EQ(image.data, ktx.data());
+    for (uint32_t level = 0; level < image.mip_levels; ++level)
+        ASSERT_EQ(image.data[image.level_offset(level)], level);
+
+    auto skipped = Image::with_mipmaps(std::move(image), 1, false);
+
+    ASSERT_EQ(skipped.width, 4U);
+    ASSERT_EQ(skipped.mip_levels, 1U);
+    ASSERT_EQ(skipped.size, 16U);
+    ASSERT_EQ(skipped.data[skipped.level_offset(0)], 1U);
+}
+
+TEST(ImageTest, LoadsKTX2s)
+{
+    constexpr uint32_t kASTC6x6UNorm = 165;
+    const auto ktx = make_ktx2(kASTC6x6UNorm, 12, 12, {64, 16, 16, 16});
+    auto image = Image::decode(
+        {ktx.data(), ktx.size(), Data::Ownership::Reference}, 1.0F);
+
+    ASSERT_EQ(image.format, Image::Format::ASTC);
+    ASSERT_EQ(image.width, 12U);
+    ASSERT_EQ(image.height, 12U);
+    ASSERT_EQ(image.block_width, 6U);
+    ASSERT_EQ(image.block_height, 6U);
+    ASSERT_EQ(image.mip_levels, 4U);
+    ASSERT_EQ(image.size, 64U + 16 + 16 + 16);
+    for (uint32_t level = 0; level < image.mip_levels; ++level)
+        ASSERT_EQ(image.data[image.level_offset(level)], level);
+
+    auto skipped = Image::with_mipmaps(std::move(image), 2, true);
+
+    ASSERT_EQ(skipped.width, 3U);
+    ASSERT_EQ(skipped.mip_levels, 2U);
+    ASSERT_EQ(skipped.size, 32U);
+    ASSERT_EQ(skipped.data[skipped.level_offset(0)], 2U);
+    ASSERT_EQ(skipped.data[skipped.level_offset(1)], 3U);
+}
+
+TEST(ImageTest, LoadsSingleLevelKTX2s)
+{
+    constexpr uint32_t kBC7UNorm = 145;
+    const auto ktx = make_ktx2(kBC7UNorm, 8, 4, {32});
+    auto image = Image::decode(
+        {ktx.data(), ktx.size(), Data::Ownership::Reference}, 1.0F);
+
+    ASSERT_EQ(image.format, Image::Format::BC7);
+    ASSERT_EQ(image.mip_levels, 1U);
+    ASSERT_EQ(image.size, 32U);
+    ASSERT_TRUE(image.level_offsets.empty());
+    ASSERT_EQ(image.data, ktx.data() + ktx.size() - 32);
+}
@@ -66,9 +66,13 @@ TEST(RenderQueueTest, UnitsHaveReasonableDefaults)
     RenderQueue queue{drawables[0]};
     queue.emplace_back(drawables[1], tag2);
 
+    ASSERT_FALSE(queue.is_sorted());
+
     const auto& unit1 = queue.front();
 
     ASSERT_TRUE(unit1.is_enabled());
+    ASSERT_EQ(unit1.layer(), 0);
+    ASSERT_EQ(unit1.depth(), 0);
     ASSERT_TRUE(unit1.tag().empty());
 
     const auto& unit2 = queue.back();
@@ -157,3 +161,36 @@ TEST(RenderQueueTest, VisitsEnabledUnitsOnly)
             return drawable.draw_count() == 0;
         }));
 }
+
+TEST(RenderQueueTest, SortsByLayerThenDepth)
+{
+    std::array<TestDrawable, 6> drawables;
+    RenderQueue queue;
+    for (auto&& drawable : drawables)
+        queue.emplace_back(drawable);
+
+    queue[0].set_layer(3);
+    queue[1].set_layer(1);
+    queue[1].set_depth(2);
+    queue[2].set_layer(1);
+    queue[2].set_depth(1);
+    queue[3].set_layer(0x100);
+    queue[4].set_layer(1);
+    queue[4].set_depth(1);
+
+    ASSERT_TRUE(queue.sort());
+
+    const std::array<size_t, 6> expected{5, 2, 4, 1, 0, 3};
+    for (size_t i = 0; i < expected.size(); ++i)
+        ASSERT_EQ(queue[i], RenderUnit{drawables[expected[i]]});
+
+    // Sorting is stable; units with equal keys keep their relative order.
+    ASSERT_EQ(queue[1].sort_key(), queue[2].sort_key());
+    ASSERT_FALSE(queue.sort());
+
+    queue.front().set_layer(4);
+
+    ASSERT_TRUE(queue.sort());
+    ASSERT_EQ(queue[4], RenderUnit{drawables[5]});
+    ASSERT_EQ(queue[5], RenderUnit{drawables[3]});
+}
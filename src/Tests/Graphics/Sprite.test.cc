@@ -4,18 +4,24 @@
 
 #include "Graphics/Sprite.h"
 
+#include <array>
+#include <cmath>
 #include <functional>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "Graphics/StaleSprites.h"
 #include "Graphics/Texture.h"
 #include "Tests/TestHelpers.h"
 
 using rainbow::Color;
 using rainbow::Sprite;
+using rainbow::SpriteInstance;
 using rainbow::SpriteRef;
 using rainbow::SpriteVertex;
 using rainbow::Vec2f;
+using rainbow::graphics::StaleSprites;
 using rainbow::graphics::TextureData;
 
 namespace
@@ -641,7 +647,169 @@ TEST(SpriteTest, UpdatesOnlyOnChange)
     ASSERT_FALSE(sprite.update(vertex_array, mock_texture()));
 }
 
+TEST(SpriteTest, InstanceExpandsToSameQuad)
+{
+    constexpr Vec2f kCorners[]{{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    constexpr float kUnorm16 = 1.0F / 65535;
+
+    for (int variant = 0; variant < 4; ++variant)
+    {
+        Sprite sprites[]{{3, 5}, {3, 5}};
+        for (auto&& sprite : sprites)
+        {
+            sprite.position({32, 16});
+            sprite.pivot({0.25F, 0.75F});
+            sprite.scale({2, 0.5F});
+            sprite.rotate(0.6F);
+            sprite.color({0xff, 0x80, 0x40, 0x20});
+            sprite.texture({4, 8, 12, 16});
+            if ((variant & 1) != 0)
+                sprite.flip();
+            if ((variant & 2) != 0)
+                sprite.mirror();
+        }
+
+        SpriteVertex vertex_array[4];
+        SpriteInstance instance;
+
+        ASSERT_TRUE(sprites[0].update(vertex_array, mock_texture()));
+        ASSERT_TRUE(sprites[1].update(instance, mock_texture()));
+        ASSERT_FALSE(sprites[1].update(instance, mock_texture()));
+        ASSERT_EQ(instance.color, vertex_array[0].color);
+
+        // Expand the instance the same way Instanced2D.vert does.
+        const float s = std::sin(-instance.angle);
+        const float c = std::cos(-instance.angle);
+        const Vec2f uv0{instance.texcoords[0] * kUnorm16,
+                        instance.texcoords[1] * kUnorm16};
+        const Vec2f uv2{instance.texcoords[2] * kUnorm16,
+                        instance.texcoords[3] * kUnorm16};
+        for (int i = 0; i < 4; ++i)
+        {
+            const auto& corner = kCorners[i];
+            const Vec2f p{instance.origin.x + corner.x * instance.extent.x,
+                          instance.origin.y + corner.y * instance.extent.y};
+
+            ASSERT_NEAR(c * p.x - s * p.y + instance.position.x,
+                        vertex_array[i].position.x,
+                        0.0001F);
+            ASSERT_NEAR(s * p.x + c * p.y + instance.position.y,
+                        vertex_array[i].position.y,
+                        0.0001F);
+            ASSERT_NEAR(uv0.x + corner.x * (uv2.x - uv0.x),
+                        vertex_array[i].texcoord.x,
+                        kUnorm16);
+            ASSERT_NEAR(uv0.y + corner.y * (uv2.y - uv0.y),
+                        vertex_array[i].texcoord.y,
+                        kUnorm16);
+        }
+    }
+}
+
+TEST(SpriteTest, HiddenInstanceIsDegenerate)
+{
+    Sprite sprite(2, 2);
+    SpriteInstance instance;
+
+    ASSERT_TRUE(sprite.update(instance, mock_texture()));
+    ASSERT_EQ(instance.extent, Vec2f(2, 2));
+
+    sprite.hide();
+
+    ASSERT_TRUE(sprite.update(instance, mock_texture()));
+    ASSERT_EQ(instance.origin, Vec2f::Zero);
+    ASSERT_EQ(instance.extent, Vec2f::Zero);
+
+    sprite.show();
+
+    ASSERT_TRUE(sprite.update(instance, mock_texture()));
+    ASSERT_EQ(instance.origin, Vec2f(-1, -1));
+    ASSERT_EQ(instance.extent, Vec2f(2, 2));
+}
+
+TEST(SpriteTest, MapsTextureAreaIntoAtlasPage)
+{
+    auto texture = mock_texture();
+    texture.offset_x = 32;
+    texture.offset_y = 64;
+    texture.page_width = 128;
+    texture.page_height = 128;
+    texture.page = 1;
+
+    Sprite sprite(2, 2);
+    sprite.texture({0, 0, 16, 32});
+
+    SpriteVertex vertex_array[4];
+    sprite.update(vertex_array, texture);
+
+    ASSERT_EQ(vertex_array[0].texcoord, Vec2f(0.25F, 0.75F));
+    ASSERT_EQ(vertex_array[1].texcoord, Vec2f(0.375F, 0.75F));
+    ASSERT_EQ(vertex_array[2].texcoord, Vec2f(0.375F, 0.5F));
+    ASSERT_EQ(vertex_array[3].texcoord, Vec2f(0.25F, 0.5F));
+}
+
+TEST(SpriteTest, RecalculatesTextureCoordinatesWhenInvalidated)
+{
+    Sprite sprite(2, 2);
+    sprite.texture({0, 0, 16, 16});
+
+    SpriteVertex vertex_array[4];
+    sprite.update(vertex_array, mock_texture());
+
+    ASSERT_EQ(vertex_array[1].texcoord, Vec2f(0.25F, 0.25F));
+
+    // The texture was replaced with one twice the size.
+    auto texture = mock_texture();
+    texture.width *= 2;
+    texture.height *= 2;
+
+    ASSERT_FALSE(sprite.update(vertex_array, texture));
+
+    sprite.invalidate_texture();
+
+    ASSERT_TRUE(is_stale(sprite, kStaleTexture));
+    ASSERT_TRUE(sprite.update(vertex_array, texture));
+    ASSERT_EQ(vertex_array[1].texcoord, Vec2f(0.125F, 0.125F));
+}
+
 TEST(SpriteTest, ManuallyConstructedRefsAreInvalid)
 {
     ASSERT_FALSE(SpriteRef{});
 }
+
+TEST(SpriteTest, AddsItselfToStaleListWhenMarkedStale)
+{
+    std::array<Sprite, 4> sprites{
+        Sprite{1, 1}, Sprite{1, 1}, Sprite{1, 1}, Sprite{1, 1}};
+    StaleSprites stale{sprites.data()};
+    for (auto&& sprite : sprites)
+        sprite.set_stale_list(&stale);
+
+    using Indices = std::vector<uint32_t>;
+
+    ASSERT_EQ(stale.sorted(4), (Indices{0, 1, 2, 3}));
+
+    SpriteVertex vertex_array[4];
+    for (auto&& sprite : sprites)
+        sprite.update(vertex_array, mock_texture());
+    stale.clear();
+
+    ASSERT_TRUE(stale.empty());
+
+    sprites[3].move(Vec2f::One);
+    sprites[1].color(Color{});
+    sprites[3].angle(1.0F);
+    sprites[0].pivot({0.0F, 0.0F});
+
+    ASSERT_EQ(stale.sorted(4), (Indices{1, 3}));
+    ASSERT_EQ(stale.sorted(2), (Indices{1}));
+
+    for (auto&& sprite : sprites)
+        sprite.update(vertex_array, mock_texture());
+    stale.clear();
+
+    // Swapping sprites marks both slots stale.
+    std::swap(sprites[0], sprites[2]);
+
+    ASSERT_EQ(stale.sorted(4), (Indices{0, 2}));
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/SpriteGrid.h"
+
+#include <gtest/gtest.h>
+
+#include "Graphics/SpriteVertex.h"
+
+using rainbow::Rect;
+using rainbow::SpriteVertex;
+using rainbow::Vec2f;
+using rainbow::graphics::SpriteGrid;
+
+namespace
+{
+    constexpr float kCellSize = 100.0F;
+
+    struct Quad
+    {
+        SpriteVertex vertices[4];
+
+        Quad(float left, float bottom, float width, float height)
+        {
+            vertices[0].position = {left, bottom};
+            vertices[1].position = {left + width, bottom};
+            vertices[2].position = {left + width, bottom + height};
+            vertices[3].position = {left, bottom + height};
+        }
+    };
+
+    auto query(const SpriteGrid& grid, const Rect& area)
+    {
+        std::vector<uint32_t> result;
+        grid.query(area, result);
+        return result;
+    }
+}  // namespace
+
+TEST(SpriteGridTest, FindsSpritesIntersectingArea)
+{
+    SpriteGrid grid(kCellSize);
+    grid.update(0, Quad{10, 10, 20, 20}.vertices);
+    grid.update(1, Quad{510, 10, 20, 20}.vertices);
+    grid.update(2, Quad{-300, -300, 20, 20}.vertices);
+
+    ASSERT_EQ(grid.size(), 3U);
+    ASSERT_EQ(query(grid, {0, 0, 200, 200}), std::vector<uint32_t>{0});
+    ASSERT_EQ(query(grid, {400, 0, 200, 200}), std::vector<uint32_t>{1});
+    ASSERT_EQ(query(grid, {-400, -400, 200, 200}), std::vector<uint32_t>{2});
+    ASSERT_TRUE(query(grid, {1000, 1000, 200, 200}).empty());
+}
+
+TEST(SpriteGridTest, ReturnsSpritesInDrawOrderWithoutDuplicates)
+{
+    SpriteGrid grid(kCellSize);
+    grid.update(3, Quad{0, 0, 450, 450}.vertices);
+    grid.update(1, Quad{250, 250, 10, 10}.vertices);
+    grid.update(2, Quad{50, 350, 10, 10}.vertices);
+    grid.update(0, Quad{350, 50, 10, 10}.vertices);
+
+    const std::vector<uint32_t> expected{0, 1, 2, 3};
+
+    ASSERT_EQ(query(grid, {0, 0, 500, 500}), expected);
+
+    // Areas much larger than the occupied cells take a different path.
+    ASSERT_EQ(query(grid, {-1e5F, -1e5F, 2e5F, 2e5F}), expected);
+}
+
+TEST(SpriteGridTest, MovesSpritesBetweenCells)
+{
+    SpriteGrid grid(kCellSize);
+    grid.update(0, Quad{10, 10, 20, 20}.vertices);
+
+    ASSERT_EQ(query(grid, {0, 0, 100, 100}), std::vector<uint32_t>{0});
+
+    grid.update(0, Quad{810, 810, 20, 20}.vertices);
+
+    ASSERT_TRUE(query(grid, {0, 0, 100, 100}).empty());
+    ASSERT_EQ(query(grid, {800, 800, 100, 100}), std::vector<uint32_t>{0});
+}
+
+TEST(SpriteGridTest, RemovesDegenerateQuads)
+{
+    SpriteGrid grid(kCellSize);
+    grid.update(0, Quad{10, 10, 20, 20}.vertices);
+
+    ASSERT_FALSE(query(grid, {0, 0, 100, 100}).empty());
+
+    SpriteVertex hidden[4];
+    grid.update(0, hidden);
+
+    ASSERT_EQ(grid.size(), 1U);
+    ASSERT_TRUE(query(grid, {-50, -50, 100, 100}).empty());
+}
+
+TEST(SpriteGridTest, ResizeRemovesTrailingSprites)
+{
+    SpriteGrid grid(kCellSize);
+    grid.update(0, Quad{10, 10, 20, 20}.vertices);
+    grid.update(1, Quad{20, 20, 20, 20}.vertices);
+    grid.update(2, Quad{30, 30, 20, 20}.vertices);
+    grid.resize(1);
+
+    ASSERT_EQ(grid.size(), 1U);
+    ASSERT_EQ(query(grid, {0, 0, 100, 100}), std::vector<uint32_t>{0});
+
+    grid.clear();
+
+    ASSERT_EQ(grid.size(), 0U);
+    ASSERT_TRUE(query(grid, {0, 0, 100, 100}).empty());
+}
@@ -4,13 +4,18 @@
 
 #include "Graphics/Texture.h"
 
+#include <algorithm>
+#include <limits>
+#include <memory>
 #include <string_view>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include "Common/Data.h"
 #include "Graphics/Image.h"
 #include "Tests/TestHelpers.h"
+#include "Threading/JobPool.h"
 #include "Tests/__fixtures/ImageTest/Images.h"
 
 using namespace rainbow::graphics;
@@ -19,27 +24,70 @@ using namespace std::literals::string_view_literals;
 
 using rainbow::Data;
 using rainbow::Image;
+using rainbow::JobPool;
 
 namespace
 {
-    constexpr const char kMockImageData[] = "RNBWMOCK";  // NOLINT
+    constexpr const char kMockImageData[] = "RNBWMOCK";          // NOLINT
+    constexpr const char kTestImage[] = "basn6a08.png";           // NOLINT
+    constexpr const char kTestImageCopy[] = "basn6a08_copy.png";  // NOLINT
 
     struct MockTextureAllocator final : public ITextureAllocator
     {
         int current_id = 0;  // NOLINT
         int released = 0;    // NOLINT
         int updated = 0;     // NOLINT
+        int regions = 0;     // NOLINT
+
+        /// <summary>Properties of the last constructed image.</summary>
+        Image::Format format = Image::Format::Unknown;  // NOLINT
+        uint32_t width = 0;                             // NOLINT
+        uint32_t mip_levels = 0;                        // NOLINT
+
+        bool staging_enabled = false;  // NOLINT
+        int staged = 0;                // NOLINT
+        int discarded = 0;             // NOLINT
+
+        /// <summary>Staging buffers that have not been returned.</summary>
+        std::vector<const uint8_t*> mapped;  // NOLINT
+
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+        std::vector<std::unique_ptr<uint8_t[]>> staging_memory;
 
         void construct(TextureHandle& handle,
-                       const Image&,
+                       const Image& image,
                        Filter,
                        Filter) override
         {
             handle[0] = ++current_id;
+            format = image.format;
+            width = image.width;
+            mip_levels = image.mip_levels;
+            if (unmap(image.data))
+                ++staged;
         }
 
         void destroy(TextureHandle&) override { ++released; }
 
+        void discard_staging(const uint8_t* data) override
+        {
+            ASSERT_TRUE(unmap(data));
+            ++discarded;
+        }
+
+        [[nodiscard]] auto has_staging() const -> bool override
+        {
+            return staging_enabled;
+        }
+
+        auto map_staging(size_t size) -> uint8_t* override
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+            staging_memory.push_back(std::make_unique<uint8_t[]>(size));
+            mapped.push_back(staging_memory.back().get());
+            return staging_memory.back().get();
+        }
+
         [[maybe_unused, nodiscard]]
         auto max_size() const noexcept -> size_t override
         {
@@ -50,7 +98,32 @@ namespace
         {
             ++updated;
         }
+
+        void update_region(const TextureHandle&,
+                           uint32_t,
+                           uint32_t,
+                           const Image&) override
+        {
+            ++regions;
+        }
+
+        auto unmap(const uint8_t* data) -> bool
+        {
+            auto i = std::find(mapped.begin(), mapped.end(), data);
+            if (i == mapped.end())
+                return false;
+
+            mapped.erase(i);
+            return true;
+        }
     };
+
+    auto png_data()
+    {
+        return Data{fixtures::basn6a08_png.data(),
+                    fixtures::basn6a08_png.size(),
+                    Data::Ownership::Reference};
+    }
 }  // namespace
 
 TEST(TextureProviderTest, ReferenceCounts)
@@ -198,6 +271,24 @@ TEST(TextureProviderTest, UpdatesExistingTexture)
     ASSERT_EQ(allocator.updated, 1);
 }
 
+TEST(TextureProviderTest, UpdatesRegionOfExistingTexture)
+{
+    MockTextureAllocator allocator;
+    TextureProvider provider{allocator};
+
+    constexpr uint8_t kCoverage[16]{};  // NOLINT
+    const Image image{
+        Image::Format::Alpha, 4, 4, 8, 1, sizeof(kCoverage), kCoverage};
+    auto texture = provider.get("test", image);
+    ASSERT_TRUE(texture);
+    ASSERT_EQ(allocator.format, Image::Format::Alpha);
+
+    const Image region{Image::Format::Alpha, 2, 2, 8, 1, 4, kCoverage};
+    provider.update_region(texture, 2, 1, region);
+    ASSERT_EQ(allocator.regions, 1);
+    ASSERT_EQ(allocator.updated, 0);
+}
+
 TEST(TextureProviderTest, ReleasesPreviousTextureWhenAssigned)
 {
     MockTextureAllocator allocator;
@@ -242,3 +333,429 @@ TEST(TextureProviderTest, TextureHandlesAreMovable)
     ASSERT_EQ(allocator.current_id, 1);
     ASSERT_EQ(allocator.released, 1);
 }
+
+TEST(TextureProviderTest, PacksSmallImagesIntoAtlas)
+{
+    MockTextureAllocator allocator;
+    {
+        TextureProvider provider{allocator};
+        provider.set_atlas_enabled(true);
+
+        auto texture1 = provider.get("test1", png_data());
+        auto texture2 = provider.get("test2", png_data());
+        ASSERT_EQ(allocator.current_id, 1);
+        ASSERT_EQ(allocator.regions, 2);
+
+        const auto raw1 = provider.raw_get(texture1);
+        const auto raw2 = provider.raw_get(texture2);
+        ASSERT_EQ(raw1.data[0], raw2.data[0]);
+        ASSERT_EQ(raw1.page, 1U);
+        ASSERT_EQ(raw2.page, 1U);
+        ASSERT_EQ(raw1.width, 32U);
+        ASSERT_EQ(raw1.height, 32U);
+        ASSERT_EQ(raw1.page_width, TextureProvider::kAtlasPageSize);
+        ASSERT_EQ(raw1.page_height, TextureProvider::kAtlasPageSize);
+        ASSERT_FALSE(raw1.offset_x == raw2.offset_x &&
+                     raw1.offset_y == raw2.offset_y);
+        ASSERT_EQ(texture1.storage_key(), texture2.storage_key());
+        ASSERT_NE(texture1.storage_key(), texture1.key());
+
+        // Preloaded images may be updated later, and are never packed.
+        auto image = Image::decode(png_data(), 1.0F);
+        auto texture3 = provider.get("test3", image);
+        ASSERT_EQ(allocator.current_id, 2);
+        ASSERT_EQ(provider.raw_get(texture3).page, 0U);
+        ASSERT_EQ(texture3.storage_key(), texture3.key());
+
+        provider.update(texture1, image);
+        ASSERT_EQ(allocator.updated, 0);
+        ASSERT_EQ(allocator.regions, 3);
+    }
+
+    ASSERT_EQ(allocator.released, allocator.current_id);
+}
+
+TEST(TextureProviderTest, ReleasesAtlasPageWhenUnused)
+{
+    MockTextureAllocator allocator;
+    TextureProvider provider{allocator};
+    provider.set_atlas_enabled(true);
+
+    {
+        auto texture1 = provider.get("test1", png_data());
+        {
+            auto texture2 = provider.get("test2", png_data());
+        }
+        ASSERT_EQ(allocator.released, 0);
+    }
+
+    ASSERT_EQ(allocator.current_id, 1);
+    ASSERT_EQ(allocator.released, 1);
+
+    auto texture = provider.get("test1", png_data());
+    ASSERT_EQ(allocator.current_id, 2);
+    ASSERT_EQ(provider.raw_get(texture).page, 1U);
+}
+
+TEST(TextureProviderTest, LoadsTexturesAsynchronously)
+{
+    ScopedAssetsDirectory scoped_assets{"TextureProviderTest"};
+
+    MockTextureAllocator allocator;
+    JobPool job_pool(2);
+    {
+        TextureProvider provider{allocator};
+
+        int called = 0;
+        auto texture = provider.get_async(
+            job_pool, kTestImage, [&called](std::string_view path, bool ok) {
+                ASSERT_EQ(path, kTestImage);
+                ASSERT_TRUE(ok);
+                ++called;
+            });
+
+        ASSERT_TRUE(texture);
+        ASSERT_FALSE(texture.is_loaded());
+        ASSERT_EQ(allocator.current_id, 1);
+        ASSERT_EQ(provider.raw_get(texture).width, 1U);
+        ASSERT_EQ(provider.pending_count(), 1U);
+
+        provider.wait(texture);
+
+        ASSERT_TRUE(texture.is_loaded());
+        ASSERT_EQ(allocator.current_id, 2);
+        ASSERT_EQ(provider.raw_get(texture).width, 32U);
+        ASSERT_EQ(provider.raw_get(texture).revision, 1U);
+        ASSERT_EQ(provider.pending_count(), 0U);
+        ASSERT_EQ(called, 0);
+
+        provider.upload_pending();
+
+        ASSERT_EQ(called, 1);
+
+        // Already loaded textures call back on next upload.
+        auto again = provider.get_async(
+            job_pool, kTestImage, [&called](std::string_view, bool ok) {
+                ASSERT_TRUE(ok);
+                ++called;
+            });
+
+        ASSERT_EQ(allocator.current_id, 2);
+        ASSERT_EQ(provider.raw_get(again).use_count, 2U);
+
+        provider.upload_pending();
+
+        ASSERT_EQ(called, 2);
+    }
+
+    ASSERT_EQ(allocator.released, allocator.current_id);
+}
+
+TEST(TextureProviderTest, UploadsWithinBudget)
+{
+    ScopedAssetsDirectory scoped_assets{"TextureProviderTest"};
+
+    MockTextureAllocator allocator;
+    JobPool job_pool;
+    TextureProvider provider{allocator};
+    provider.set_upload_budget(32 * 32 * 4);
+
+    int loaded = 0;
+    auto on_load = [&loaded](std::string_view, bool) { ++loaded; };
+
+    auto texture1 = provider.get_async(job_pool, kTestImage, on_load);
+    auto texture2 = provider.get_async(job_pool, kTestImageCopy, on_load);
+
+    ASSERT_EQ(provider.pending_count(), 2U);
+
+    provider.upload_pending();
+
+    ASSERT_EQ(loaded, 1);
+    ASSERT_TRUE(texture1.is_loaded());
+    ASSERT_FALSE(texture2.is_loaded());
+
+    provider.upload_pending();
+
+    ASSERT_EQ(loaded, 2);
+    ASSERT_TRUE(texture2.is_loaded());
+    ASSERT_EQ(provider.pending_count(), 0U);
+}
+
+TEST(TextureProviderTest, CancelsAsynchronousLoadWhenReleased)
+{
+    ScopedAssetsDirectory scoped_assets{"TextureProviderTest"};
+
+    MockTextureAllocator allocator;
+    JobPool job_pool;
+    TextureProvider provider{allocator};
+
+    bool called = false;
+    {
+        auto texture = provider.get_async(
+            job_pool, kTestImage, [&called](std::string_view, bool) {
+                called = true;
+            });
+
+        ASSERT_EQ(provider.pending_count(), 1U);
+    }
+
+    ASSERT_EQ(provider.pending_count(), 0U);
+
+    provider.upload_pending();
+
+    ASSERT_FALSE(called);
+    ASSERT_EQ(allocator.current_id, 1);
+    ASSERT_EQ(allocator.released, 0);
+}
+
+TEST(TextureProviderTest, ReportsFailedAsynchronousLoads)
+{
+    ScopedAssetsDirectory scoped_assets{"TextureProviderTest"};
+
+    MockTextureAllocator allocator;
+    JobPool job_pool;
+    TextureProvider provider{allocator};
+
+    int failed = 0;
+    auto texture = provider.get_async(
+        job_pool, "missing.png", [&failed](std::string_view, bool ok) {
+            if (!ok)
+                ++failed;
+        });
+
+    provider.upload_pending();
+
+    ASSERT_EQ(failed, 1);
+    ASSERT_TRUE(texture.is_loaded());
+    ASSERT_TRUE(provider.raw_get(texture).failed);
+    ASSERT_EQ(provider.raw_get(texture).width, 1U);
+}
+
+TEST(TextureProviderTest, BuildsMipChainsWithoutChangingLogicalSize)
+{
+    ScopedAssetsDirectory scoped_assets{"TextureProviderTest"};
+
+    MockTextureAllocator allocator;
+    JobPool job_pool;
+    TextureProvider provider{allocator};
+    provider.set_mipmaps_enabled(true);
+
+    auto texture = provider.get("mipmapped", png_data());
+
+    ASSERT_EQ(allocator.width, 32U);
+    ASSERT_EQ(allocator.mip_levels, 6U);
+
+    provider.set_skipped_mip_levels(1);
+    auto skipped = provider.get_async(job_pool, kTestImage);
+    provider.upload_pending();
+
+    ASSERT_EQ(allocator.width, 16U);
+    ASSERT_EQ(allocator.mip_levels, 5U);
+    ASSERT_EQ(provider.raw_get(skipped).width, 32U);
+    ASSERT_EQ(provider.raw_get(skipped).height, 32U);
+
+    // Images packed into atlas pages cannot have their own mip chain.
+    provider.set_atlas_enabled(true);
+    auto packed = provider.get(kTestImageCopy, png_data());
+
+    ASSERT_NE(provider.raw_get(packed).page, 0U);
+    ASSERT_EQ(provider.raw_get(packed).width, 32U);
+}
+
+TEST(TextureProviderTest, LoadsBestAvailableTextureVariant)
+{
+    ScopedAssetsDirectory scoped_assets{"TextureProviderTest"};
+
+    MockTextureAllocator allocator;
+    JobPool job_pool;
+    TextureProvider provider{allocator};
+    provider.set_texture_variants({"astc", "etc2", "s3tc"});
+
+    {
+        auto texture = provider.get("compressed.ktx2");
+
+        ASSERT_EQ(allocator.format, Image::Format::ETC2);
+        ASSERT_EQ(texture.key(), "compressed.ktx2");
+        ASSERT_EQ(provider.raw_get(texture).width, 4U);
+    }
+
+    allocator.format = Image::Format::Unknown;
+    auto texture = provider.get_async(job_pool, "compressed.ktx2");
+    provider.upload_pending();
+
+    ASSERT_EQ(allocator.format, Image::Format::ETC2);
+    ASSERT_TRUE(texture.is_loaded());
+    ASSERT_FALSE(provider.raw_get(texture).failed);
+}
+
+TEST(TextureProviderTest, EvictsLeastRecentlyUsedTexturesOverBudget)
+{
+    ScopedAssetsDirectory scoped_assets{"TextureProviderTest"};
+
+    MockTextureAllocator allocator;
+    {
+        TextureProvider provider{allocator};
+        provider.set_eviction_age(2);
+        provider.set_memory_budget(4096);
+
+        auto texture = provider.get(kTestImage);
+        auto copy = provider.get(kTestImageCopy);
+        auto in_memory = provider.get("in_memory", png_data());
+
+        ASSERT_EQ(std::get<0>(provider.memory_usage()), 3U * 4096);
+
+        provider.next_frame();
+
+        ASSERT_EQ(allocator.released, 0);
+
+        provider.use(copy);
+        provider.next_frame();
+
+        // Textures created from memory cannot be reloaded.
+        ASSERT_EQ(allocator.released, 1);
+        ASSERT_TRUE(provider.raw_get(texture).evicted);
+        ASSERT_FALSE(provider.raw_get(copy).evicted);
+        ASSERT_FALSE(provider.raw_get(in_memory).evicted);
+        ASSERT_EQ(std::get<0>(provider.memory_usage()), 2U * 4096);
+        ASSERT_EQ(provider.memory_evicted(), 4096U);
+
+        const auto revision = provider.raw_get(texture).revision;
+        const auto& data = provider.use(texture);
+
+        ASSERT_FALSE(data.evicted);
+        ASSERT_EQ(data.data[0], allocator.current_id);
+        ASSERT_EQ(data.width, 32U);
+        ASSERT_EQ(data.revision, revision);
+        ASSERT_EQ(std::get<0>(provider.memory_usage()), 3U * 4096);
+        ASSERT_EQ(provider.memory_evicted(), 0U);
+    }
+
+    ASSERT_EQ(allocator.released, allocator.current_id);
+}
+
+TEST(TextureProviderTest, EvictsUnusedTexturesOnDemand)
+{
+    ScopedAssetsDirectory scoped_assets{"TextureProviderTest"};
+
+    MockTextureAllocator allocator;
+    JobPool job_pool;
+    {
+        TextureProvider provider{allocator};
+        provider.set_eviction_age(1);
+
+        auto texture = provider.get(kTestImage);
+        auto async = provider.get_async(job_pool, kTestImageCopy);
+        provider.upload_pending();
+
+        ASSERT_EQ(provider.evict(std::numeric_limits<size_t>::max()), 0U);
+
+        provider.next_frame();
+
+        ASSERT_EQ(provider.evict(std::numeric_limits<size_t>::max()),
+                  2U * 4096);
+        ASSERT_EQ(allocator.released, 2);
+        ASSERT_EQ(provider.memory_evicted(), 2U * 4096);
+
+        // Evicted textures should not be destroyed twice.
+        texture = Texture{};
+        ASSERT_EQ(allocator.released, 2);
+        ASSERT_EQ(provider.memory_evicted(), 4096U);
+    }
+
+    // The async placeholder is the only other texture object.
+    ASSERT_EQ(allocator.released, 3);
+}
+
+TEST(TextureProviderTest, DecodesIntoStagingBuffers)
+{
+    ScopedAssetsDirectory scoped_assets{"TextureProviderTest"};
+
+    MockTextureAllocator allocator;
+    allocator.staging_enabled = true;
+    JobPool job_pool;
+    {
+        TextureProvider provider{allocator};
+
+        {
+            auto texture = provider.get(kTestImage);
+
+            ASSERT_EQ(allocator.staged, 1);
+            ASSERT_EQ(allocator.format, Image::Format::RGBA);
+            ASSERT_EQ(provider.raw_get(texture).width, 32U);
+        }
+        {
+            auto texture = provider.get_async(job_pool, kTestImage);
+            provider.upload_pending();
+
+            ASSERT_TRUE(texture.is_loaded());
+            ASSERT_EQ(allocator.staged, 2);
+            ASSERT_EQ(provider.raw_get(texture).width, 32U);
+        }
+        {
+            auto texture = provider.get_async(job_pool, kTestImage);
+            provider.wait(texture);
+
+            ASSERT_TRUE(texture.is_loaded());
+            ASSERT_EQ(allocator.staged, 3);
+        }
+
+        // Released before the worker got a staging buffer
+        {
+            auto texture = provider.get_async(job_pool, kTestImage);
+        }
+        provider.upload_pending();
+
+        ASSERT_EQ(allocator.staged, 3);
+        ASSERT_TRUE(allocator.mapped.empty());
+
+        // Images that need further processing are decoded normally.
+        provider.set_mipmaps_enabled(true);
+        auto texture = provider.get(kTestImage);
+
+        ASSERT_EQ(allocator.staged, 3);
+        ASSERT_EQ(allocator.mip_levels, 6U);
+    }
+
+    ASSERT_TRUE(allocator.mapped.empty());
+    ASSERT_EQ(allocator.discarded, 0);
+}
+
+TEST(TextureProviderTest, DiscardsStagingBuffersOfCancelledLoads)
+{
+    ScopedAssetsDirectory scoped_assets{"TextureProviderTest"};
+
+    MockTextureAllocator allocator;
+    allocator.staging_enabled = true;
+    JobPool job_pool;
+    {
+        TextureProvider provider{allocator};
+        provider.set_upload_budget(1);
+
+        auto texture = provider.get_async(job_pool, kTestImage);
+        {
+            auto copy = provider.get_async(job_pool, kTestImageCopy);
+            provider.upload_pending();
+
+            ASSERT_TRUE(texture.is_loaded());
+            ASSERT_FALSE(copy.is_loaded());
+            ASSERT_EQ(allocator.mapped.size(), 1U);
+        }
+
+        provider.upload_pending();
+
+        ASSERT_TRUE(allocator.mapped.empty());
+        ASSERT_EQ(allocator.discarded, 1);
+
+        // Loads still pending are discarded on destruction.
+        texture = Texture{};
+        auto copy = provider.get_async(job_pool, kTestImageCopy);
+        auto again = provider.get_async(job_pool, kTestImage);
+        provider.upload_pending();
+
+        ASSERT_EQ(allocator.mapped.size(), 1U);
+    }
+
+    ASSERT_TRUE(allocator.mapped.empty());
+    ASSERT_EQ(allocator.discarded, 2);
+    ASSERT_EQ(allocator.staged, 2);
+}
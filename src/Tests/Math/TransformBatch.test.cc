@@ -0,0 +1,179 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Math/TransformBatch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/Constants.h"
+#include "Graphics/SpriteVertex.h"
+#include "Math/Transform.h"
+
+using rainbow::SpriteVertex;
+using rainbow::TransformBatch;
+using rainbow::Vec2f;
+
+namespace
+{
+    struct TestSprite
+    {
+        Vec2f position_;
+        Vec2f pivot_;
+        Vec2f scale_;
+        float angle_;
+        uint32_t width_;
+        uint32_t height_;
+
+        [[nodiscard]] auto angle() const { return angle_; }
+        [[nodiscard]] auto height() const { return height_; }
+        [[nodiscard]] auto pivot() const { return pivot_; }
+        [[nodiscard]] auto position() const { return position_; }
+        [[nodiscard]] auto scale() const { return scale_; }
+        [[nodiscard]] auto width() const { return width_; }
+    };
+
+    auto make_sprites(size_t count)
+    {
+        std::mt19937 rng(count);
+        std::uniform_real_distribution<float> angle(-4 * rainbow::kPi<float>,
+                                                    4 * rainbow::kPi<float>);
+        std::uniform_real_distribution<float> position(-2048.0F, 2048.0F);
+        std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+        std::uniform_int_distribution<uint32_t> size(1, 512);
+
+        std::vector<TestSprite> sprites(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& sprite = sprites[i];
+            sprite.position_ = {position(rng), position(rng)};
+            sprite.pivot_ = {unit(rng), unit(rng)};
+            sprite.scale_ = {unit(rng) * 4 + 0.1F, unit(rng) * 4 + 0.1F};
+            sprite.angle_ = i % 4 == 0 ? 0.0F : angle(rng);
+            sprite.width_ = size(rng);
+            sprite.height_ = size(rng);
+        }
+        return sprites;
+    }
+
+    void transform_scalar(const std::vector<TestSprite>& sprites,
+                          std::vector<SpriteVertex>& vertices)
+    {
+        for (size_t i = 0; i < sprites.size(); ++i)
+        {
+            rainbow::transform(sprites[i],
+                               ArraySpan<SpriteVertex>{&vertices[i * 4], 4});
+        }
+    }
+
+    void transform_batched(const std::vector<TestSprite>& sprites,
+                           std::vector<SpriteVertex>& vertices,
+                           TransformBatch::Precision precision)
+    {
+        TransformBatch batch(precision);
+        for (size_t i = 0; i < sprites.size(); ++i)
+            batch.add(sprites[i], &vertices[i * 4]);
+        batch.flush();
+    }
+}  // namespace
+
+TEST(TransformBatchTest, FlushesWhenFull)
+{
+    const auto sprites = make_sprites(TransformBatch::kCapacity + 1);
+    std::vector<SpriteVertex> vertices(sprites.size() * 4);
+
+    TransformBatch batch;
+    for (size_t i = 0; i < sprites.size(); ++i)
+        batch.add(sprites[i], &vertices[i * 4]);
+
+    ASSERT_EQ(batch.size(), 1U);
+
+    batch.flush();
+
+    ASSERT_EQ(batch.size(), 0U);
+}
+
+TEST(TransformBatchTest, ExactMatchesScalarTransform)
+{
+    const auto sprites = make_sprites(1001);
+    std::vector<SpriteVertex> expected(sprites.size() * 4);
+    std::vector<SpriteVertex> actual(sprites.size() * 4);
+
+    transform_scalar(sprites, expected);
+    transform_batched(sprites, actual, TransformBatch::Precision::Exact);
+
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        // The compiler may fuse multiply-adds in the scalar path; allow for
+        // one rounding step at the largest magnitudes generated.
+        ASSERT_NEAR(actual[i].position.x, expected[i].position.x, 0.0005F);
+        ASSERT_NEAR(actual[i].position.y, expected[i].position.y, 0.0005F);
+    }
+}
+
+TEST(TransformBatchTest, FastIsCloseToScalarTransform)
+{
+    const auto sprites = make_sprites(1001);
+    std::vector<SpriteVertex> expected(sprites.size() * 4);
+    std::vector<SpriteVertex> actual(sprites.size() * 4);
+
+    transform_scalar(sprites, expected);
+    transform_batched(sprites, actual, TransformBatch::Precision::Fast);
+
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        // Corners may be up to ~1500 units from the pivot; allow a few ulps of
+        // error in sine and cosine at that distance.
+        ASSERT_NEAR(actual[i].position.x, expected[i].position.x, 0.002F);
+        ASSERT_NEAR(actual[i].position.y, expected[i].position.y, 0.002F);
+    }
+}
+
+TEST(TransformBatchTest, DISABLED_Benchmark)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    using std::chrono::steady_clock;
+
+    constexpr int kIterations = 20;
+
+    for (size_t count : {1000, 4000, 64000})
+    {
+        const auto sprites = make_sprites(count);
+        std::vector<SpriteVertex> vertices(count * 4);
+
+        auto measure = [&](auto&& f) {
+            const auto start = steady_clock::now();
+            for (int i = 0; i < kIterations; ++i)
+                f();
+            return duration_cast<microseconds>(steady_clock::now() - start)
+                       .count() /
+                   kIterations;
+        };
+
+        const auto scalar =
+            measure([&] { transform_scalar(sprites, vertices); });
+        const auto exact = measure([&] {
+            transform_batched(
+                sprites, vertices, TransformBatch::Precision::Exact);
+        });
+        const auto fast = measure([&] {
+            transform_batched(
+                sprites, vertices, TransformBatch::Precision::Fast);
+        });
+
+        std::printf(
+            "%6zu sprites: scalar %6lld us, exact %6lld us, fast %6lld us "
+            "(%u lanes)\n",
+            count,
+            static_cast<long long>(scalar),
+            static_cast<long long>(exact),
+            static_cast<long long>(fast),
+            TransformBatch::kLanes);
+    }
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Threading/JobPool.h"
+
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using rainbow::JobPool;
+
+namespace
+{
+    constexpr uint32_t kCount = 1000;
+}  // namespace
+
+TEST(JobPoolTest, RunsSeriallyWithoutWorkers)
+{
+    JobPool pool;
+
+    ASSERT_EQ(pool.worker_count(), 0U);
+
+    std::vector<uint32_t> order;
+    pool.parallel_for(kCount, [&order](uint32_t i) { order.push_back(i); });
+
+    ASSERT_EQ(order.size(), kCount);
+    for (uint32_t i = 0; i < kCount; ++i)
+        ASSERT_EQ(order[i], i);
+
+    bool submitted = false;
+    pool.submit([&submitted] { submitted = true; });
+
+    ASSERT_TRUE(submitted);
+}
+
+TEST(JobPoolTest, VisitsEveryIndexOnce)
+{
+    JobPool pool(3);
+
+    ASSERT_EQ(pool.worker_count(), 3U);
+
+    std::array<std::atomic<int>, kCount> visits{};
+    for (int round = 0; round < 10; ++round)
+    {
+        pool.parallel_for(
+            kCount, [&visits](uint32_t i) { visits[i].fetch_add(1); });
+    }
+
+    for (auto&& count : visits)
+        ASSERT_EQ(count.load(), 10);
+}
+
+TEST(JobPoolTest, RunsSubmittedJobs)
+{
+    std::atomic<uint32_t> completed = 0;
+    {
+        JobPool pool(2);
+        for (uint32_t i = 0; i < kCount; ++i)
+            pool.submit([&completed] { completed.fetch_add(1); });
+    }
+
+    ASSERT_EQ(completed.load(), kCount);
+}
+
+TEST(JobPoolTest, ChangesWorkerCount)
+{
+    JobPool pool(2);
+    pool.set_worker_count(0);
+
+    ASSERT_EQ(pool.worker_count(), 0U);
+
+    pool.set_worker_count(JobPool::kMaxWorkers + 1);
+
+    ASSERT_EQ(pool.worker_count(), JobPool::kMaxWorkers);
+
+    std::atomic<uint32_t> sum = 0;
+    pool.parallel_for(kCount, [&sum](uint32_t i) { sum.fetch_add(i); });
+
+    ASSERT_EQ(sum.load(), kCount * (kCount - 1) / 2);
+}
@@ -4,16 +4,29 @@
 
 #include "Text/FontCache.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+// clang-format off
+#include "ThirdParty/DisableWarnings.h"
+#include FT_MODULE_H  // NOLINT(llvm-include-order)
+#include "ThirdParty/ReenableWarnings.h"
+// clang-format on
+
 #include "Common/Logging.h"
 #include "Common/TypeCast.h"
 #include "FileSystem/File.h"
 #include "Graphics/Image.h"
 #include "Text/SystemFonts.h"
+#include "Threading/JobPool.h"
 
-using rainbow::Color;
+using rainbow::Data;
 using rainbow::FontCache;
+using rainbow::GlyphRendering;
+using rainbow::Image;
+using rainbow::JobPool;
 using rainbow::SpriteVertex;
-using rainbow::Vec2i;
 using rainbow::graphics::TextureProvider;
 
 namespace
@@ -27,40 +40,127 @@ namespace
     constexpr int kPixelFormat = 64;
 
     constexpr size_t kTextureSizeBytes =
-        FontCache::kTextureSize * FontCache::kTextureSize * 4;
+        FontCache::kTextureSize * FontCache::kTextureSize;
+
+    constexpr uint32_t kReplacementCharacter = 0xfffd;
 
     void blit(const uint8_t* src,
-              const stbrp_rect& src_rect,
-              Color* dst,
-              const Vec2i& dst_sz)
+              int src_pitch,
+              const stbrp_rect& dst_rect,
+              uint8_t* dst,
+              int dst_pitch)
     {
-        for (uint32_t row = 0; row < src_rect.h; ++row)
+        for (int row = 0; row < dst_rect.h; ++row)
         {
-            auto out = dst + ((src_rect.y + row) * dst_sz.x + src_rect.x);
-            const auto begin = src + src_rect.w * row;
-            std::transform(begin, begin + src_rect.w, out, [](uint8_t alpha) {
-                // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
-                return Color{0xff, alpha};
-            });
+            std::copy_n(src + src_pitch * row,
+                        dst_rect.w,
+                        dst + (dst_rect.y + row) * dst_pitch + dst_rect.x);
+        }
+    }
+
+    auto init_library(FT_Library& library)
+    {
+        if (FT_Init_FreeType(&library) != FT_Err_Ok)
+            return false;
+
+        FT_Int spread = FontCache::kDistanceFieldSpread;
+        FT_Property_Set(library, "sdf", "spread", &spread);
+        FT_Property_Set(library, "bsdf", "spread", &spread);
+        return true;
+    }
+
+    auto new_face(FT_Library library, const Data& data, FT_Face& face)
+    {
+        return FT_New_Memory_Face(library,
+                                  data.as<const FT_Byte*>(),
+                                  rainbow::narrow_cast<FT_Long>(data.size()),
+                                  0,
+                                  &face);
+    }
+
+    /// <summary>
+    ///   Decodes the UTF-8 sequence at <paramref name="i"/>, and advances
+    ///   <paramref name="i"/> past it. Malformed sequences are decoded as
+    ///   U+FFFD.
+    /// </summary>
+    auto next_codepoint(std::string_view text, size_t& i) -> uint32_t
+    {
+        const auto lead = static_cast<uint8_t>(text[i++]);
+        if (lead < 0x80)
+            return lead;
+
+        int trail;
+        uint32_t codepoint;
+        if ((lead & 0xe0) == 0xc0)
+        {
+            trail = 1;
+            codepoint = lead & 0x1fU;
+        }
+        else if ((lead & 0xf0) == 0xe0)
+        {
+            trail = 2;
+            codepoint = lead & 0x0fU;
+        }
+        else if ((lead & 0xf8) == 0xf0)
+        {
+            trail = 3;
+            codepoint = lead & 0x07U;
+        }
+        else
+        {
+            return kReplacementCharacter;
+        }
+
+        for (; trail > 0; --trail)
+        {
+            if (i == text.size() || (text[i] & 0xc0) != 0x80)
+                return kReplacementCharacter;
+
+            codepoint = (codepoint << 6) | (text[i++] & 0x3fU);
         }
+
+        return codepoint;
+    }
+
+    /// <summary>
+    ///   Renders glyph <paramref name="glyph_index"/> into the glyph slot of
+    ///   <paramref name="face"/>.
+    /// </summary>
+    void render_glyph(FT_Face face,
+                      int32_t font_size,
+                      uint32_t glyph_index,
+                      bool distance_field)
+    {
+        if (distance_field)
+        {
+            FT_Set_Char_Size(
+                face, 0, FontCache::kDistanceFieldSize * kPixelFormat, 0, kDPI);
+            FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
+            FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF);
+        }
+        else
+        {
+            FT_Set_Char_Size(face, 0, font_size * kPixelFormat, 0, kDPI);
+            FT_Load_Glyph(face, glyph_index, FT_LOAD_RENDER);
+        }
+    }
+
+    auto scale_glyph(std::array<SpriteVertex, 4> vx, float scale)
+    {
+        for (auto&& v : vx)
+            v.position *= scale;
+        return vx;
     }
 }  // namespace
 
-FontCache::FontCache()
+FontCache::FontCache() : prewarm_queue_(std::make_shared<PrewarmQueue>())
 {
-    const auto texture_size = ceil_pow2(kTextureSize);
-    stbrp_init_target(&bin_context_,
-                      texture_size,
-                      texture_size,
-                      bin_nodes_.data(),
-                      narrow_cast<int>(bin_nodes_.size()));
+    [[maybe_unused]] const bool initialized = init_library(library_);
+    R_ASSERT(initialized, "Failed to initialise FreeType");
 
-    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
-    bitmap_ = std::make_unique<uint8_t[]>(kTextureSizeBytes);
-    std::fill_n(bitmap_.get(), kTextureSizeBytes, 0);
-
-    FT_Init_FreeType(&library_);
-    R_ASSERT(library_, "Failed to initialise FreeType");
+    // The first page always exists so that there is a texture to refer to.
+    pages_.push_back(std::make_unique<Page>());
+    clear_page(0);
 
     make_global();
 }
@@ -85,12 +185,7 @@ auto FontCache::get(std::string_view font_name) -> FT_Face
                         ? text::monospace_font()
                         : File::read(font_name.data(), FileType::Asset);
         FT_Face face;
-        [[maybe_unused]] FT_Error error =
-            FT_New_Memory_Face(library_,
-                               data.as<FT_Byte*>(),
-                               narrow_cast<FT_Long>(data.size()),
-                               0,
-                               &face);
+        [[maybe_unused]] FT_Error error = new_face(library_, data, face);
 
         R_ASSERT(error == FT_Err_Ok, "Failed to load font face");
         R_ASSERT(FT_IS_SCALABLE(face), "Unscalable fonts are not supported");
@@ -99,99 +194,345 @@ auto FontCache::get(std::string_view font_name) -> FT_Face
 
         R_ASSERT(error == FT_Err_Ok, "Failed to select character map");
 
-        font_cache_.emplace(font_name, FontFace{face, std::move(data)});
+        font_cache_.emplace(
+            font_name,
+            FontFace{face, std::make_shared<const Data>(std::move(data))});
         return face;
     }
 
     return search->second.face;
 }
 
-auto FontCache::get_glyph(FT_Face face, int32_t font_size, uint32_t glyph_index)
-    -> std::array<SpriteVertex, 4>
+auto FontCache::get_glyph(FT_Face face,
+                          int32_t font_size,
+                          uint32_t glyph_index,
+                          GlyphRendering rendering) -> Glyph
 {
-    const Index cache_index{face, font_size, glyph_index};
+    // Distance fields of all sizes share one glyph, kept under size 0 so
+    // that it does not clash with bitmaps rasterized at the reference size.
+    const bool distance_field = rendering == GlyphRendering::DistanceField;
+    const Index cache_index{face, distance_field ? 0 : font_size, glyph_index};
+    const auto scale =
+        distance_field ? font_size / narrow_cast<float>(kDistanceFieldSize)
+                       : 1.0F;
+
     auto search = glyph_cache_.find(cache_index);
-    if (search == glyph_cache_.end())
-    {
-        FT_Set_Char_Size(face, 0, font_size * kPixelFormat, 0, kDPI);
-        FT_Load_Glyph(face, glyph_index, FT_LOAD_RENDER);
-        FT_GlyphSlot slot = face->glyph;
-        const FT_Bitmap& bitmap = slot->bitmap;
-
-        R_ASSERT(bitmap.num_grays == 256, "");
-        R_ASSERT(bitmap.pixel_mode == FT_PIXEL_MODE_GRAY, "");
-
-        stbrp_rect rect{
-            0,
-            static_cast<stbrp_coord>(bitmap.width + kGlyphMargin * 2),
-            static_cast<stbrp_coord>(bitmap.rows + kGlyphMargin * 2),
-            0,
-            0,
-            0};
-        stbrp_pack_rects(&bin_context_, &rect, 1);
-
-        R_ASSERT(rect.was_packed != 0,
-                 "Failed to pack a glyph, please increase your texture size");
-
-        // Adjust coordinates to compensate for margins.
-        rect.w -= kGlyphMargin * 2;
-        rect.h -= kGlyphMargin * 2;
-        rect.x += kGlyphMargin;
-        rect.y += kGlyphMargin;
-
-        blit(bitmap.buffer,
-             rect,
-             reinterpret_cast<Color*>(bitmap_.get()),
-             {kTextureSize, kTextureSize});
-        state_ = State::NeedsUpdate;
-
-        std::array<SpriteVertex, 4> vx;
-
-        vx[0].position.x = slot->bitmap_left;
-        vx[0].position.y = narrow_cast<float>(slot->bitmap_top -
-                                              narrow_cast<FT_Int>(bitmap.rows));
-        vx[1].position.x = narrow_cast<float>(slot->bitmap_left + bitmap.width);
-        vx[1].position.y = vx[0].position.y;
-        vx[2].position.x = vx[1].position.x;
-        vx[2].position.y = narrow_cast<float>(slot->bitmap_top);
-        vx[3].position.x = vx[0].position.x;
-        vx[3].position.y = vx[2].position.y;
-
-        vx[0].texcoord.x = rect.x / narrow_cast<float>(kTextureSize);
-        vx[0].texcoord.y = (rect.y + rect.h) / narrow_cast<float>(kTextureSize);
-        vx[1].texcoord.x = (rect.x + rect.w) / narrow_cast<float>(kTextureSize);
-        vx[1].texcoord.y = vx[0].texcoord.y;
-        vx[2].texcoord.x = vx[1].texcoord.x;
-        vx[2].texcoord.y = rect.y / narrow_cast<float>(kTextureSize);
-        vx[3].texcoord.x = vx[0].texcoord.x;
-        vx[3].texcoord.y = vx[2].texcoord.y;
-
-        glyph_cache_[cache_index] = {vx};
-        return vx;
+    if (search != glyph_cache_.end())
+    {
+        const auto& glyph = search->second;
+        mark_used(glyph.page);
+        return {distance_field ? scale_glyph(glyph.vertices, scale)
+                               : glyph.vertices,
+                glyph.page};
     }
 
-    return search->second.vertices;
+    render_glyph(face, font_size, glyph_index, distance_field);
+
+    FT_GlyphSlot slot = face->glyph;
+    const FT_Bitmap& bitmap = slot->bitmap;
+
+    // Glyphs without outlines, e.g. spaces, may not render at all. Distance
+    // fields use 255 levels.
+    R_ASSERT(bitmap.rows == 0 || bitmap.num_grays >= 255, "");
+    R_ASSERT(bitmap.rows == 0 || bitmap.pixel_mode == FT_PIXEL_MODE_GRAY, "");
+
+    const auto glyph = store(cache_index,
+                             bitmap.buffer,
+                             bitmap.pitch,
+                             bitmap.width,
+                             bitmap.rows,
+                             slot->bitmap_left,
+                             slot->bitmap_top);
+    return {distance_field ? scale_glyph(glyph.vertices, scale)
+                           : glyph.vertices,
+            glyph.page};
+}
+
+void FontCache::prewarm(JobPool& job_pool,
+                        std::string_view font_name,
+                        int32_t font_size,
+                        std::string_view text,
+                        GlyphRendering rendering)
+{
+    if (text.empty())
+        return;
+
+    // Faces cannot be shared between threads. The worker opens its own from
+    // the same data, but glyphs are still cached under the face used here.
+    auto face = get(font_name);
+    auto search = font_cache_.find(font_name);
+    R_ASSERT(search != font_cache_.end(), "Font should have been loaded");
+
+    const bool distance_field = rendering == GlyphRendering::DistanceField;
+    job_pool.submit([queue = prewarm_queue_,
+                     data = search->second.data,
+                     face,
+                     font_size = distance_field ? 0 : font_size,
+                     text = std::string{text},
+                     distance_field] {
+        FT_Library library;
+        if (!init_library(library))
+            return;
+
+        FT_Face worker_face;
+        if (new_face(library, *data, worker_face) != FT_Err_Ok ||
+            FT_Select_Charmap(worker_face, FT_ENCODING_UNICODE) != FT_Err_Ok)
+        {
+            FT_Done_FreeType(library);
+            return;
+        }
+
+        std::vector<uint32_t> glyph_indices;
+        for (size_t i = 0; i < text.size();)
+        {
+            const auto codepoint = next_codepoint(text, i);
+            const auto glyph_index = FT_Get_Char_Index(worker_face, codepoint);
+            if (glyph_index != 0)
+                glyph_indices.push_back(glyph_index);
+        }
+
+        std::sort(glyph_indices.begin(), glyph_indices.end());
+        glyph_indices.erase(
+            std::unique(glyph_indices.begin(), glyph_indices.end()),
+            glyph_indices.end());
+
+        std::vector<PrewarmedGlyph> glyphs;
+        glyphs.reserve(glyph_indices.size());
+        for (auto glyph_index : glyph_indices)
+        {
+            render_glyph(worker_face, font_size, glyph_index, distance_field);
+
+            FT_GlyphSlot slot = worker_face->glyph;
+            const FT_Bitmap& bitmap = slot->bitmap;
+            std::vector<uint8_t> pixels(size_t{1} * bitmap.width *
+                                        bitmap.rows);
+            for (int row = 0; row < narrow_cast<int>(bitmap.rows); ++row)
+            {
+                std::copy_n(bitmap.buffer + bitmap.pitch * row,
+                            bitmap.width,
+                            pixels.data() + size_t{1} * bitmap.width * row);
+            }
+
+            glyphs.push_back({{face, font_size, glyph_index},
+                              slot->bitmap_left,
+                              slot->bitmap_top,
+                              bitmap.width,
+                              bitmap.rows,
+                              std::move(pixels)});
+        }
+
+        FT_Done_Face(worker_face);
+        FT_Done_FreeType(library);
+
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        std::move(glyphs.begin(),
+                  glyphs.end(),
+                  std::back_inserter(queue->glyphs));
+    });
 }
 
 void FontCache::update(TextureProvider& texture_provider)
 {
-    if (state_ != State::Ready)
-    {
-        const auto image = Image{
-            Image::Format::RGBA,
-            narrow_cast<uint32_t>(kTextureSize),
-            narrow_cast<uint32_t>(kTextureSize),
-            32U,
-            4U,
-            kTextureSizeBytes,
-            bitmap_.get(),
-        };
-        if (!texture_)
-            texture_ = texture_provider.get("rainbow://font-cache", image);
+    std::vector<PrewarmedGlyph> prewarmed;
+    {
+        std::lock_guard<std::mutex> lock(prewarm_queue_->mutex);
+        prewarmed.swap(prewarm_queue_->glyphs);
+    }
+
+    // Glyphs may have been requested while they were being prewarmed.
+    for (auto&& glyph : prewarmed)
+    {
+        if (glyph_cache_.find(glyph.index) != glyph_cache_.end())
+            continue;
+
+        store(glyph.index,
+              glyph.bitmap.data(),
+              narrow_cast<int>(glyph.width),
+              glyph.width,
+              glyph.rows,
+              glyph.left,
+              glyph.top);
+    }
+
+    for (uint32_t i = 0; i < page_count(); ++i)
+    {
+        auto& page = *pages_[i];
+        if (page.dirty_left >= page.dirty_right)
+            continue;
+
+        if (!page.texture)
+        {
+            const Image image{Image::Format::Alpha,
+                              narrow_cast<uint32_t>(kTextureSize),
+                              narrow_cast<uint32_t>(kTextureSize),
+                              8U,
+                              1U,
+                              kTextureSizeBytes,
+                              page.bitmap.get()};
+            std::array<char, 32> key;
+            std::snprintf(
+                key.data(), key.size(), "rainbow://font-cache/%u", i);
+            page.texture = texture_provider.get(key.data(), image);
+        }
         else
-            texture_provider.update(texture_, image);
-        state_ = State::Ready;
+        {
+            // Only the area that changed is uploaded, e.g. a single glyph
+            // when typing.
+            const auto width = page.dirty_right - page.dirty_left;
+            const auto height = page.dirty_bottom - page.dirty_top;
+            staging_.resize(size_t{1} * width * height);
+            for (int row = 0; row < height; ++row)
+            {
+                std::copy_n(page.bitmap.get() +
+                                (page.dirty_top + row) * kTextureSize +
+                                page.dirty_left,
+                            width,
+                            staging_.data() + row * width);
+            }
+
+            const Image image{Image::Format::Alpha,
+                              narrow_cast<uint32_t>(width),
+                              narrow_cast<uint32_t>(height),
+                              8U,
+                              1U,
+                              staging_.size(),
+                              staging_.data()};
+            texture_provider.update_region(
+                page.texture,
+                narrow_cast<uint32_t>(page.dirty_left),
+                narrow_cast<uint32_t>(page.dirty_top),
+                image);
+        }
+
+        page.dirty_left = kTextureSize;
+        page.dirty_top = kTextureSize;
+        page.dirty_right = 0;
+        page.dirty_bottom = 0;
     }
+
+    ++frame_;
+}
+
+void FontCache::clear_page(uint32_t page)
+{
+    auto& atlas = *pages_[page];
+    const auto texture_size = ceil_pow2(kTextureSize);
+    stbrp_init_target(&atlas.bin_context,
+                      texture_size,
+                      texture_size,
+                      atlas.bin_nodes.data(),
+                      narrow_cast<int>(atlas.bin_nodes.size()));
+
+    if (!atlas.bitmap)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+        atlas.bitmap = std::make_unique<uint8_t[]>(kTextureSizeBytes);
+    }
+    std::fill_n(atlas.bitmap.get(), kTextureSizeBytes, 0);
+}
+
+auto FontCache::pack(stbrp_rect& rect) -> uint32_t
+{
+    for (uint32_t i = 0; i < page_count(); ++i)
+    {
+        stbrp_pack_rects(&pages_[i]->bin_context, &rect, 1);
+        if (rect.was_packed != 0)
+            return i;
+    }
+
+    uint32_t page = page_count();
+    if (page < kMaxPages)
+    {
+        pages_.push_back(std::make_unique<Page>());
+        clear_page(page);
+    }
+    else
+    {
+        const auto lru = std::min_element(
+            pages_.begin(), pages_.end(), [](auto&& lhs, auto&& rhs) {
+                return lhs->last_used < rhs->last_used;
+            });
+
+        // Pages used this frame or the last may still be drawn.
+        if ((*lru)->last_used + 1 >= frame_)
+            return kMaxPages;
+
+        page = narrow_cast<uint32_t>(lru - pages_.begin());
+        for (auto i = glyph_cache_.begin(); i != glyph_cache_.end();)
+        {
+            if (i->second.page == page)
+                glyph_cache_.erase(i++);
+            else
+                ++i;
+        }
+
+        clear_page(page);
+        ++generation_;
+    }
+
+    stbrp_pack_rects(&pages_[page]->bin_context, &rect, 1);
+    return rect.was_packed != 0 ? page : kMaxPages;
+}
+
+auto FontCache::store(const Index& index,
+                      const uint8_t* bitmap,
+                      int pitch,
+                      uint32_t width,
+                      uint32_t rows,
+                      FT_Int left,
+                      FT_Int top) -> Glyph
+{
+    stbrp_rect rect{0,
+                    static_cast<stbrp_coord>(width + kGlyphMargin * 2),
+                    static_cast<stbrp_coord>(rows + kGlyphMargin * 2),
+                    0,
+                    0,
+                    0};
+    const auto page = pack(rect);
+    if (page == kMaxPages)
+    {
+        // Leave the glyph out rather than overwrite glyphs that are in use.
+        LOGW("FontCache: No room for glyph %u", index.index);
+        return {{}, 0};
+    }
+
+    // Margins are uploaded too since they may hold evicted glyphs.
+    auto& atlas = *pages_[page];
+    atlas.dirty_left = std::min(atlas.dirty_left, rect.x);
+    atlas.dirty_top = std::min(atlas.dirty_top, rect.y);
+    atlas.dirty_right = std::max(atlas.dirty_right, rect.x + rect.w);
+    atlas.dirty_bottom = std::max(atlas.dirty_bottom, rect.y + rect.h);
+    atlas.last_used = frame_;
+
+    // Adjust coordinates to compensate for margins.
+    rect.w -= kGlyphMargin * 2;
+    rect.h -= kGlyphMargin * 2;
+    rect.x += kGlyphMargin;
+    rect.y += kGlyphMargin;
+
+    blit(bitmap, pitch, rect, atlas.bitmap.get(), kTextureSize);
+
+    std::array<SpriteVertex, 4> vx;
+
+    vx[0].position.x = left;
+    vx[0].position.y = narrow_cast<float>(top - narrow_cast<FT_Int>(rows));
+    vx[1].position.x = narrow_cast<float>(left + width);
+    vx[1].position.y = vx[0].position.y;
+    vx[2].position.x = vx[1].position.x;
+    vx[2].position.y = narrow_cast<float>(top);
+    vx[3].position.x = vx[0].position.x;
+    vx[3].position.y = vx[2].position.y;
+
+    vx[0].texcoord.x = rect.x / narrow_cast<float>(kTextureSize);
+    vx[0].texcoord.y = (rect.y + rect.h) / narrow_cast<float>(kTextureSize);
+    vx[1].texcoord.x = (rect.x + rect.w) / narrow_cast<float>(kTextureSize);
+    vx[1].texcoord.y = vx[0].texcoord.y;
+    vx[2].texcoord.x = vx[1].texcoord.x;
+    vx[2].texcoord.y = rect.y / narrow_cast<float>(kTextureSize);
+    vx[3].texcoord.x = vx[0].texcoord.x;
+    vx[3].texcoord.y = vx[2].texcoord.y;
+
+    return glyph_cache_[index] = {vx, page};
 }
 
 #define STB_RECT_PACK_IMPLEMENTATION
@@ -6,7 +6,10 @@
 #define TEXT_FONTCACHE_H_
 
 #include <array>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 // clang-format off
 #include "ThirdParty/DisableWarnings.h"
@@ -20,28 +23,107 @@
 
 #include "Common/Data.h"
 #include "Common/Global.h"
+#include "Common/TypeCast.h"
 #include "Graphics/SpriteVertex.h"
 #include "Graphics/Texture.h"
 #include "Memory/ArrayMap.h"
+#include "Text/GlyphRendering.h"
 
 namespace rainbow
 {
+    class JobPool;
+
+    /// <summary>Rasterizes glyphs into a texture atlas.</summary>
+    /// <remarks>
+    ///   Glyphs are packed into pages of <see cref="kTextureSize"/> pixels
+    ///   that are allocated as they are needed, up to
+    ///   <see cref="kMaxPages"/>. Once all pages are full, the least recently
+    ///   used page is cleared and its glyphs are rasterized again the next
+    ///   time they are needed. Since vertices of evicted glyphs no longer
+    ///   point at them, anything that keeps vertices must lay them out again
+    ///   when <see cref="generation"/> changes.
+    ///
+    ///   Glyphs can also be rasterized ahead of time, off the main thread,
+    ///   with <see cref="prewarm"/>.
+    /// </remarks>
     class FontCache : public Global<FontCache>
     {
     public:
         static constexpr auto kTextureSize = 1024;
 
+        /// <summary>Maximum number of atlas pages.</summary>
+        static constexpr uint32_t kMaxPages = 4;
+
+        /// <summary>
+        ///   Font size that distance field glyphs are rendered at.
+        /// </summary>
+        static constexpr int32_t kDistanceFieldSize = 48;
+
+        /// <summary>
+        ///   Distance, in pixels at <see cref="kDistanceFieldSize"/>, covered
+        ///   by distance fields on either side of glyph outlines.
+        /// </summary>
+        static constexpr int kDistanceFieldSpread = 8;
+
+        struct Glyph
+        {
+            std::array<SpriteVertex, 4> vertices;
+
+            /// <summary>Atlas page the glyph was packed into.</summary>
+            uint32_t page;
+        };
+
         FontCache();
         ~FontCache();
 
-        [[nodiscard]] auto texture() const -> const graphics::Texture&
+        /// <summary>
+        ///   Returns a number that changes every time glyphs are evicted.
+        /// </summary>
+        [[nodiscard]] auto generation() const { return generation_; }
+
+        /// <summary>Returns the number of atlas pages allocated.</summary>
+        [[nodiscard]] auto page_count() const
+        {
+            return narrow_cast<uint32_t>(pages_.size());
+        }
+
+        /// <summary>Returns the texture of an atlas page.</summary>
+        [[nodiscard]] auto texture(uint32_t page) const
+            -> const graphics::Texture&
         {
-            return texture_;
+            return pages_[page]->texture;
         }
 
         auto get(std::string_view font_name) -> FT_Face;
-        auto get_glyph(FT_Face face, int32_t font_size, uint32_t glyph_index)
-            -> std::array<SpriteVertex, 4>;
+        auto get_glyph(FT_Face face,
+                       int32_t font_size,
+                       uint32_t glyph_index,
+                       GlyphRendering rendering = GlyphRendering::Bitmap)
+            -> Glyph;
+
+        /// <summary>
+        ///   Marks atlas page <paramref name="page"/> as being in use, keeping
+        ///   it from being evicted this frame and the next.
+        /// </summary>
+        void mark_used(uint32_t page) { pages_[page]->last_used = frame_; }
+
+        /// <summary>
+        ///   Rasterizes the glyphs of all characters in UTF-8 encoded
+        ///   <paramref name="text"/> on <paramref name="job_pool"/>. They are
+        ///   packed into the atlas by the first <see cref="update"/> after
+        ///   the job finishes, and are then ready to be drawn without any
+        ///   further work, e.g. glyphs for the next scene can be prepared
+        ///   while on a loading screen.
+        /// </summary>
+        /// <remarks>
+        ///   Glyphs are looked up by character, so glyphs only produced by
+        ///   shaping, e.g. ligatures, are still rasterized on first use.
+        /// </remarks>
+        void prewarm(JobPool& job_pool,
+                     std::string_view font_name,
+                     int32_t font_size,
+                     std::string_view text,
+                     GlyphRendering rendering = GlyphRendering::Bitmap);
 
         void update(graphics::TextureProvider&);
 
@@ -49,12 +131,9 @@ namespace rainbow
         struct FontFace
         {
             FT_Face face;
-            Data data;
-        };
 
-        struct GlyphInfo
-        {
-            std::array<SpriteVertex, 4> vertices;
+            /// <summary>Shared with workers prewarming glyphs.</summary>
+            std::shared_ptr<const Data> data;
         };
 
         struct Index
@@ -77,20 +156,80 @@ namespace rainbow
             }
         };
 
-        enum class State
+        struct Page
+        {
+            graphics::Texture texture;
+            stbrp_context bin_context;
+            std::array<stbrp_node, kTextureSize> bin_nodes;
+
+            /// <summary>Glyph coverage, one byte per pixel.</summary>
+            std::unique_ptr<uint8_t[]> bitmap;  // NOLINT
+
+            /// <summary>
+            ///   Bounds of the area written to since the page was last
+            ///   uploaded; empty if <c>left >= right</c>.
+            /// </summary>
+            int dirty_left = kTextureSize;
+            int dirty_top = kTextureSize;
+            int dirty_right = 0;
+            int dirty_bottom = 0;
+
+            /// <summary>Frame the page was last used.</summary>
+            uint64_t last_used = 0;
+        };
+
+        /// <summary>Glyph rasterized by a worker, to be packed.</summary>
+        struct PrewarmedGlyph
         {
-            Ready,
-            NeedsUpdate,
+            Index index;
+            FT_Int left;
+            FT_Int top;
+            uint32_t width;
+            uint32_t rows;
+
+            /// <summary>Glyph coverage, <c>width</c> bytes per row.</summary>
+            std::vector<uint8_t> bitmap;
         };
 
-        State state_ = State::Ready;
-        graphics::Texture texture_;
-        absl::flat_hash_map<Index, GlyphInfo> glyph_cache_;
+        struct PrewarmQueue
+        {
+            std::mutex mutex;
+            std::vector<PrewarmedGlyph> glyphs;
+        };
+
+        absl::flat_hash_map<Index, Glyph> glyph_cache_;
         ArrayMap<std::string, FontFace> font_cache_;
-        stbrp_context bin_context_;
-        std::array<stbrp_node, kTextureSize> bin_nodes_;
-        std::unique_ptr<uint8_t[]> bitmap_;
+        std::vector<std::unique_ptr<Page>> pages_;
+        std::shared_ptr<PrewarmQueue> prewarm_queue_;
+
+        /// <summary>Dirty areas are copied here before upload.</summary>
+        std::vector<uint8_t> staging_;
+        uint64_t frame_ = 0;
+        uint32_t generation_ = 0;
         FT_Library library_;
+
+        /// <summary>Clears atlas page <paramref name="page"/>.</summary>
+        void clear_page(uint32_t page);
+
+        /// <summary>
+        ///   Finds room for <paramref name="rect"/>, allocating or evicting a
+        ///   page if needed. Returns the page it was packed into, or
+        ///   <see cref="kMaxPages"/> if all pages are in use.
+        /// </summary>
+        auto pack(stbrp_rect& rect) -> uint32_t;
+
+        /// <summary>
+        ///   Packs a rasterized glyph into the atlas, and caches it under
+        ///   <paramref name="index"/>. Returns an empty glyph if there is no
+        ///   room for it.
+        /// </summary>
+        auto store(const Index& index,
+                   const uint8_t* bitmap,
+                   int pitch,
+                   uint32_t width,
+                   uint32_t rows,
+                   FT_Int left,
+                   FT_Int top) -> Glyph;
     };
 }  // namespace rainbow
 
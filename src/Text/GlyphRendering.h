@@ -0,0 +1,26 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef TEXT_GLYPHRENDERING_H_
+#define TEXT_GLYPHRENDERING_H_
+
+namespace rainbow
+{
+    enum class GlyphRendering
+    {
+        /// <summary>
+        ///   Glyphs are rasterized at every size they are used.
+        /// </summary>
+        Bitmap,
+
+        /// <summary>
+        ///   Glyphs are rendered as signed distance fields once, at
+        ///   <see cref="FontCache::kDistanceFieldSize"/>, and scaled to any
+        ///   size. Must be drawn with the distance field shader.
+        /// </summary>
+        DistanceField,
+    };
+}  // namespace rainbow
+
+#endif
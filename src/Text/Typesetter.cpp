@@ -46,6 +46,17 @@ namespace
         return i;
     }
 
+    /// <summary>
+    ///   Sets the size of <paramref name="font_face"/> and returns its line
+    ///   height.
+    /// </summary>
+    auto set_char_size(FT_Face font_face, int font_size) -> float
+    {
+        FT_Set_Char_Size(font_face, 0, font_size * kPixelFormat, 0, kDPI);
+        return font_face->size->metrics.height /
+               rainbow::narrow_cast<float>(kPixelFormat);
+    }
+
     constexpr auto to_vec2(hb_position_t x, hb_position_t y) -> Vec2f
     {
         return Vec2f{x / rainbow::narrow_cast<float>(kPixelFormat),
@@ -62,13 +73,18 @@ Typesetter::Typesetter()
 
 Typesetter::~Typesetter()
 {
+    for (auto&& [key, font] : fonts_)
+        hb_font_destroy(font.font);
+
     hb_buffer_destroy(buffer_);
 }
 
 auto Typesetter::draw_text(std::string_view text,
                            const Vec2f& position,
                            const TextAttributes& attributes,
-                           Vec2f* size) -> std::vector<SpriteVertex>
+                           Vec2f* size,
+                           std::vector<uint32_t>* pages)
+    -> std::vector<SpriteVertex>
 {
     auto glyph_positions = layout_text(text, attributes, size);
     std::vector<SpriteVertex> vertices;
@@ -76,8 +92,13 @@ auto Typesetter::draw_text(std::string_view text,
     auto font_face = font_cache_.get(attributes.font_face);
     for (auto&& glyph : glyph_positions)
     {
-        auto vx = font_cache_.get_glyph(
-            font_face, attributes.font_size, glyph.glyph_index);
+        auto [vx, page] = font_cache_.get_glyph(font_face,
+                                                attributes.font_size,
+                                                glyph.glyph_index,
+                                                attributes.rendering);
+        if (pages != nullptr)
+            pages->push_back(page);
+
         auto p = glyph.position + position;
         vx[0].position += p;
         vx[1].position += p;
@@ -95,12 +116,7 @@ auto Typesetter::layout_text(std::string_view text,
     std::vector<GlyphPosition> result;
 
     auto font_face = font_cache_.get(attributes.font_face);
-    FT_Set_Char_Size(
-        font_face, 0, attributes.font_size * kPixelFormat, 0, kDPI);
-    const auto line_height =
-        font_face->size->metrics.height / narrow_cast<float>(kPixelFormat);
-    auto font = hb_ft_font_create(font_face, nullptr);
-    hb_ft_font_set_load_flags(font, FT_LOAD_DEFAULT);
+    const auto font = get_font(font_face, attributes.font_size);
 
     float width = 0.0F;
     int line_count = 0;
@@ -108,55 +124,124 @@ auto Typesetter::layout_text(std::string_view text,
     const auto length = narrow_cast<int>(text.length());
     while (start < length)
     {
-        hb_buffer_reset(buffer_);
-
         const int line_length = suggest_line_break(text, start);
-        hb_buffer_add_utf8(buffer_, text.data(), length, start, line_length);
-        hb_buffer_guess_segment_properties(buffer_);
-        hb_shape(font, buffer_, nullptr, 0);
-
-        unsigned int count;
-        auto infos = hb_buffer_get_glyph_infos(buffer_, &count);
-        auto positions = hb_buffer_get_glyph_positions(buffer_, &count);
+        const auto& run = shape(font_face,
+                                attributes.font_size,
+                                font,
+                                text.substr(start, line_length));
 
-        Vec2f origin{0, -line_height * narrow_cast<float>(line_count)};
-        for (unsigned int i = 0; i < count; ++i)
-        {
-            const auto& p = positions[i];
-            result.push_back(
-                {infos[i].codepoint, origin + to_vec2(p.x_offset, p.y_offset)});
-            origin += to_vec2(p.x_advance, p.y_advance);
-        }
+        const Vec2f origin{
+            0, -font.line_height * narrow_cast<float>(line_count)};
+        for (auto&& glyph : run.glyphs)
+            result.push_back({glyph.glyph_index, origin + glyph.position});
 
+        const auto count = run.glyphs.size();
         switch (attributes.text_alignment)
         {
             case TextAlignment::Left:
                 break;
             case TextAlignment::Right:
-                offset_by(result.begin() + result.size() - count,
-                          result.end(),
-                          origin.x);
+                offset_by(result.end() - count, result.end(), run.advance.x);
                 break;
             case TextAlignment::Center:
-                offset_by(result.begin() + result.size() - count,
-                          result.end(),
-                          origin.x / 2);
+                offset_by(
+                    result.end() - count, result.end(), run.advance.x / 2);
                 break;
         }
 
         start += line_length + 1;  // Skip newline
         ++line_count;
 
-        width = std::max(width, origin.x);
+        width = std::max(width, run.advance.x);
     }
 
-    hb_font_destroy(font);
-
     if (size != nullptr)
     {
         size->x = width;
-        size->y = line_height * narrow_cast<float>(line_count);
+        size->y = font.line_height * narrow_cast<float>(line_count);
     }
 
     return result;
 }
+
+auto Typesetter::line_height(const TextAttributes& attributes) -> float
+{
+    auto font_face = font_cache_.get(attributes.font_face);
+    return get_font(font_face, attributes.font_size).line_height;
+}
+
+auto Typesetter::get_font(FT_Face face, int32_t font_size) -> Font
+{
+    const FontKey key{face, font_size};
+    auto search = fonts_.find(key);
+    if (search != fonts_.end())
+        return search->second;
+
+    const auto line_height = set_char_size(face, font_size);
+    auto font = hb_ft_font_create(face, nullptr);
+    hb_ft_font_set_load_flags(font, FT_LOAD_DEFAULT);
+
+    const Font entry{font, line_height};
+    fonts_.emplace(key, entry);
+    return entry;
+}
+
+auto Typesetter::shape(FT_Face face,
+                       int32_t font_size,
+                       const Font& font,
+                       std::string_view line) -> const ShapedRun&
+{
+    // Direction and script are guessed from the text itself, so the text
+    // alone determines the result.
+    const RunKey key{face, font_size, absl::Hash<std::string_view>{}(line)};
+    auto search = run_index_.find(key);
+    if (search != run_index_.end() && search->second->text == line)
+    {
+        ++shaping_stats_.hits;
+        runs_.splice(runs_.begin(), runs_, search->second);
+        return runs_.front();
+    }
+
+    ++shaping_stats_.misses;
+
+    // The face is shared between sizes; make sure it is set to ours.
+    set_char_size(face, font_size);
+
+    hb_buffer_reset(buffer_);
+    const auto length = narrow_cast<int>(line.length());
+    hb_buffer_add_utf8(buffer_, line.data(), length, 0, length);
+    hb_buffer_guess_segment_properties(buffer_);
+    hb_shape(font.font, buffer_, nullptr, 0);
+
+    unsigned int count;
+    auto infos = hb_buffer_get_glyph_infos(buffer_, &count);
+    auto positions = hb_buffer_get_glyph_positions(buffer_, &count);
+
+    if (search != run_index_.end())
+    {
+        // Hash collision; replace the older line.
+        runs_.erase(search->second);
+        run_index_.erase(search);
+    }
+
+    auto& run = runs_.emplace_front();
+    run.key = key;
+    run.text = line;
+    run.glyphs.reserve(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const auto& p = positions[i];
+        const auto offset = to_vec2(p.x_offset, p.y_offset);
+        run.glyphs.push_back({infos[i].codepoint, run.advance + offset});
+        run.advance += to_vec2(p.x_advance, p.y_advance);
+    }
+    run_index_.emplace(key, runs_.begin());
+
+    if (runs_.size() > kMaxShapedRuns)
+    {
+        run_index_.erase(runs_.back().key);
+        runs_.pop_back();
+    }
+
+    return run;
+}
@@ -5,6 +5,7 @@
 #ifndef TEXT_TYPESETTER_H_
 #define TEXT_TYPESETTER_H_
 
+#include <list>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -16,6 +17,7 @@
 #include "Text/FontCache.h"
 
 struct hb_buffer_t;
+struct hb_font_t;
 
 namespace rainbow
 {
@@ -30,28 +32,139 @@ namespace rainbow
         const std::string& font_face;
         int font_size;
         TextAlignment text_alignment;
+        GlyphRendering rendering = GlyphRendering::Bitmap;
     };
 
+    struct ShapingCacheStats
+    {
+        /// <summary>Number of lines served from the cache.</summary>
+        unsigned int hits;
+
+        /// <summary>Number of lines shaped by HarfBuzz.</summary>
+        unsigned int misses;
+    };
+
+    /// <summary>Shapes and lays out text.</summary>
+    /// <remarks>
+    ///   HarfBuzz fonts are kept for every face and size in use, and shaped
+    ///   lines are kept in a cache of the <see cref="kMaxShapedRuns"/> most
+    ///   recently used so that repeated strings skip shaping altogether.
+    /// </remarks>
     class Typesetter : private NonCopyable<Typesetter>
     {
     public:
+        static constexpr size_t kMaxShapedRuns = 512;
+
         Typesetter();
         ~Typesetter();
 
         auto font_cache() -> FontCache& { return font_cache_; }
 
+        /// <summary>
+        ///   Returns the number of lines found in and missing from the cache
+        ///   of shaped lines.
+        /// </summary>
+        [[nodiscard]] auto shaping_stats() const { return shaping_stats_; }
+
+        /// <summary>
+        ///   Lays out text and returns four vertices per glyph. The atlas page
+        ///   of each glyph is appended to <paramref name="pages"/>, if set.
+        /// </summary>
         auto draw_text(std::string_view text,
                        const Vec2f& position,
                        const TextAttributes& attributes,
-                       Vec2f* size = nullptr) -> std::vector<SpriteVertex>;
+                       Vec2f* size = nullptr,
+                       std::vector<uint32_t>* pages = nullptr)
+            -> std::vector<SpriteVertex>;
 
         auto layout_text(std::string_view text,
                          const TextAttributes& attributes,
                          Vec2f* size = nullptr) -> std::vector<GlyphPosition>;
 
+        /// <summary>
+        ///   Returns the distance between two lines of text, in pixels.
+        /// </summary>
+        auto line_height(const TextAttributes& attributes) -> float;
+
     private:
+        struct Font
+        {
+            hb_font_t* font;
+            float line_height;
+        };
+
+        struct FontKey
+        {
+            FT_Face face;
+            int32_t font_size;
+
+            template <typename H>
+            friend auto AbslHashValue(H hash_state, const FontKey& key) -> H
+            {
+                return H::combine(
+                    std::move(hash_state), key.face, key.font_size);
+            }
+
+            friend auto operator==(const FontKey& lhs, const FontKey& rhs)
+                -> bool
+            {
+                return lhs.face == rhs.face && lhs.font_size == rhs.font_size;
+            }
+        };
+
+        struct RunKey
+        {
+            FT_Face face;
+            int32_t font_size;
+            size_t text_hash;
+
+            template <typename H>
+            friend auto AbslHashValue(H hash_state, const RunKey& key) -> H
+            {
+                return H::combine(std::move(hash_state),
+                                  key.face,
+                                  key.font_size,
+                                  key.text_hash);
+            }
+
+            friend auto operator==(const RunKey& lhs, const RunKey& rhs)
+                -> bool
+            {
+                return lhs.face == rhs.face &&
+                       lhs.font_size == rhs.font_size &&
+                       lhs.text_hash == rhs.text_hash;
+            }
+        };
+
+        /// <summary>A line of text as shaped by HarfBuzz.</summary>
+        struct ShapedRun
+        {
+            RunKey key;
+            std::string text;
+            std::vector<GlyphPosition> glyphs;
+            Vec2f advance;
+        };
+
         FontCache font_cache_;
         hb_buffer_t* buffer_;
+        absl::flat_hash_map<FontKey, Font> fonts_;
+
+        /// <summary>Shaped lines, most recently used first.</summary>
+        std::list<ShapedRun> runs_;
+        absl::flat_hash_map<RunKey, std::list<ShapedRun>::iterator> run_index_;
+        ShapingCacheStats shaping_stats_{};
+
+        auto get_font(FT_Face face, int32_t font_size) -> Font;
+
+        /// <summary>
+        ///   Returns <paramref name="line"/> shaped with
+        ///   <paramref name="font"/>, shaping it only if it is not already
+        ///   cached.
+        /// </summary>
+        auto shape(FT_Face face,
+                   int32_t font_size,
+                   const Font& font,
+                   std::string_view line) -> const ShapedRun&;
     };
 }  // namespace rainbow
 
@@ -6,6 +6,7 @@
 
 #include <memory>
 
+#include "Graphics/Renderer.h"
 #include "Graphics/ShaderManager.h"
 #include "Graphics/Shaders.h"
 #include "Graphics/VertexArray.h"
@@ -63,7 +64,8 @@ namespace b2
 
             glGenBuffers(1, &g_debug_draw_buffer);
             g_debug_draw_vao.reconfigure([] {
-                glBindBuffer(GL_ARRAY_BUFFER, g_debug_draw_buffer);
+                rainbow::graphics::state_cache().bind_array_buffer(
+                    g_debug_draw_buffer);
                 glEnableVertexAttribArray(Shader::kAttributeColor);
                 glVertexAttribPointer(
                     Shader::kAttributeColor,
@@ -111,7 +113,8 @@ namespace b2
 
         auto context = ShaderManager::Get()->use_scoped(g_debug_draw_program);
         g_debug_draw_vao.bind();
-        glBindBuffer(GL_ARRAY_BUFFER, g_debug_draw_buffer);  // For uploading.
+        // For uploading.
+        rainbow::graphics::state_cache().bind_array_buffer(g_debug_draw_buffer);
         for (auto world : worlds_)
         {
             if (world == nullptr)
@@ -15,6 +15,7 @@
 #include <psaux/psaux.c>
 #include <pshinter/pshinter.c>
 #include <psnames/psnames.c>
+#include <sdf/sdf.c>
 #include <sfnt/sfnt.c>
 #include <smooth/smooth.c>
 #include <truetype/truetype.c>
@@ -16,7 +16,6 @@
 // clang-format on
 
 #include "Graphics/Buffer.h"
-#include "Graphics/ElementBuffer.h"
 #include "Graphics/Image.h"
 #include "Graphics/Renderer.h"
 #include "Graphics/VertexArray.h"
@@ -27,7 +26,6 @@ using rainbow::Image;
 using rainbow::Vec2f;
 using rainbow::graphics::Buffer;
 using rainbow::graphics::Context;
-using rainbow::graphics::ElementBuffer;
 using rainbow::graphics::Filter;
 using rainbow::graphics::ScopedProjection;
 using rainbow::graphics::ScopedScissorTest;
@@ -39,10 +37,9 @@ namespace
     class RenderData
     {
     public:
-        [[nodiscard]] auto element_buffer() -> ElementBuffer&
-        {
-            return element_buffer_;
-        }
+        RenderData() { glGenBuffers(1, &index_buffer_); }
+
+        ~RenderData() { rainbow::graphics::delete_buffer(index_buffer_); }
 
         [[nodiscard]] auto initial_window_width() const
         {
@@ -67,11 +64,23 @@ namespace
 
         void window_scale(Vec2f scale) { window_scale_ = scale; }
 
+        /// <summary>
+        ///   Binds the index buffer. Unlike the shared element buffer, which
+        ///   only indexes quads, it holds ImGui's own <c>ImDrawIdx</c>s.
+        /// </summary>
+        void bind_index_buffer() const
+        {
+            rainbow::graphics::state_cache().bind_element_buffer(
+                index_buffer_);
+        }
+
         void set_draw_list(const ImDrawList* list)
         {
-            element_buffer_.upload(  //
-                &list->IdxBuffer.front(),
-                list->IdxBuffer.size() * sizeof(ImDrawIdx));
+            bind_index_buffer();
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                         list->IdxBuffer.size() * sizeof(ImDrawIdx),
+                         &list->IdxBuffer.front(),
+                         GL_STREAM_DRAW);
             vertex_buffer_.upload(  //
                 &list->VtxBuffer.front(),
                 list->VtxBuffer.size() * sizeof(ImDrawVert));
@@ -81,8 +90,8 @@ namespace
     private:
         Vec2f window_scale_;
         float initial_window_width_ = 0.0F;
-        ElementBuffer element_buffer_;
-        Buffer vertex_buffer_;
+        unsigned int index_buffer_ = 0;
+        Buffer vertex_buffer_{Buffer::Usage::Stream};
         VertexArray vertex_array_;
         Texture texture_;
     };
@@ -149,12 +158,9 @@ void rainbow::imgui::init(Context& ctx, float font_size, float scale)
     auto render_data = std::make_unique<RenderData>().release();
     io.UserData = render_data;
 
-    unsigned int buffer;
-    glGenBuffers(1, &buffer);
-    render_data->element_buffer() = buffer;
     render_data->vertex_array().reconfigure([] {
         auto& render_data = get_render_data(ImGui::GetIO());
-        render_data.element_buffer().bind();
+        render_data.bind_index_buffer();
         render_data.vertex_buffer().bind();
     });
 
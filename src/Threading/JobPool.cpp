@@ -0,0 +1,182 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Threading/JobPool.h"
+
+#include <algorithm>
+
+using rainbow::JobPool;
+
+namespace
+{
+    struct ParallelFor
+    {
+        void (*invoke)(void*, uint32_t);
+        void* closure;
+        uint32_t count;
+        std::atomic<uint32_t> next{0};
+        std::atomic<uint32_t> done{0};
+
+        ParallelFor(void (*f)(void*, uint32_t), void* c, uint32_t n)
+            : invoke(f), closure(c), count(n)
+        {
+        }
+
+        void run()
+        {
+            // |closure| may be gone once all indices are claimed; helpers that
+            // start late must not touch it.
+            for (auto i = next.fetch_add(1, std::memory_order_relaxed);
+                 i < count;
+                 i = next.fetch_add(1, std::memory_order_relaxed))
+            {
+                invoke(closure, i);
+                done.fetch_add(1, std::memory_order_release);
+            }
+        }
+    };
+}  // namespace
+
+auto JobPool::default_worker_count() -> unsigned int
+{
+    const auto concurrency = std::thread::hardware_concurrency();
+    return concurrency <= 1 ? 0 : std::min(concurrency - 1, kMaxWorkers);
+}
+
+JobPool::JobPool(unsigned int worker_count)
+{
+    start(worker_count);
+}
+
+JobPool::~JobPool()
+{
+    stop();
+}
+
+void JobPool::set_worker_count(unsigned int worker_count)
+{
+    if (worker_count == this->worker_count())
+        return;
+
+    stop();
+    start(worker_count);
+}
+
+void JobPool::submit(Job job)
+{
+    if (threads_.empty())
+    {
+        job();
+        return;
+    }
+
+    push(std::move(job));
+}
+
+void JobPool::parallel_for(uint32_t count,
+                           void (*invoke)(void*, uint32_t),
+                           void* closure)
+{
+    auto state = std::make_shared<ParallelFor>(invoke, closure, count);
+
+    const auto helpers = std::min<size_t>(threads_.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i)
+        push([state] { state->run(); });
+
+    state->run();
+    while (state->done.load(std::memory_order_acquire) < count)
+        std::this_thread::yield();
+}
+
+void JobPool::push(Job job)
+{
+    const auto index =
+        next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        auto& queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    {
+        // The counter is only incremented under lock so that workers cannot
+        // miss the notification between checking it and going to sleep.
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++queued_;
+    }
+    condition_.notify_one();
+}
+
+void JobPool::start(unsigned int worker_count)
+{
+    worker_count = std::min(worker_count, kMaxWorkers);
+    for (unsigned int i = 0; i < worker_count; ++i)
+        queues_.push_back(std::make_unique<Queue>());
+    for (unsigned int i = 0; i < worker_count; ++i)
+        threads_.emplace_back([this, i] { work(i); });
+}
+
+void JobPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+
+    for (auto&& thread : threads_)
+        thread.join();
+
+    threads_.clear();
+    queues_.clear();
+    stopping_ = false;
+}
+
+auto JobPool::try_pop(size_t index, Job& job) -> bool
+{
+    {
+        auto& queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            --queued_;
+            return true;
+        }
+    }
+
+    const auto size = queues_.size();
+    for (size_t i = 1; i < size; ++i)
+    {
+        auto& queue = *queues_[(index + i) % size];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            --queued_;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobPool::work(size_t index)
+{
+    for (;;)
+    {
+        Job job;
+        if (try_pop(index, job))
+        {
+            job();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+        if (stopping_ && queued_ <= 0)
+            return;
+    }
+}
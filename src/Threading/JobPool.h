@@ -0,0 +1,116 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef THREADING_JOBPOOL_H_
+#define THREADING_JOBPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Common/NonCopyable.h"
+
+namespace rainbow
+{
+    /// <summary>Pool of worker threads that steal each other's jobs.</summary>
+    /// <remarks>
+    ///   Every worker owns a queue of jobs. Jobs are distributed round-robin
+    ///   across the queues. Workers take jobs from the back of their own queue
+    ///   and, when it runs dry, steal from the front of the others.
+    ///
+    ///   A pool without workers runs all jobs immediately, in order, on the
+    ///   calling thread. This makes results deterministic, and is useful for
+    ///   tests and single-core devices.
+    /// </remarks>
+    class JobPool : private NonCopyable<JobPool>
+    {
+    public:
+        using Job = std::function<void()>;
+
+        static constexpr unsigned int kMaxWorkers = 8;
+
+        /// <summary>
+        ///   Returns the number of available hardware threads, minus one for
+        ///   the calling thread.
+        /// </summary>
+        static auto default_worker_count() -> unsigned int;
+
+        explicit JobPool(unsigned int worker_count = 0);
+        ~JobPool();
+
+        /// <summary>Returns the number of worker threads.</summary>
+        [[nodiscard]] auto worker_count() const
+        {
+            return static_cast<unsigned int>(threads_.size());
+        }
+
+        /// <summary>
+        ///   Invokes <paramref name="f"/> for every index in [0,
+        ///   <paramref name="count"/>) and waits for all invocations to
+        ///   return. The calling thread participates in the work.
+        /// </summary>
+        template <typename F>
+        void parallel_for(uint32_t count, F&& f)
+        {
+            if (threads_.empty() || count <= 1)
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                    f(i);
+                return;
+            }
+
+            parallel_for(
+                count,
+                [](void* closure, uint32_t i) {
+                    (*static_cast<std::remove_reference_t<F>*>(closure))(i);
+                },
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+                const_cast<void*>(static_cast<const void*>(&f)));
+        }
+
+        /// <summary>
+        ///   Stops all workers, then restarts the pool with
+        ///   <paramref name="worker_count"/> workers. Queued jobs are run
+        ///   before the workers are stopped.
+        /// </summary>
+        void set_worker_count(unsigned int worker_count);
+
+        /// <summary>Queues a job to be run on a worker thread.</summary>
+        void submit(Job job);
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> threads_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::atomic<int> queued_ = 0;
+        std::atomic<size_t> next_queue_ = 0;
+        bool stopping_ = false;
+
+        void parallel_for(uint32_t count,
+                          void (*invoke)(void*, uint32_t),
+                          void* closure);
+
+        void push(Job job);
+        void start(unsigned int worker_count);
+        void stop();
+        auto try_pop(size_t index, Job& job) -> bool;
+        void work(size_t index);
+    };
+}  // namespace rainbow
+
+#endif
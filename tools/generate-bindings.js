@@ -17,8 +17,8 @@ const sourcePath = path.resolve(__dirname, "..", "src");
  * @typedef {
      | "Animation::Callback"
      | "Animation::Frames"
-     | "Animation|Label|SpriteBatch"
-     | "Animation|Label|SpriteBatch|czstring|int"
+     | "Animation|InstancedSpriteBatch|Label|SpriteBatch"
+     | "Animation|InstancedSpriteBatch|Label|SpriteBatch|czstring|int"
      | "Channel"
      | "Channel|Sound"
      | "Channel|undefined"
@@ -29,6 +29,7 @@ const sourcePath = path.resolve(__dirname, "..", "src");
      | "SpriteRef"
      | "TextAlignment"
      | "Texture"
+     | "TextureProvider::Callback"
      | "Vec2f"
      | "bool"
      | "czstring"
@@ -43,6 +44,7 @@ const sourcePath = path.resolve(__dirname, "..", "src");
  *   type: NativeType;
  *   name: string;
  *   mustBeMoved?: boolean;
+ *   optional?: boolean;
  * }} ParameterInfo
  *
  * @typedef {{
@@ -160,6 +162,47 @@ const modules = [
     sourceName: "ControllerButton",
     values: [],
   },
+  {
+    type: "class",
+    name: "InstancedSpriteBatch",
+    source: "Graphics/InstancedSpriteBatch.h",
+    sourceName: "InstancedSpriteBatch",
+    ctor: [{ type: "uint32_t", name: "count" }],
+    methods: [
+      { name: "is_instanced", parameters: [], returnType: "bool" },
+      { name: "is_visible", parameters: [], returnType: "bool" },
+      {
+        name: "set_texture",
+        parameters: [{ type: "Texture", name: "texture" }],
+      },
+      {
+        name: "set_visible",
+        parameters: [{ type: "bool", name: "visible" }],
+      },
+      { name: "clear", parameters: [] },
+      {
+        name: "create_sprite",
+        parameters: [
+          { type: "uint32_t", name: "width" },
+          { type: "uint32_t", name: "height" },
+        ],
+        returnType: "SpriteRef",
+      },
+      { name: "erase", parameters: [{ type: "uint32_t", name: "i" }] },
+      {
+        name: "find_sprite_by_id",
+        parameters: [{ type: "int", name: "id" }],
+        returnType: "SpriteRef",
+      },
+      {
+        name: "swap",
+        parameters: [
+          { type: "SpriteRef", name: "a" },
+          { type: "SpriteRef", name: "b" },
+        ],
+      },
+    ],
+  },
   {
     type: "class",
     name: "Label",
@@ -303,7 +346,12 @@ const modules = [
     sourceName: "SpriteBatch",
     ctor: [{ type: "uint32_t", name: "count" }],
     methods: [
+      { name: "is_culling", parameters: [], returnType: "bool" },
       { name: "is_visible", parameters: [], returnType: "bool" },
+      {
+        name: "set_culling",
+        parameters: [{ type: "bool", name: "enable" }],
+      },
       {
         name: "set_normal",
         parameters: [{ type: "Texture", name: "texture" }],
@@ -352,8 +400,11 @@ const modules = [
     name: "Texture",
     source: "Graphics/Texture.h",
     sourceName: "graphics::Texture",
-    ctor: [{ type: "czstring", name: "path" }],
-    methods: [],
+    ctor: [
+      { type: "czstring", name: "path" },
+      { type: "TextureProvider::Callback", name: "onload", optional: true },
+    ],
+    methods: [{ name: "is_loaded", parameters: [], returnType: "bool" }],
   },
   {
     type: "enum",
@@ -439,6 +490,22 @@ const modules = [
       },
     ],
   },
+  {
+    type: "module",
+    name: "FontCache",
+    source: "Text/FontCache.h",
+    sourceName: "FontCache",
+    functions: [
+      {
+        name: "prewarm",
+        parameters: [
+          { type: "czstring", name: "font" },
+          { type: "int", name: "fontSize" },
+          { type: "czstring", name: "text" },
+        ],
+      },
+    ],
+  },
   {
     type: "module",
     name: "Input",
@@ -473,37 +540,81 @@ const modules = [
     functions: [
       {
         name: "add",
-        parameters: [{ type: "Animation|Label|SpriteBatch", name: "obj" }],
+        parameters: [
+          {
+            type: "Animation|InstancedSpriteBatch|Label|SpriteBatch",
+            name: "obj",
+          },
+        ],
       },
       {
         name: "disable",
         parameters: [
-          { type: "Animation|Label|SpriteBatch|czstring|int", name: "obj" },
+          {
+            type: "Animation|InstancedSpriteBatch|Label|SpriteBatch|czstring|int",
+            name: "obj",
+          },
         ],
       },
       {
         name: "enable",
         parameters: [
-          { type: "Animation|Label|SpriteBatch|czstring|int", name: "obj" },
+          {
+            type: "Animation|InstancedSpriteBatch|Label|SpriteBatch|czstring|int",
+            name: "obj",
+          },
         ],
       },
       {
         name: "insert",
         parameters: [
           { type: "uint32_t", name: "position" },
-          { type: "Animation|Label|SpriteBatch", name: "obj" },
+          {
+            type: "Animation|InstancedSpriteBatch|Label|SpriteBatch",
+            name: "obj",
+          },
         ],
       },
       {
         name: "erase",
         parameters: [
-          { type: "Animation|Label|SpriteBatch|czstring|int", name: "obj" },
+          {
+            type: "Animation|InstancedSpriteBatch|Label|SpriteBatch|czstring|int",
+            name: "obj",
+          },
         ],
       },
+      {
+        name: "set_depth",
+        parameters: [
+          {
+            type: "Animation|InstancedSpriteBatch|Label|SpriteBatch",
+            name: "obj",
+          },
+          { type: "uint32_t", name: "depth" },
+        ],
+      },
+      {
+        name: "set_layer",
+        parameters: [
+          {
+            type: "Animation|InstancedSpriteBatch|Label|SpriteBatch",
+            name: "obj",
+          },
+          { type: "uint32_t", name: "layer" },
+        ],
+      },
+      {
+        name: "set_sorted",
+        parameters: [{ type: "bool", name: "sorted" }],
+      },
       {
         name: "set_tag",
         parameters: [
-          { type: "Animation|Label|SpriteBatch", name: "obj" },
+          {
+            type: "Animation|InstancedSpriteBatch|Label|SpriteBatch",
+            name: "obj",
+          },
           { type: "czstring", name: "tag" },
         ],
       },
@@ -524,6 +635,8 @@ function generateCppBindings(typeInfo) {
     switch (type) {
       case "Texture":
         return "graphics::Texture*";
+      case "TextureProvider::Callback":
+        return "graphics::TextureProvider::Callback";
       default:
         return type;
     }
@@ -806,7 +919,10 @@ function generateTypeScriptDeclaration(typeInfo) {
   /** @type {(parameters: ParameterInfo[]) => string} */
   const joinParams = (parameters) => {
     return parameters
-      .map((p) => `${p.name}: ${toTypeScriptType(p.type)}`)
+      .map(
+        (p) =>
+          `${p.name}${p.optional ? "?" : ""}: ${toTypeScriptType(p.type)}`
+      )
       .join(", ");
   };
 
@@ -822,6 +938,8 @@ function generateTypeScriptDeclaration(typeInfo) {
             return "Rect[]";
           case "SpriteRef":
             return "Sprite";
+          case "TextureProvider::Callback":
+            return "(texture: Texture, loaded: boolean) => void";
           case "bool":
             return "boolean";
           case "czstring":